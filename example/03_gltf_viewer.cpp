@@ -1058,7 +1058,9 @@ int main(int argc, const char* const* argv)
     return -1;
   }
 
-  auto appInfo = Application::CreateInfo{.name = "glTF Viewer Example", .vsync = false};
+  // Meshes draw with gl_BaseInstance, so batching can be enabled. Each mesh has its own buffers and updates the
+  // material buffer between draws, which exercises flushing the batch before those updates
+  auto appInfo = Application::CreateInfo{.name = "glTF Viewer Example", .vsync = false, .enableDrawBatching = true};
   auto app = GltfViewerApplication(appInfo, filename, scale, binary);
   app.Run();
 
@@ -6,6 +6,7 @@
 #include <Fwog/Pipeline.h>
 #include <Fwog/Rendering.h>
 #include <Fwog/Shader.h>
+#include <Fwog/ShaderPreprocessor.h>
 #include <Fwog/Texture.h>
 #include <Fwog/Timer.h>
 
@@ -17,10 +18,6 @@
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
-#define STB_INCLUDE_IMPLEMENTATION
-#define STB_INCLUDE_LINE_GLSL
-#include <stb_include.h>
-
 #include <array>
 #include <charconv>
 #include <exception>
@@ -282,35 +279,14 @@ class VolumetricTechnique
 public:
   void Init()
   {
-    char error[256] = {};
-    char* accumulateDensity =
-      stb_include_string(Application::LoadFile("shaders/volumetric/CellLightingAndDensity.comp.glsl").data(),
-                         nullptr,
-                         "shaders/volumetric",
-                         "CellLightingAndDensity",
-                         error);
-
-    char* marchVolume = stb_include_string(Application::LoadFile("shaders/volumetric/MarchVolume.comp.glsl").data(),
-                                           nullptr,
-                                           "shaders/volumetric",
-                                           "marchVolume",
-                                           error);
-
-    char* applyDeferred =
-      stb_include_string(Application::LoadFile("shaders/volumetric/ApplyVolumetricsDeferred.comp.glsl").data(),
-                         nullptr,
-                         "shaders/volumetric",
-                         "applyDeferred",
-                         error);
-
-    std::string infoLog;
-    auto accumulateShader = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, accumulateDensity);
-    auto marchShader = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, marchVolume);
-    auto applyShader = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, applyDeferred);
-
-    free(applyDeferred);
-    free(marchVolume);
-    free(accumulateDensity);
+    auto preprocessor = Fwog::ShaderPreprocessor();
+    const auto accumulateDensity = preprocessor.Preprocess("shaders/volumetric/CellLightingAndDensity.comp.glsl");
+    const auto marchVolume = preprocessor.Preprocess("shaders/volumetric/MarchVolume.comp.glsl");
+    const auto applyDeferred = preprocessor.Preprocess("shaders/volumetric/ApplyVolumetricsDeferred.comp.glsl");
+
+    auto accumulateShader = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, accumulateDensity.source);
+    auto marchShader = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, marchVolume.source);
+    auto applyShader = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, applyDeferred.source);
 
     accumulateDensityPipeline = Fwog::ComputePipeline({.shader = &accumulateShader});
     marchVolumePipeline = Fwog::ComputePipeline({.shader = &marchShader});
@@ -488,7 +464,7 @@ public:
                     Fwog::Cmd::BindStorageBuffer(0, lightBuffer);
                     Fwog::Cmd::BindSampledImage(0, shadowDepth, sampler);
                     Fwog::Cmd::BindSampledImage(1, *scatteringTexture, sampler);
-                    Fwog::Cmd::BindImage(0, densityVolume, 0);
+                    Fwog::Cmd::BindImage(0, densityVolume, 0, Fwog::ShaderAccess::WRITE_ONLY);
                     Fwog::Cmd::DispatchInvocations(densityVolume);
                   });
   }
@@ -507,7 +483,7 @@ public:
                     Fwog::Cmd::BindComputePipeline(*marchVolumePipeline);
                     Fwog::Cmd::BindUniformBuffer(0, *uniformBuffer);
                     Fwog::Cmd::BindSampledImage(0, sourceVolume, sampler);
-                    Fwog::Cmd::BindImage(0, targetVolume, 0);
+                    Fwog::Cmd::BindImage(0, targetVolume, 0, Fwog::ShaderAccess::WRITE_ONLY);
                     // We only want to invoke threads on the X and Y dimensions, but not the Z dimension
                     Fwog::Cmd::DispatchInvocations(targetVolume.Extent().width, targetVolume.Extent().height, 1);
                   });
@@ -534,7 +510,7 @@ public:
                     Fwog::Cmd::BindSampledImage(1, gbufferDepth, sampler);
                     Fwog::Cmd::BindSampledImage(2, sourceVolume, sampler);
                     Fwog::Cmd::BindSampledImage(3, noise, sampler);
-                    Fwog::Cmd::BindImage(0, targetColor, 0);
+                    Fwog::Cmd::BindImage(0, targetColor, 0, Fwog::ShaderAccess::WRITE_ONLY);
                     Fwog::Cmd::DispatchInvocations(targetColor);
                   });
   }
@@ -586,7 +562,6 @@ private:
   Fwog::Texture esmTex;
   Fwog::Texture esmTexPingPong;
   Fwog::TypedBuffer<float> esmUniformBuffer;
-  Fwog::TypedBuffer<EsmBlurUniforms> esmBlurUniformBuffer;
 
   ShadingUniforms shadingUniforms;
   std::optional<Fwog::Texture> noiseTexture;
@@ -633,7 +608,6 @@ VolumetricApplication::VolumetricApplication(const Application::CreateInfo& crea
     esmTex(Fwog::CreateTexture2D(config.esmResolution, Fwog::Format::R32_FLOAT)),
     esmTexPingPong(Fwog::CreateTexture2D(config.esmResolution, Fwog::Format::R32_FLOAT)),
     esmUniformBuffer(config.esmExponent, Fwog::BufferStorageFlag::DYNAMIC_STORAGE),
-    esmBlurUniformBuffer(Fwog::BufferStorageFlag::DYNAMIC_STORAGE),
     globalUniformsBuffer(Fwog::BufferStorageFlag::DYNAMIC_STORAGE),
     shadingUniformsBuffer(Fwog::BufferStorageFlag::DYNAMIC_STORAGE),
     materialUniformsBuffer(Fwog::BufferStorageFlag::DYNAMIC_STORAGE),
@@ -845,7 +819,7 @@ void VolumetricApplication::OnRender([[maybe_unused]] double dt)
                                                              .addressModeV = Fwog::AddressMode::MIRRORED_REPEAT});
                   Fwog::Cmd::BindComputePipeline(copyToEsmPipeline);
                   Fwog::Cmd::BindSampledImage(0, shadowDepth, nearestMirrorSampler);
-                  Fwog::Cmd::BindImage(0, esmTex, 0);
+                  Fwog::Cmd::BindImage(0, esmTex, 0, Fwog::ShaderAccess::WRITE_ONLY);
                   Fwog::Cmd::BindUniformBuffer(0, esmUniformBuffer);
                   Fwog::Cmd::DispatchInvocations(esmTex);
 
@@ -861,23 +835,21 @@ void VolumetricApplication::OnRender([[maybe_unused]] double dt)
                   const auto esmExtent1 = esmTex.Extent();
                   const auto esmExtent2 = esmTexPingPong.Extent();
 
-                  Fwog::Cmd::BindUniformBuffer(0, esmBlurUniformBuffer);
-
                   for (size_t i = 0; i < config.esmBlurPasses; i++)
                   {
                     esmBlurUniforms.direction = {0, 1};
                     esmBlurUniforms.targetDim = {esmExtent2.width, esmExtent2.height};
-                    esmBlurUniformBuffer.UpdateData(esmBlurUniforms);
+                    Fwog::Cmd::PushConstants(esmBlurUniforms);
                     Fwog::Cmd::BindSampledImage(0, esmTex, linearSampler);
-                    Fwog::Cmd::BindImage(0, esmTexPingPong, 0);
+                    Fwog::Cmd::BindImage(0, esmTexPingPong, 0, Fwog::ShaderAccess::WRITE_ONLY);
                     Fwog::MemoryBarrier(Fwog::MemoryBarrierBit::TEXTURE_FETCH_BIT);
                     Fwog::Cmd::DispatchInvocations(esmExtent2);
 
                     esmBlurUniforms.direction = {1, 0};
                     esmBlurUniforms.targetDim = {esmExtent1.width, esmExtent1.height};
-                    esmBlurUniformBuffer.UpdateData(esmBlurUniforms);
+                    Fwog::Cmd::PushConstants(esmBlurUniforms);
                     Fwog::Cmd::BindSampledImage(0, esmTexPingPong, linearSampler);
-                    Fwog::Cmd::BindImage(0, esmTex, 0);
+                    Fwog::Cmd::BindImage(0, esmTex, 0, Fwog::ShaderAccess::WRITE_ONLY);
                     Fwog::MemoryBarrier(Fwog::MemoryBarrierBit::TEXTURE_FETCH_BIT);
                     Fwog::Cmd::DispatchInvocations(esmExtent1);
                   }
@@ -956,7 +928,7 @@ void VolumetricApplication::OnRender([[maybe_unused]] double dt)
                     Fwog::Cmd::BindComputePipeline(postprocessingPipeline);
                     Fwog::Cmd::BindSampledImage(0, frame.shadingTexHdr.value(), nearestSampler);
                     Fwog::Cmd::BindSampledImage(1, noiseTexture.value(), nearestSampler);
-                    Fwog::Cmd::BindImage(0, frame.shadingTexLdr.value(), 0);
+                    Fwog::Cmd::BindImage(0, frame.shadingTexLdr.value(), 0, Fwog::ShaderAccess::WRITE_ONLY);
                     Fwog::Cmd::DispatchInvocations(*frame.shadingTexLdr);
                     Fwog::MemoryBarrier(Fwog::MemoryBarrierBit::TEXTURE_FETCH_BIT);
                   });
@@ -1,4 +1,5 @@
 #include "common/Application.h"
+#include "common/HiZCulling.h"
 #include "common/SceneLoader.h"
 
 #include <Fwog/Buffer.h>
@@ -16,10 +17,6 @@
 
 #include <imgui.h>
 
-#define STB_INCLUDE_IMPLEMENTATION
-#define STB_INCLUDE_LINE_GLSL
-#include <stb_include.h>
-
 #include <array>
 #include <charconv>
 #include <exception>
@@ -30,10 +27,11 @@
 
 /* 05_gpu_driven
  *
- * A basic GPU-driven renderer. Occlusion culling is performed by rendering object bounding boxes with early fragment
- * tests enabled. If any fragments are drawn, then the object is potentially visible and is marked to be rendered.
- * Then, the entire scene is drawn in a single draw call using DrawIndexedIndirect and bindless textures (taking
- * care not to invoke undefined behavior).
+ * A basic GPU-driven renderer. Frustum and occlusion culling are performed in compute shaders in two phases. First,
+ * objects that were visible last frame are drawn. A hierarchical depth buffer (Hi-Z) is built from the result, then
+ * every object is tested against it, and objects that have become visible are drawn. Each phase draws the entire
+ * scene in a single draw call using DrawIndexedIndirectCount and bindless textures (taking care not to invoke
+ * undefined behavior).
  *
  * The app has the same options as 03_gltf_viewer.
  *
@@ -54,26 +52,9 @@
  * - Memory barriers
  * + Indirect drawing
  * + Bindless textures
- *
- * TODO: frustum culling
- * TODO: hi-z occlusion culling
- * TODO: disocclusion fixup pass
+ * + GPU frustum and Hi-Z occlusion culling
  */
 
-struct alignas(16) ObjectUniforms
-{
-  glm::mat4 model;
-  uint32_t materialIdx;
-};
-
-struct alignas(16) BoundingBox
-{
-  glm::vec3 offset;
-  uint32_t padding_0;
-  glm::vec3 halfExtent;
-  uint32_t padding_1;
-};
-
 struct GlobalUniforms
 {
   glm::mat4 viewProj;
@@ -88,15 +69,6 @@ struct ShadingUniforms
   glm::vec4 sunStrength;
 };
 
-std::string LoadFileWithInclude(std::string_view path, std::string_view includeDir)
-{
-  char error[256] = {};
-  char* included = stb_include_string(Application::LoadFile(path).data(), nullptr, includeDir.data(), "", error);
-  std::string includedStr = included;
-  free(included);
-  return includedStr;
-}
-
 constexpr std::array<Fwog::VertexInputBindingDescription, 3> sceneInputBindingDescs = {
   Fwog::VertexInputBindingDescription{
     .location = 0,
@@ -121,9 +93,9 @@ constexpr std::array<Fwog::VertexInputBindingDescription, 3> sceneInputBindingDe
 Fwog::GraphicsPipeline CreateScenePipeline()
 {
   auto vs = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER,
-                         LoadFileWithInclude("shaders/gpu_driven/SceneForward.vert.glsl", "shaders/gpu_driven"));
+                         Application::LoadFileWithInclude("shaders/gpu_driven/SceneForward.vert.glsl"));
   auto fs = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER,
-                         LoadFileWithInclude("shaders/gpu_driven/SceneForward.frag.glsl", "shaders/gpu_driven"));
+                         Application::LoadFileWithInclude("shaders/gpu_driven/SceneForward.frag.glsl"));
 
   return Fwog::GraphicsPipeline({
     .name = "Generic material",
@@ -137,9 +109,9 @@ Fwog::GraphicsPipeline CreateScenePipeline()
 Fwog::GraphicsPipeline CreateBoundingBoxDebugPipeline()
 {
   auto vs = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER,
-                         LoadFileWithInclude("shaders/gpu_driven/BoundingBox.vert.glsl", "shaders/gpu_driven"));
+                         Application::LoadFileWithInclude("shaders/gpu_driven/BoundingBox.vert.glsl"));
   auto fs = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER,
-                         LoadFileWithInclude("shaders/gpu_driven/SolidColor.frag.glsl", "shaders/gpu_driven"));
+                         Application::LoadFileWithInclude("shaders/gpu_driven/SolidColor.frag.glsl"));
 
   return Fwog::GraphicsPipeline({
     .name = "Wireframe bounding boxes",
@@ -151,23 +123,6 @@ Fwog::GraphicsPipeline CreateBoundingBoxDebugPipeline()
   });
 }
 
-Fwog::GraphicsPipeline CreateBoundingBoxCullingPipeline()
-{
-  auto vs = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER,
-                         LoadFileWithInclude("shaders/gpu_driven/BoundingBox.vert.glsl", "shaders/gpu_driven"));
-  auto fs = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER,
-                         LoadFileWithInclude("shaders/gpu_driven/CullVisibility.frag.glsl", "shaders/gpu_driven"));
-
-  return Fwog::GraphicsPipeline({
-    .name = "Culling bounding boxes",
-    .vertexShader = &vs,
-    .fragmentShader = &fs,
-    .inputAssemblyState = {.topology = Fwog::PrimitiveTopology::TRIANGLE_STRIP},
-    .rasterizationState = {.polygonMode = Fwog::PolygonMode::FILL, .cullMode = Fwog::CullMode::NONE},
-    .depthState = {.depthTestEnable = true, .depthWriteEnable = false, .depthCompareOp = Fwog::CompareOp::LESS},
-  });
-}
-
 class GpuDrivenApplication final : public Application
 {
 public:
@@ -187,6 +142,7 @@ private:
   {
     float viewNearPlane = 0.3f;
     bool freezeCulling = false;
+    bool enableOcclusionCulling = true;
     bool viewBoundingBoxes = false;
   } config;
 
@@ -201,20 +157,20 @@ private:
 
   Fwog::GraphicsPipeline scenePipeline;
   Fwog::GraphicsPipeline boundingBoxDebugPipeline;
-  Fwog::GraphicsPipeline boundingBoxCullingPipeline;
 
   Fwog::TypedBuffer<GlobalUniforms> globalUniformsBuffer;
 
   // Scene
   Utility::SceneBindless scene;
-  std::vector<Fwog::DrawIndexedIndirectCommand> drawCommands;
-  std::optional<Fwog::TypedBuffer<Fwog::DrawIndexedIndirectCommand>> drawCommandsBuffer;
+  std::optional<Fwog::TypedBuffer<Fwog::DrawIndexedIndirectCommand>> drawTemplatesBuffer;
   std::optional<Fwog::TypedBuffer<Utility::Vertex>> vertexBuffer;
   std::optional<Fwog::TypedBuffer<Utility::index_t>> indexBuffer;
-  std::optional<Fwog::TypedBuffer<ObjectUniforms>> meshUniformBuffer;
-  std::optional<Fwog::TypedBuffer<BoundingBox>> boundingBoxesBuffer;
-  std::optional<Fwog::Buffer> objectIndicesBuffer; // Unused
+  std::optional<Fwog::TypedBuffer<Culling::ObjectUniforms>> meshUniformBuffer;
+  std::optional<Fwog::TypedBuffer<Culling::BoundingBox>> boundingBoxesBuffer;
+  std::optional<Fwog::Buffer> objectIndicesBuffer; // Only used to view bounding boxes
   std::optional<Fwog::TypedBuffer<Utility::GpuMaterialBindless>> materialsBuffer;
+
+  std::optional<Culling::TwoPhaseCuller> culler;
 };
 
 GpuDrivenApplication::GpuDrivenApplication(const Application::CreateInfo& createInfo,
@@ -224,9 +180,14 @@ GpuDrivenApplication::GpuDrivenApplication(const Application::CreateInfo& create
   : Application(createInfo),
     scenePipeline(CreateScenePipeline()),
     boundingBoxDebugPipeline(CreateBoundingBoxDebugPipeline()),
-    boundingBoxCullingPipeline(CreateBoundingBoxCullingPipeline()),
     globalUniformsBuffer(Fwog::BufferStorageFlag::DYNAMIC_STORAGE)
 {
+  // Check the culling shaders against a scene with a known result before trusting them with a real one
+  if (!Culling::RunSelfTest())
+  {
+    throw std::runtime_error("Culling self-test failed");
+  }
+
   bool success = false;
 
   if (!filename)
@@ -243,41 +204,48 @@ GpuDrivenApplication::GpuDrivenApplication(const Application::CreateInfo& create
     throw std::runtime_error("Failed to load scene");
   }
 
-  std::vector<ObjectUniforms> meshUniforms;
-  std::vector<BoundingBox> boundingBoxes;
+  std::vector<Culling::ObjectUniforms> meshUniforms;
+  std::vector<Culling::BoundingBox> boundingBoxes;
+  std::vector<Fwog::DrawIndexedIndirectCommand> drawTemplates;
   std::vector<uint32_t> objectIndices = {static_cast<uint32_t>(scene.meshes.size())};
 
   int curObjectIndex = 0;
   for (const auto& mesh : scene.meshes)
   {
-    // The mesh uniforms are indexed with gl_DrawID (each mesh gets one set of uniforms).
-    meshUniforms.push_back(ObjectUniforms{.model = mesh.transform, .materialIdx = mesh.materialIdx});
-    // Each mesh has a bounding box which is used as its cheap-to-draw proxy volume for occlusion culling.
-    boundingBoxes.push_back(BoundingBox{
+    // The mesh uniforms are indexed with gl_BaseInstance, which the culling shader sets to the object index.
+    meshUniforms.push_back(Culling::ObjectUniforms{.model = mesh.transform, .materialIdx = mesh.materialIdx});
+    // Each mesh has a bounding box which is used to test it against the frustum and the Hi-Z.
+    boundingBoxes.push_back(Culling::BoundingBox{
       .offset = mesh.boundingBox.offset,
       .halfExtent = mesh.boundingBox.halfExtent,
     });
-    // Initialize the indirect draw command. Note that the instance count is initialized to 0.
-    // The other draw parameters depend on the mesh's location in the one big vertex buffer.
-    drawCommands.push_back(Fwog::DrawIndexedIndirectCommand{
+    // The draw parameters depend on the mesh's location in the one big vertex buffer. The culling shader copies these
+    // into the draw lists for visible objects.
+    drawTemplates.push_back(Fwog::DrawIndexedIndirectCommand{
       .indexCount = mesh.indexCount,
-      .instanceCount = 0,
+      .instanceCount = 1,
       .firstIndex = mesh.startIndex,
       .vertexOffset = mesh.startVertex,
       .firstInstance = 0,
     });
-    // Currently unused.
     objectIndices.push_back(curObjectIndex++);
   }
 
-  drawCommandsBuffer = Fwog::TypedBuffer<Fwog::DrawIndexedIndirectCommand>(drawCommands);
+  drawTemplatesBuffer = Fwog::TypedBuffer<Fwog::DrawIndexedIndirectCommand>(drawTemplates);
   vertexBuffer = Fwog::TypedBuffer<Utility::Vertex>(scene.vertices);
   indexBuffer = Fwog::TypedBuffer<Utility::index_t>(scene.indices);
-  meshUniformBuffer = Fwog::TypedBuffer<ObjectUniforms>(meshUniforms);
-  boundingBoxesBuffer = Fwog::TypedBuffer<BoundingBox>(boundingBoxes);
+  meshUniformBuffer = Fwog::TypedBuffer<Culling::ObjectUniforms>(meshUniforms);
+  boundingBoxesBuffer = Fwog::TypedBuffer<Culling::BoundingBox>(boundingBoxes);
   objectIndicesBuffer = Fwog::Buffer(std::span(objectIndices));
   materialsBuffer = Fwog::TypedBuffer<Utility::GpuMaterialBindless>(scene.materials);
 
+  culler.emplace(static_cast<uint32_t>(scene.meshes.size()),
+                 Culling::CullInputs{
+                   .objects = meshUniformBuffer.value(),
+                   .boundingBoxes = boundingBoxesBuffer.value(),
+                   .drawTemplates = drawTemplatesBuffer.value(),
+                 });
+
   mainCamera.position = {0, 1.5, 2};
   mainCamera.yaw = -glm::half_pi<float>();
 
@@ -288,6 +256,7 @@ void GpuDrivenApplication::OnWindowResize(uint32_t newWidth, uint32_t newHeight)
 {
   frame.gAlbedo = Fwog::CreateTexture2D({newWidth, newHeight}, Fwog::Format::R8G8B8A8_SRGB);
   frame.gDepth = Fwog::CreateTexture2D({newWidth, newHeight}, Fwog::Format::D32_FLOAT);
+  culler->SetResolution(newWidth, newHeight);
 }
 
 void GpuDrivenApplication::OnUpdate([[maybe_unused]] double dt) {}
@@ -305,80 +274,78 @@ void GpuDrivenApplication::OnRender([[maybe_unused]] double dt)
   mainCameraUniforms.cameraPos = glm::vec4(mainCamera.position, 0.0);
   globalUniformsBuffer.UpdateData(mainCameraUniforms);
 
-  auto gDepthAttachment = Fwog::RenderDepthStencilAttachment{
-    .texture = frame.gDepth.value(),
-    .loadOp = Fwog::AttachmentLoadOp::CLEAR,
-    .clearValue = {.depth = 1.0f},
+  culler->enableOcclusionCulling = config.enableOcclusionCulling;
+
+  // Draws one of the culler's compacted draw lists
+  auto drawScene = [&](uint32_t phase)
+  {
+    Fwog::Cmd::BindGraphicsPipeline(scenePipeline);
+
+    Fwog::Cmd::BindUniformBuffer("GlobalUniforms", globalUniformsBuffer);
+    Fwog::Cmd::BindStorageBuffer("ObjectUniformsBuffer", meshUniformBuffer.value());
+    Fwog::Cmd::BindStorageBuffer("MaterialUniforms", materialsBuffer.value());
+
+    Fwog::Cmd::BindVertexBuffer(0, vertexBuffer.value(), 0, sizeof(Utility::Vertex));
+    Fwog::Cmd::BindIndexBuffer(indexBuffer.value(), Fwog::IndexType::UNSIGNED_INT);
+    Fwog::Cmd::DrawIndexedIndirectCount(culler->GetDrawCommands(),
+                                        culler->GetDrawCommandsOffset(phase),
+                                        culler->GetDrawCounts(),
+                                        culler->GetDrawCountOffset(phase),
+                                        culler->GetObjectCount(),
+                                        sizeof(Fwog::DrawIndexedIndirectCommand));
   };
 
-  // Scene pass. Draw everything that was marked visible in the previous frame's culling pass.
+  // Early phase. Draw everything that was visible last frame and is still in the frustum.
+  if (!config.freezeCulling)
+  {
+    culler->CullEarly(mainCameraUniforms.viewProj);
+  }
+
   auto gColorAttachment = Fwog::RenderColorAttachment{
     .texture = frame.gAlbedo.value(),
     .loadOp = Fwog::AttachmentLoadOp::CLEAR,
     .clearValue = {.1f, .3f, .5f, 0.0f},
   };
+  auto gDepthAttachment = Fwog::RenderDepthStencilAttachment{
+    .texture = frame.gDepth.value(),
+    .loadOp = Fwog::AttachmentLoadOp::CLEAR,
+    .clearValue = {.depth = 1.0f},
+  };
   Fwog::Render(
     {
-      .name = "Scene",
+      .name = "Scene (early)",
       .colorAttachments = std::span(&gColorAttachment, 1),
       .depthAttachment = gDepthAttachment,
     },
-    [&]
-    {
-      Fwog::MemoryBarrier(Fwog::MemoryBarrierBit::COMMAND_BUFFER_BIT | Fwog::MemoryBarrierBit::SHADER_STORAGE_BIT);
+    [&] { drawScene(0); });
 
-      Fwog::Cmd::BindGraphicsPipeline(scenePipeline);
-
-      Fwog::Cmd::BindUniformBuffer("GlobalUniforms", globalUniformsBuffer);
-      Fwog::Cmd::BindStorageBuffer("ObjectUniformsBuffer", meshUniformBuffer.value());
-      Fwog::Cmd::BindStorageBuffer("MaterialUniforms", materialsBuffer.value());
-      Fwog::Cmd::BindStorageBuffer("BoundingBoxesBuffer", boundingBoxesBuffer.value());
-      Fwog::Cmd::BindStorageBuffer("ObjectIndicesBuffer", objectIndicesBuffer.value());
+  // Late phase. Test every object against a Hi-Z built from the early phase's depth, then draw objects that became
+  // visible this frame. Culling against this frame's depth avoids the popping caused by using last frame's depth.
+  if (!config.freezeCulling)
+  {
+    culler->CullLate(mainCameraUniforms.viewProj, frame.gDepth.value());
+  }
 
-      Fwog::Cmd::BindVertexBuffer(0, vertexBuffer.value(), 0, sizeof(Utility::Vertex));
-      Fwog::Cmd::BindIndexBuffer(indexBuffer.value(), Fwog::IndexType::UNSIGNED_INT);
-      Fwog::Cmd::DrawIndexedIndirect(drawCommandsBuffer.value(), 0, static_cast<uint32_t>(scene.meshes.size()), 0);
+  gColorAttachment.loadOp = Fwog::AttachmentLoadOp::LOAD;
+  gDepthAttachment.loadOp = Fwog::AttachmentLoadOp::LOAD;
+  Fwog::Render(
+    {
+      .name = "Scene (late)",
+      .colorAttachments = std::span(&gColorAttachment, 1),
+      .depthAttachment = gDepthAttachment,
+    },
+    [&]
+    {
+      drawScene(1);
 
       if (config.viewBoundingBoxes)
       {
         Fwog::Cmd::BindGraphicsPipeline(boundingBoxDebugPipeline);
-        Fwog::Cmd::Draw(14, static_cast<uint32_t>(scene.meshes.size()), 0, 0);
-      }
-    });
-
-  // Draw culling boxes. If any fragment is visible, objects have their instance count set to 1.
-  // This pass comes after the scene pass because it relies on a depth buffer to have already been created.
-  // That means objects will become visible exactly 1 frame after being disoccluded. This is generally not
-  // noticeable unless at low framerates.
-  if (!config.freezeCulling)
-  {
-    gDepthAttachment.loadOp = Fwog::AttachmentLoadOp::LOAD;
-    Fwog::Render(
-      {
-        .name = "Occlusion culling",
-        .depthAttachment = gDepthAttachment,
-      },
-      [&]
-      {
-        // Re-upload the draw commands buffer to reset the instance counts to 0 for culling.
-        // Ideally, this would be a compute pass where the draw commands are completely regenerated (e.g.,
-        // with frustum culling), or the instance counts are reset to 0.
-        drawCommandsBuffer = Fwog::TypedBuffer<Fwog::DrawIndexedIndirectCommand>(drawCommands);
-
-        // Draw visible bounding boxes.
-        Fwog::Cmd::BindGraphicsPipeline(boundingBoxCullingPipeline);
-
-        Fwog::Cmd::BindUniformBuffer("GlobalUniforms", globalUniformsBuffer);
-        Fwog::Cmd::BindStorageBuffer("ObjectUniformsBuffer", meshUniformBuffer.value());
-        Fwog::Cmd::BindStorageBuffer("MaterialUniforms", materialsBuffer.value());
         Fwog::Cmd::BindStorageBuffer("BoundingBoxesBuffer", boundingBoxesBuffer.value());
         Fwog::Cmd::BindStorageBuffer("ObjectIndicesBuffer", objectIndicesBuffer.value());
-        Fwog::Cmd::BindStorageBuffer("DrawCommandsBuffer", drawCommandsBuffer.value());
-
-        // TODO: upgrade to indirect draw after frustum culling is added.
         Fwog::Cmd::Draw(14, static_cast<uint32_t>(scene.meshes.size()), 0, 0);
-      });
-  }
+      }
+    });
 
   Fwog::BlitTextureToSwapchain(frame.gAlbedo.value(),
                                {},
@@ -393,6 +360,13 @@ void GpuDrivenApplication::OnGui(double dt)
   ImGui::Begin("Options");
   ImGui::Text("Framerate: %.0f Hertz", 1 / dt);
   ImGui::Checkbox("Freeze culling", &config.freezeCulling);
+  ImGui::Checkbox("Occlusion culling", &config.enableOcclusionCulling);
+
+  const auto stats = culler->GetStats();
+  ImGui::Text("Objects: %u", culler->GetObjectCount());
+  ImGui::Text("Visible: %u", stats.visibleObjects);
+  ImGui::Text("Drawn early: %u", stats.earlyDraws);
+  ImGui::Text("Drawn late: %u", stats.lateDraws);
   ImGui::Checkbox("View bounding boxes", &config.viewBoundingBoxes);
   ImGui::End();
 }
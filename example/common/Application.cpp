@@ -3,6 +3,7 @@
 
 #include <Fwog/Context.h>
 #include <Fwog/DebugMarker.h>
+#include <Fwog/ShaderPreprocessor.h>
 
 #include FWOG_OPENGL_HEADER
 #include <GLFW/glfw3.h>
@@ -159,6 +160,12 @@ std::string Application::LoadFile(const std::filesystem::path& path)
   return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
 }
 
+std::string Application::LoadFileWithInclude(std::string_view path)
+{
+  static auto preprocessor = Fwog::ShaderPreprocessor();
+  return preprocessor.Preprocess(path).source;
+}
+
 std::pair<std::unique_ptr<std::byte[]>, std::size_t> Application::LoadBinaryFile(const std::filesystem::path& path)
 {
   std::size_t fsize = std::filesystem::file_size(path);
@@ -238,6 +245,8 @@ Application::Application(const CreateInfo& createInfo)
   Fwog::Initialize({
     .glLoadFunc = glfwGetProcAddress,
     .verboseMessageCallback = fwogCallback,
+    .enableDrawBatching = createInfo.enableDrawBatching,
+    .deferredDestructionFrames = 2,
   });
 
   // Set up the GL debug message callback.
@@ -294,6 +303,7 @@ void Application::Draw(double dt)
   }
 
   glfwSwapBuffers(window);
+  Fwog::ProcessDeferredDestruction();
 }
 
 void Application::Run()
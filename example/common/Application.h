@@ -32,10 +32,14 @@ public:
     bool maximize = false;
     bool decorate = true;
     bool vsync = true;
+    bool enableDrawBatching = false;
   };
 
   // TODO: An easy way to load shaders should probably be a part of Fwog
   static std::string LoadFile(const std::filesystem::path& path);
+
+  // Loads a shader and expands its #include directives. Headers shared by several shaders are only read once
+  static std::string LoadFileWithInclude(std::string_view path);
   static std::pair<std::unique_ptr<std::byte[]>, std::size_t> LoadBinaryFile(const std::filesystem::path& path);
 
   Application(const CreateInfo& createInfo);
@@ -0,0 +1,247 @@
+#include "HiZCulling.h"
+#include "Application.h"
+
+#include <Fwog/BindGroup.h>
+#include <Fwog/Fence.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Shader.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace Culling
+{
+  static Fwog::ComputePipeline CreateCullPipeline()
+  {
+    auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER,
+                           Application::LoadFileWithInclude("shaders/gpu_driven/Cull.comp.glsl"));
+    return Fwog::ComputePipeline({.name = "Cull objects", .shader = &cs});
+  }
+
+  static Fwog::ComputePipeline CreateHiZReducePipeline()
+  {
+    auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, Application::LoadFile("shaders/gpu_driven/HiZReduce.comp.glsl"));
+    return Fwog::ComputePipeline({.name = "Hi-Z reduce", .shader = &cs});
+  }
+
+  static Fwog::Sampler GetNearestSampler()
+  {
+    Fwog::SamplerState ss;
+    ss.minFilter = Fwog::Filter::NEAREST;
+    ss.magFilter = Fwog::Filter::NEAREST;
+    ss.mipmapFilter = Fwog::Filter::NEAREST;
+    return Fwog::Sampler(ss);
+  }
+
+  TwoPhaseCuller::TwoPhaseCuller(uint32_t objectCount, const CullInputs& inputs)
+    : objectCount(objectCount),
+      inputs(inputs),
+      cullPipeline(CreateCullPipeline()),
+      hizReducePipeline(CreateHiZReducePipeline()),
+      cullUniformsBuffer(Fwog::BufferStorageFlag::DYNAMIC_STORAGE),
+      drawCommandsBuffer(2 * std::max(objectCount, 1u) * sizeof(Fwog::DrawIndexedIndirectCommand)),
+      drawCountsBuffer(sizeof(CullStats)),
+      visibilityBuffer(std::max(objectCount, 1u) * sizeof(uint32_t)),
+      statsReadbackBuffer(Fwog::BufferStorageFlag::MAP_MEMORY | Fwog::BufferStorageFlag::CLIENT_STORAGE)
+  {
+    drawCountsBuffer.FillData();
+    std::memset(statsReadbackBuffer.GetMappedPointer(), 0, sizeof(CullStats));
+    ResetVisibility();
+  }
+
+  void TwoPhaseCuller::SetResolution(uint32_t width, uint32_t height)
+  {
+    // Level 0 of the pyramid is the largest power of two that fits in the depth buffer, so each level is exactly half
+    // the size of the one before it
+    const auto hizWidth = std::bit_floor(std::max(width, 1u));
+    const auto hizHeight = std::bit_floor(std::max(height, 1u));
+    const auto levels = static_cast<uint32_t>(std::bit_width(std::max(hizWidth, hizHeight)));
+
+    hizLevelViews.clear();
+    hiz = Fwog::CreateTexture2DMip({hizWidth, hizHeight}, Fwog::Format::R32_FLOAT, levels, "Hi-Z");
+    for (uint32_t level = 0; level < levels; level++)
+    {
+      hizLevelViews.push_back(hiz->CreateSingleMipView(level));
+    }
+
+    // Both phases use the same resources, so slots that still hold them from the early phase aren't rebound
+    const Fwog::BindGroupBuffer uniformBuffers[] = {{.index = 0, .buffer = cullUniformsBuffer}};
+    const Fwog::BindGroupBuffer storageBuffers[] = {
+      {.index = 0, .buffer = inputs.objects},
+      {.index = 1, .buffer = inputs.boundingBoxes},
+      {.index = 2, .buffer = inputs.drawTemplates},
+      {.index = 3, .buffer = drawCommandsBuffer},
+      {.index = 4, .buffer = drawCountsBuffer},
+      {.index = 5, .buffer = visibilityBuffer},
+    };
+    const Fwog::BindGroupSampledImage sampledImages[] = {{.index = 0, .texture = *hiz, .sampler = GetNearestSampler()}};
+    cullBindGroup = Fwog::BindGroup({
+      .uniformBuffers = uniformBuffers,
+      .storageBuffers = storageBuffers,
+      .sampledImages = sampledImages,
+    });
+  }
+
+  void TwoPhaseCuller::CullEarly(const glm::mat4& viewProj)
+  {
+    drawCountsBuffer.FillData();
+    Cull(0, viewProj);
+  }
+
+  void TwoPhaseCuller::CullLate(const glm::mat4& viewProj, const Fwog::Texture& depth)
+  {
+    BuildHiZ(depth);
+    Cull(1, viewProj);
+
+    // Copy the counts to host-visible memory. They are read in a later frame, by which time the copy has usually
+    // finished, so there is no need to wait on it
+    Fwog::MemoryBarrier(Fwog::MemoryBarrierBit::BUFFER_UPDATE_BIT);
+    Fwog::CopyBuffer({.source = drawCountsBuffer, .target = statsReadbackBuffer, .size = sizeof(CullStats)});
+  }
+
+  void TwoPhaseCuller::ResetVisibility()
+  {
+    visibilityBuffer.FillData({.data = 1});
+  }
+
+  CullStats TwoPhaseCuller::GetStats() const
+  {
+    return *statsReadbackBuffer.GetMappedPointer();
+  }
+
+  void TwoPhaseCuller::Cull(uint32_t phase, const glm::mat4& viewProj)
+  {
+    FWOG_ASSERT(cullBindGroup.has_value() && "SetResolution must be called before culling");
+
+    cullUniformsBuffer.UpdateData(CullUniforms{
+      .viewProj = viewProj,
+      .objectCount = objectCount,
+      .phase = phase,
+      .hizLevels = static_cast<uint32_t>(hizLevelViews.size()),
+      .enableOcclusion = enableOcclusionCulling,
+      .hizSize = glm::vec2(hiz->Extent().width, hiz->Extent().height),
+    });
+
+    Fwog::Compute(phase == 0 ? "Cull early" : "Cull late",
+                  [&]
+                  {
+                    // Make the previous late phase's visibility, the Hi-Z, and the cleared counts visible
+                    Fwog::MemoryBarrier(Fwog::MemoryBarrierBit::SHADER_STORAGE_BIT |
+                                        Fwog::MemoryBarrierBit::TEXTURE_FETCH_BIT);
+
+                    Fwog::Cmd::BindComputePipeline(cullPipeline);
+                    Fwog::Cmd::BindGroup(*cullBindGroup);
+                    Fwog::Cmd::DispatchInvocations(objectCount, 1, 1);
+
+                    // The draw commands and counts will be consumed by indirect draws
+                    Fwog::MemoryBarrier(Fwog::MemoryBarrierBit::COMMAND_BUFFER_BIT |
+                                        Fwog::MemoryBarrierBit::SHADER_STORAGE_BIT);
+                  });
+  }
+
+  void TwoPhaseCuller::BuildHiZ(const Fwog::Texture& depth)
+  {
+    Fwog::Compute("Build Hi-Z",
+                  [&]
+                  {
+                    const auto sampler = GetNearestSampler();
+                    Fwog::Cmd::BindComputePipeline(hizReducePipeline);
+
+                    for (uint32_t level = 0; level < hizLevelViews.size(); level++)
+                    {
+                      if (level > 0)
+                      {
+                        Fwog::MemoryBarrier(Fwog::MemoryBarrierBit::TEXTURE_FETCH_BIT);
+                      }
+
+                      const Fwog::Texture& source = level == 0 ? depth : hizLevelViews[level - 1];
+                      Fwog::Cmd::BindSampledImage(0, source, sampler);
+                      Fwog::Cmd::BindImage(0, hizLevelViews[level], 0);
+                      Fwog::Cmd::DispatchInvocations(hizLevelViews[level]);
+                    }
+                  });
+  }
+
+  bool RunSelfTest()
+  {
+    // The view-projection is the identity, so the boxes are specified in NDC. The left half of the depth buffer holds
+    // an occluder at NDC depth 0 and the right half is empty
+    const auto viewProj = glm::mat4(1);
+    const auto objects = std::vector<ObjectUniforms>(4, ObjectUniforms{.model = glm::mat4(1), .materialIdx = 0});
+    const auto boundingBoxes = std::vector<BoundingBox>{
+      {.offset = {-0.5f, 0.0f, 0.5f}, .halfExtent = glm::vec3(0.1f)},  // Behind the occluder
+      {.offset = {-0.5f, 0.0f, -0.5f}, .halfExtent = glm::vec3(0.1f)}, // In front of the occluder
+      {.offset = {0.5f, 0.0f, 0.5f}, .halfExtent = glm::vec3(0.1f)},   // Nothing in front of it
+      {.offset = {3.0f, 0.0f, 0.0f}, .halfExtent = glm::vec3(0.1f)},   // Outside the frustum
+    };
+    const auto drawTemplate = Fwog::DrawIndexedIndirectCommand{
+      .indexCount = 36,
+      .instanceCount = 1,
+      .firstIndex = 0,
+      .vertexOffset = 0,
+      .firstInstance = 0,
+    };
+    const auto drawTemplates = std::vector<Fwog::DrawIndexedIndirectCommand>(4, drawTemplate);
+
+    const auto objectsBuffer = Fwog::TypedBuffer<ObjectUniforms>(objects);
+    const auto boundingBoxesBuffer = Fwog::TypedBuffer<BoundingBox>(boundingBoxes);
+    const auto drawTemplatesBuffer = Fwog::TypedBuffer<Fwog::DrawIndexedIndirectCommand>(drawTemplates);
+
+    constexpr uint32_t size = 64;
+    auto depthValues = std::vector<float>(size * size);
+    for (uint32_t i = 0; i < depthValues.size(); i++)
+    {
+      depthValues[i] = i % size < size / 2 ? 0.5f : 1.0f;
+    }
+
+    auto depth = Fwog::CreateTexture2D({size, size}, Fwog::Format::D32_FLOAT, "Cull self-test depth");
+    depth.UpdateImage({
+      .extent = {size, size, 1},
+      .format = Fwog::UploadFormat::DEPTH_COMPONENT,
+      .type = Fwog::UploadType::FLOAT,
+      .pixels = depthValues.data(),
+    });
+
+    auto culler = TwoPhaseCuller(static_cast<uint32_t>(objects.size()),
+                                 {
+                                   .objects = objectsBuffer,
+                                   .boundingBoxes = boundingBoxesBuffer,
+                                   .drawTemplates = drawTemplatesBuffer,
+                                 });
+    culler.SetResolution(size, size);
+
+    const auto check = [&](const char* frame, CullStats expected)
+    {
+      culler.CullEarly(viewProj);
+      culler.CullLate(viewProj, depth);
+
+      auto fence = Fwog::Fence();
+      fence.Signal();
+      fence.Wait();
+
+      const auto stats = culler.GetStats();
+      if (stats.earlyDraws == expected.earlyDraws && stats.lateDraws == expected.lateDraws &&
+          stats.visibleObjects == expected.visibleObjects)
+      {
+        return true;
+      }
+
+      std::cout << "Culling self-test failed (" << frame << "): expected " << expected.earlyDraws << " early, "
+                << expected.lateDraws << " late, and " << expected.visibleObjects << " visible, but got "
+                << stats.earlyDraws << ", " << stats.lateDraws << ", and " << stats.visibleObjects << '\n';
+      return false;
+    };
+
+    // Every object starts out visible, so the three in the frustum are drawn early, and the occluded one is culled late
+    bool passed = check("first frame", {.earlyDraws = 3, .lateDraws = 0, .visibleObjects = 2});
+
+    // Without occlusion culling, the object that was occluded last frame is drawn late
+    culler.enableOcclusionCulling = false;
+    passed &= check("occlusion disabled", {.earlyDraws = 2, .lateDraws = 1, .visibleObjects = 3});
+
+    return passed;
+  }
+} // namespace Culling
@@ -0,0 +1,152 @@
+#pragma once
+#include <Fwog/BasicTypes.h>
+#include <Fwog/BindGroup.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/Pipeline.h>
+#include <Fwog/Texture.h>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace Culling
+{
+  // Elements of CullInputs::objects. The layout must match shaders/gpu_driven/Cull.comp.glsl
+  struct alignas(16) ObjectUniforms
+  {
+    glm::mat4 model;
+    uint32_t materialIdx;
+  };
+
+  // Elements of CullInputs::boundingBoxes, in object space. The layout must match shaders/gpu_driven/Cull.comp.glsl
+  struct alignas(16) BoundingBox
+  {
+    glm::vec3 offset;
+    uint32_t padding_0;
+    glm::vec3 halfExtent;
+    uint32_t padding_1;
+  };
+
+  // Per-object data read by the culling shader
+  //   objects:       one ObjectUniforms per object
+  //   boundingBoxes: one BoundingBox per object
+  //   drawTemplates: one DrawIndexedIndirectCommand per object. instanceCount and firstInstance are ignored
+  struct CullInputs
+  {
+    const Fwog::Buffer& objects;
+    const Fwog::Buffer& boundingBoxes;
+    const Fwog::Buffer& drawTemplates;
+  };
+
+  // Draw counts from a previous frame, read back without stalling
+  struct CullStats
+  {
+    uint32_t earlyDraws{};
+    uint32_t lateDraws{};
+    uint32_t visibleObjects{};
+  };
+
+  // Two-phase GPU occlusion culling against a hierarchical depth buffer (Hi-Z).
+  //
+  // Each frame:
+  // 1. CullEarly: objects that were visible last frame and are inside the frustum are written to the early draw list.
+  // 2. The caller draws the early list, producing a depth buffer that contains most occluders.
+  // 3. CullLate: a Hi-Z pyramid is built from that depth buffer, then every object is tested against the frustum and
+  //    the pyramid. Visible objects that were not drawn early are written to the late draw list, and the visibility of
+  //    every object is stored for the next frame.
+  // 4. The caller draws the late list on top of the early one.
+  //
+  // Draw commands are compacted, so both lists must be drawn with Cmd::DrawIndexedIndirectCount. Each command's
+  // firstInstance holds the object index, so shaders should index per-object data with gl_BaseInstance.
+  //
+  // Assumes clip-space depth in [-1, 1] and a depth buffer where smaller values are closer (CompareOp::LESS).
+  class TwoPhaseCuller
+  {
+  public:
+    // The input buffers must outlive the culler
+    TwoPhaseCuller(uint32_t objectCount, const CullInputs& inputs);
+
+    // Must be called before culling and whenever the depth buffer's size changes
+    void SetResolution(uint32_t width, uint32_t height);
+
+    void CullEarly(const glm::mat4& viewProj);
+    void CullLate(const glm::mat4& viewProj, const Fwog::Texture& depth);
+
+    // Marks every object as visible so the next early phase draws everything in the frustum
+    void ResetVisibility();
+
+    [[nodiscard]] const Fwog::Buffer& GetDrawCommands() const
+    {
+      return drawCommandsBuffer;
+    }
+
+    [[nodiscard]] const Fwog::Buffer& GetDrawCounts() const
+    {
+      return drawCountsBuffer;
+    }
+
+    // phase: 0 for the early list, 1 for the late list
+    [[nodiscard]] uint64_t GetDrawCommandsOffset(uint32_t phase) const
+    {
+      return phase * objectCount * sizeof(Fwog::DrawIndexedIndirectCommand);
+    }
+
+    [[nodiscard]] uint64_t GetDrawCountOffset(uint32_t phase) const
+    {
+      return phase * sizeof(uint32_t);
+    }
+
+    [[nodiscard]] uint32_t GetObjectCount() const
+    {
+      return objectCount;
+    }
+
+    [[nodiscard]] const Fwog::Texture& GetHiZ() const
+    {
+      return hiz.value();
+    }
+
+    // Returns the counts from the most recent CullLate whose results have reached the readback buffer. The counts lag
+    // the current frame by up to a few frames
+    [[nodiscard]] CullStats GetStats() const;
+
+    bool enableOcclusionCulling = true;
+
+  private:
+    struct CullUniforms
+    {
+      glm::mat4 viewProj;
+      uint32_t objectCount;
+      uint32_t phase;
+      uint32_t hizLevels;
+      uint32_t enableOcclusion;
+      glm::vec2 hizSize;
+    };
+
+    void Cull(uint32_t phase, const glm::mat4& viewProj);
+    void BuildHiZ(const Fwog::Texture& depth);
+
+    uint32_t objectCount;
+    CullInputs inputs;
+    Fwog::ComputePipeline cullPipeline;
+    Fwog::ComputePipeline hizReducePipeline;
+    Fwog::TypedBuffer<CullUniforms> cullUniformsBuffer;
+    Fwog::Buffer drawCommandsBuffer;
+    Fwog::Buffer drawCountsBuffer;
+    Fwog::Buffer visibilityBuffer;
+    Fwog::TypedBuffer<CullStats> statsReadbackBuffer;
+    std::optional<Fwog::Texture> hiz;
+    std::vector<Fwog::TextureView> hizLevelViews;
+
+    // Binds everything the culling shader uses. Rebuilt with the Hi-Z
+    std::optional<Fwog::BindGroup> cullBindGroup;
+  };
+
+  // Culls a small scene with a known result against a synthetic depth buffer, then reads back the stats and compares
+  // them with the expected counts. Mismatches are printed. Returns true if every count matched
+  bool RunSelfTest();
+} // namespace Culling
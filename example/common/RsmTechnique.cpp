@@ -8,9 +8,6 @@
 #include <imgui.h>
 
 #include <stb_image.h>
-#define STB_INCLUDE_IMPLEMENTATION
-#define STB_INCLUDE_LINE_GLSL
-#include <stb_include.h>
 
 #include <memory>
 #include <utility>
@@ -39,15 +36,6 @@ static float rng(glm::uint& state)
   return float(x) * glm::uintBitsToFloat(0x2f800004u);
 }
 
-static std::string LoadFileWithInclude(std::string_view path)
-{
-  char error[256] = {};
-  char* included = stb_include_string(Application::LoadFile(path).data(), nullptr, "shaders/rsm", "", error);
-  std::string includedStr = included;
-  free(included);
-  return includedStr;
-}
-
 static Fwog::ComputePipeline CreateRsmIndirectPipeline()
 {
   auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, Application::LoadFile("shaders/rsm/Indirect.comp.glsl"));
@@ -63,32 +51,36 @@ static Fwog::ComputePipeline CreateRsmIndirectFilteredPipeline()
 
 static Fwog::ComputePipeline CreateRsmReprojectPipeline()
 {
-  auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, LoadFileWithInclude("shaders/rsm/Reproject.comp.glsl"));
+  auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER,
+                         Application::LoadFileWithInclude("shaders/rsm/Reproject.comp.glsl"));
   return Fwog::ComputePipeline({.shader = &cs});
 }
 
 static Fwog::ComputePipeline CreateBilateral5x5Pipeline()
 {
-  auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, LoadFileWithInclude("shaders/rsm/Bilateral5x5.comp.glsl"));
+  auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER,
+                         Application::LoadFileWithInclude("shaders/rsm/Bilateral5x5.comp.glsl"));
   return Fwog::ComputePipeline({.shader = &cs});
 }
 
 static Fwog::ComputePipeline CreateModulatePipeline()
 {
-  auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, LoadFileWithInclude("shaders/rsm/Modulate.comp.glsl"));
+  auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER,
+                         Application::LoadFileWithInclude("shaders/rsm/Modulate.comp.glsl"));
   return Fwog::ComputePipeline({.shader = &cs});
 }
 
 static Fwog::ComputePipeline CreateModulateUpscalePipeline()
 {
-  auto cs =
-    Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, LoadFileWithInclude("shaders/rsm/ModulateUpscale.comp.glsl"));
+  auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER,
+                         Application::LoadFileWithInclude("shaders/rsm/ModulateUpscale.comp.glsl"));
   return Fwog::ComputePipeline({.shader = &cs});
 }
 
 static Fwog::ComputePipeline CreateBlitPipeline()
 {
-  auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, LoadFileWithInclude("shaders/rsm/BlitTexture.comp.glsl"));
+  auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER,
+                         Application::LoadFileWithInclude("shaders/rsm/BlitTexture.comp.glsl"));
   return Fwog::ComputePipeline({.shader = &cs});
 }
 
@@ -2,18 +2,26 @@
 #include "Application.h"
 
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstring>
 #include <execution>
+#include <fstream>
 #include <iostream>
 #include <numeric>
 #include <optional>
 #include <ranges>
 #include <span>
 #include <stack>
+#include <type_traits>
+#include <unordered_map>
 
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/transform.hpp>
 
+#include <Fwog/Fence.h>
+#include <Fwog/Rendering.h>
+
 #include "ktx.h"
 
 #include FWOG_OPENGL_HEADER
@@ -150,29 +158,31 @@ namespace Utility
       }
     }
 
-    std::vector<Fwog::Texture> LoadImages(const fastgltf::Asset& asset)
+    struct RawImageData
     {
-      struct RawImageData
-      {
-        // Used for ktx and non-ktx images alike
-        std::unique_ptr<std::byte[]> encodedPixelData = {};
-        std::size_t encodedPixelSize = 0;
-
-        bool isKtx = false;
-        int width = 0;
-        int height = 0;
-        int pixel_type = GL_UNSIGNED_BYTE;
-        int bits = 8;
-        int components = 0;
-        std::string name;
-
-        // Non-ktx. Raw decoded pixel data
-        std::unique_ptr<unsigned char[]> data = {};
-
-        // ktx
-        std::unique_ptr<ktxTexture2, decltype([](ktxTexture2* p) { ktxTexture_Destroy(ktxTexture(p)); })> ktx = {};
-      };
+      // Used for ktx and non-ktx images alike
+      std::unique_ptr<std::byte[]> encodedPixelData = {};
+      std::size_t encodedPixelSize = 0;
+
+      bool isKtx = false;
+      int width = 0;
+      int height = 0;
+      int pixel_type = GL_UNSIGNED_BYTE;
+      int bits = 8;
+      int components = 0;
+      std::string name;
+
+      // Non-ktx. Raw decoded pixel data
+      std::unique_ptr<unsigned char[]> data = {};
+
+      // ktx
+      std::unique_ptr<ktxTexture2, decltype([](ktxTexture2* p) { ktxTexture_Destroy(ktxTexture(p)); })> ktx = {};
+      Fwog::Format ktxFormat = Fwog::Format::BC7_RGBA_UNORM;
+    };
 
+    // Reads and decodes every image in the asset, in parallel. KTX images are loaded but not transcoded
+    std::vector<RawImageData> DecodeImages(const fastgltf::Asset& asset)
+    {
       auto MakeRawImageData =
         [](const void* data, std::size_t dataSize, fastgltf::MimeType mimeType, std::string_view name) -> RawImageData
       {
@@ -269,10 +279,57 @@ namespace Utility
             rawImage.data.reset(pixels);
           }
 
+          // The encoded data is no longer needed
+          rawImage.encodedPixelData.reset();
+
           return rawImage;
         });
 
-      // Upload image data to GPU
+      return rawImageData;
+    }
+
+    // Transcodes supercompressed KTX images to BC7, in parallel
+    void TranscodeImages(std::span<RawImageData> images)
+    {
+      auto Transcode = [](RawImageData& image)
+      {
+        if (!image.isKtx)
+        {
+          return;
+        }
+
+        auto* ktx = image.ktx.get();
+
+        // If the image needs is in a supercompressed encoding, transcode it to a desired format
+        if (ktxTexture2_NeedsTranscoding(ktx))
+        {
+          if (auto result = ktxTexture2_TranscodeBasis(ktx, KTX_TTF_BC7_RGBA, KTX_TF_HIGH_QUALITY); result != KTX_SUCCESS)
+          {
+            FWOG_UNREACHABLE;
+          }
+          image.ktxFormat = Fwog::Format::BC7_RGBA_UNORM;
+        }
+        else
+        {
+          // Use the format that the image is already in
+          image.ktxFormat = VkBcFormatToFwog(ktx->vkFormat);
+        }
+      };
+
+      // libktx lazily initializes the transcoder on first use without synchronization, so transcode one image up front
+      auto first = std::ranges::find_if(images, [](const RawImageData& image) { return image.isKtx; });
+      if (first == images.end())
+      {
+        return;
+      }
+
+      Transcode(*first);
+      std::for_each(std::execution::par, first + 1, images.end(), Transcode);
+    }
+
+    // Creates textures for decoded and transcoded images. Must be called on the thread that owns the context
+    std::vector<Fwog::Texture> UploadImages(std::span<const RawImageData> rawImageData)
+    {
       auto loadedImages = std::vector<Fwog::Texture>();
       loadedImages.reserve(rawImageData.size());
 
@@ -285,23 +342,7 @@ namespace Utility
         {
           auto* ktx = image.ktx.get();
 
-          auto format = Fwog::Format::BC7_RGBA_UNORM;
-
-          // If the image needs is in a supercompressed encoding, transcode it to a desired format
-          if (ktxTexture2_NeedsTranscoding(ktx))
-          {
-            if (auto result = ktxTexture2_TranscodeBasis(ktx, KTX_TTF_BC7_RGBA, KTX_TF_HIGH_QUALITY); result != KTX_SUCCESS)
-            {
-              FWOG_UNREACHABLE;
-            }
-          }
-          else
-          {
-            // Use the format that the image is already in
-            format = VkBcFormatToFwog(ktx->vkFormat);
-          }
-
-          auto textureData = Fwog::CreateTexture2DMip(dims, format, ktx->numLevels, image.name);
+          auto textureData = Fwog::CreateTexture2DMip(dims, image.ktxFormat, ktx->numLevels, image.name);
 
           for (uint32_t level = 0; level < ktx->numLevels; level++)
           {
@@ -437,7 +478,15 @@ namespace Utility
     return indices;
   }
 
-  std::vector<Material> LoadMaterials(const fastgltf::Asset& model, std::span<Fwog::Texture> images)
+  // A material that refers to its base color image by index, so it can be stored before textures are created
+  struct MaterialRecord
+  {
+    GpuMaterial gpuMaterial{};
+    int32_t baseColorImageIndex = -1;
+    Fwog::SamplerState baseColorSampler{};
+  };
+
+  std::vector<MaterialRecord> LoadMaterials(const fastgltf::Asset& model)
   {
     auto LoadSampler = [](const fastgltf::Sampler& sampler)
     {
@@ -463,7 +512,7 @@ namespace Utility
       return samplerState;
     };
 
-    std::vector<Material> materials;
+    std::vector<MaterialRecord> materials;
 
     for (const auto& loaderMaterial : model.materials)
     {
@@ -476,20 +525,41 @@ namespace Utility
         baseColorFactor[i] = static_cast<float>(loaderMaterial.pbrData->baseColorFactor[i]);
       }
 
-      Material material;
+      MaterialRecord material;
 
       if (loaderMaterial.pbrData->baseColorTexture.has_value())
       {
         auto baseColorTextureIndex = loaderMaterial.pbrData->baseColorTexture->textureIndex;
         const auto& baseColorTexture = model.textures[baseColorTextureIndex];
-        auto& image = images[baseColorTexture.imageIndex.value()];
         material.gpuMaterial.flags |= MaterialFlagBit::HAS_BASE_COLOR_TEXTURE;
-        material.albedoTextureSampler = {image.CreateFormatView(FormatToSrgb(image.GetCreateInfo().format)),
-                                         LoadSampler(model.samplers[baseColorTexture.samplerIndex.value()])};
+        material.baseColorImageIndex = static_cast<int32_t>(baseColorTexture.imageIndex.value());
+        material.baseColorSampler = LoadSampler(model.samplers[baseColorTexture.samplerIndex.value()]);
       }
 
       material.gpuMaterial.baseColorFactor = baseColorFactor;
       material.gpuMaterial.alphaCutoff = static_cast<float>(loaderMaterial.alphaCutoff);
+      materials.emplace_back(material);
+    }
+
+    return materials;
+  }
+
+  std::vector<Material> CreateMaterials(std::span<const MaterialRecord> records, std::span<Fwog::Texture> images)
+  {
+    std::vector<Material> materials;
+    materials.reserve(records.size());
+
+    for (const auto& record : records)
+    {
+      Material material{.gpuMaterial = record.gpuMaterial};
+
+      if (record.gpuMaterial.flags & MaterialFlagBit::HAS_BASE_COLOR_TEXTURE)
+      {
+        auto& image = images[record.baseColorImageIndex];
+        material.albedoTextureSampler = {image.CreateFormatView(FormatToSrgb(image.GetCreateInfo().format)),
+                                         record.baseColorSampler};
+      }
+
       materials.emplace_back(std::move(material));
     }
 
@@ -519,6 +589,7 @@ namespace Utility
     std::vector<index_t> indices;
     uint32_t materialIdx;
     glm::mat4 transform;
+    Box3D boundingBox;
   };
 
   struct LoadModelResult
@@ -527,11 +598,478 @@ namespace Utility
     std::vector<Material> materials;
   };
 
-  std::optional<LoadModelResult> LoadModelFromFileBase(std::filesystem::path path,
-                                                       glm::mat4 rootTransform,
-                                                       bool binary,
-                                                       uint32_t baseMaterialIndex)
+  namespace
+  {
+    void PrintTimings(const std::filesystem::path& path, const LoadTimings& timings)
+    {
+      std::cout << "Loaded glTF: " << path << " in " << timings.total << " ms"
+                << (timings.cacheHit ? " (from cache)\n" : "\n")
+                << "  parse:            " << timings.parse << " ms\n"
+                << "  decode images:    " << timings.decodeImages << " ms\n"
+                << "  transcode images: " << timings.transcodeImages << " ms\n"
+                << "  convert geometry: " << timings.convertGeometry << " ms\n"
+                << "  upload images:    " << timings.uploadImages << " ms\n"
+                << "  upload geometry:  " << timings.uploadGeometry << " ms\n"
+                << "  write cache:      " << timings.writeCache << " ms\n";
+    }
+
+    // The scene cache is a file next to the source asset that holds everything LoadModelFromFileBase produces, in a
+    // form that can be uploaded without parsing. Arrays are aligned to 16 bytes so the file could be mapped directly.
+    //
+    // Layout: SceneCacheHeader, then for each mesh a CachedMeshHeader followed by its vertices and indices, then the
+    // MaterialRecords, then for each image a CachedImageHeader followed by its name and each mip level's size and data.
+    constexpr std::array<char, 8> sceneCacheMagic = {'F', 'W', 'O', 'G', 'S', 'C', 'N', '\0'};
+
+    // Increment when the layout or the data produced by the loader changes
+    constexpr uint32_t sceneCacheVersion = 1;
+
+    constexpr uint64_t sceneCacheAlignment = 16;
+
+    struct SceneCacheHeader
+    {
+      std::array<char, 8> magic{};
+      uint32_t version{};
+      uint32_t reserved{};
+      uint64_t sourceHash{};
+      uint64_t meshCount{};
+      uint64_t materialCount{};
+      uint64_t imageCount{};
+    };
+
+    struct CachedMeshHeader
+    {
+      uint64_t vertexCount{};
+      uint64_t indexCount{};
+      uint32_t materialIdx{};
+      uint32_t reserved{};
+      glm::mat4 transform{};
+      Box3D boundingBox{};
+    };
+
+    struct CachedImageHeader
+    {
+      Fwog::Format format{};
+      uint32_t isCompressed{};
+      uint32_t width{};
+      uint32_t height{};
+      uint32_t levelCount{};
+      uint32_t nameLength{};
+    };
+
+    struct CachedImage
+    {
+      CachedImageHeader header;
+      std::string name;
+
+      // Points into the cache file's contents
+      std::vector<std::span<const std::byte>> levels;
+    };
+
+    struct SceneCacheContents
+    {
+      std::unique_ptr<std::byte[]> fileData;
+      std::vector<CpuMesh> meshes;
+      std::vector<MaterialRecord> materials;
+      std::vector<CachedImage> images;
+    };
+
+    constexpr uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+      return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // FNV-1a
+    uint64_t HashFile(const std::filesystem::path& path)
+    {
+      auto [data, size] = Application::LoadBinaryFile(path);
+
+      uint64_t hash = 14695981039346656037ull;
+      for (size_t i = 0; i < size; i++)
+      {
+        hash ^= static_cast<uint64_t>(data[i]);
+        hash *= 1099511628211ull;
+      }
+
+      return hash;
+    }
+
+    class CacheWriter
+    {
+    public:
+      explicit CacheWriter(const std::filesystem::path& path) : file_(path, std::ofstream::binary) {}
+
+      template<typename T>
+      void Write(const T& value)
+      {
+        static_assert(std::is_trivially_copyable_v<T>);
+        WriteBytes(&value, sizeof(T));
+      }
+
+      template<typename T>
+      void WriteArray(std::span<const T> values)
+      {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Align();
+        WriteBytes(values.data(), values.size_bytes());
+      }
+
+      void WriteBytes(const void* data, size_t size)
+      {
+        file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        offset_ += size;
+      }
+
+      void Align()
+      {
+        constexpr char zeros[sceneCacheAlignment] = {};
+        WriteBytes(zeros, AlignUp(offset_, sceneCacheAlignment) - offset_);
+      }
+
+      [[nodiscard]] bool Good() const
+      {
+        return file_.good();
+      }
+
+    private:
+      std::ofstream file_;
+      uint64_t offset_{};
+    };
+
+    // Reads values from the contents of a cache file. Reading past the end sets a flag instead of failing immediately,
+    // so callers only need to check Failed once
+    class CacheReader
+    {
+    public:
+      explicit CacheReader(std::span<const std::byte> data) : data_(data) {}
+
+      template<typename T>
+      T Read()
+      {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value{};
+        if (auto bytes = ReadBytes(sizeof(T)); !bytes.empty())
+        {
+          std::memcpy(&value, bytes.data(), sizeof(T));
+        }
+        return value;
+      }
+
+      template<typename T>
+      std::vector<T> ReadArray(uint64_t count)
+      {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Align();
+        if (count > (data_.size() - offset_) / sizeof(T))
+        {
+          failed_ = true;
+          return {};
+        }
+
+        auto values = std::vector<T>(count);
+        std::memcpy(values.data(), data_.data() + offset_, count * sizeof(T));
+        offset_ += count * sizeof(T);
+        return values;
+      }
+
+      std::span<const std::byte> ReadBytes(uint64_t size)
+      {
+        if (failed_ || size > data_.size() - offset_)
+        {
+          failed_ = true;
+          return {};
+        }
+
+        auto bytes = data_.subspan(offset_, size);
+        offset_ += size;
+        return bytes;
+      }
+
+      void Align()
+      {
+        ReadBytes(AlignUp(offset_, sceneCacheAlignment) - offset_);
+      }
+
+      [[nodiscard]] bool Failed() const
+      {
+        return failed_;
+      }
+
+    private:
+      std::span<const std::byte> data_;
+      uint64_t offset_{};
+      bool failed_{};
+    };
+
+    // Returns std::nullopt if the cache doesn't exist, is stale, or is malformed
+    std::optional<SceneCacheContents> ReadSceneCache(const std::filesystem::path& cachePath, uint64_t sourceHash)
+    {
+      if (!std::filesystem::exists(cachePath))
+      {
+        return std::nullopt;
+      }
+
+      // The file is read in one call. Everything after that is copying or pointing into its contents
+      auto [fileData, fileSize] = Application::LoadBinaryFile(cachePath);
+      auto reader = CacheReader({fileData.get(), fileSize});
+
+      const auto header = reader.Read<SceneCacheHeader>();
+      if (reader.Failed() || header.magic != sceneCacheMagic || header.version != sceneCacheVersion ||
+          header.sourceHash != sourceHash)
+      {
+        return std::nullopt;
+      }
+
+      SceneCacheContents contents;
+
+      for (uint64_t i = 0; i < header.meshCount && !reader.Failed(); i++)
+      {
+        const auto meshHeader = reader.Read<CachedMeshHeader>();
+        auto vertices = reader.ReadArray<Vertex>(meshHeader.vertexCount);
+        auto indices = reader.ReadArray<index_t>(meshHeader.indexCount);
+        contents.meshes.emplace_back(CpuMesh{
+          std::move(vertices),
+          std::move(indices),
+          meshHeader.materialIdx,
+          meshHeader.transform,
+          meshHeader.boundingBox,
+        });
+      }
+
+      contents.materials = reader.ReadArray<MaterialRecord>(header.materialCount);
+
+      for (uint64_t i = 0; i < header.imageCount && !reader.Failed(); i++)
+      {
+        CachedImage image{.header = reader.Read<CachedImageHeader>()};
+        auto name = reader.ReadBytes(image.header.nameLength);
+        image.name.assign(reinterpret_cast<const char*>(name.data()), name.size());
+
+        for (uint32_t level = 0; level < image.header.levelCount && !reader.Failed(); level++)
+        {
+          const auto levelSize = reader.Read<uint64_t>();
+          reader.Align();
+          image.levels.push_back(reader.ReadBytes(levelSize));
+        }
+
+        contents.images.emplace_back(std::move(image));
+      }
+
+      if (reader.Failed())
+      {
+        std::cout << "Ignoring malformed scene cache: " << cachePath << '\n';
+        return std::nullopt;
+      }
+
+      contents.fileData = std::move(fileData);
+      return contents;
+    }
+
+    std::vector<Fwog::Texture> UploadCachedImages(std::span<const CachedImage> cachedImages)
+    {
+      auto loadedImages = std::vector<Fwog::Texture>();
+      loadedImages.reserve(cachedImages.size());
+
+      for (const auto& image : cachedImages)
+      {
+        const auto& header = image.header;
+        Fwog::Extent2D dims = {header.width, header.height};
+        auto texture = Fwog::CreateTexture2DMip(dims, header.format, header.levelCount, image.name);
+
+        for (uint32_t level = 0; level < header.levelCount; level++)
+        {
+          uint32_t width = std::max(dims.width >> level, 1u);
+          uint32_t height = std::max(dims.height >> level, 1u);
+
+          if (header.isCompressed)
+          {
+            texture.UpdateCompressedImage({
+              .level = level,
+              .extent = {width, height, 1},
+              .data = image.levels[level].data(),
+            });
+          }
+          else
+          {
+            texture.UpdateImage({
+              .level = level,
+              .extent = {width, height, 1},
+              .format = Fwog::UploadFormat::RGBA,
+              .type = Fwog::UploadType::UBYTE,
+              .pixels = image.levels[level].data(),
+            });
+          }
+        }
+
+        loadedImages.emplace_back(std::move(texture));
+      }
+
+      return loadedImages;
+    }
+
+    // Writes a cache for a freshly loaded scene. Uncompressed images are read back from their textures so the cache
+    // holds the generated mipmaps
+    void WriteSceneCache(const std::filesystem::path& cachePath,
+                         uint64_t sourceHash,
+                         std::span<const CpuMesh> meshes,
+                         std::span<const MaterialRecord> materials,
+                         std::span<const RawImageData> rawImages,
+                         std::span<const Fwog::Texture> images)
+    {
+      // Read back every mip level of uncompressed images in one batch
+      auto readbackOffsets = std::vector<uint64_t>(images.size());
+      uint64_t readbackSize = 0;
+      for (size_t i = 0; i < images.size(); i++)
+      {
+        if (rawImages[i].isKtx)
+        {
+          continue;
+        }
+
+        readbackOffsets[i] = readbackSize;
+        const auto& createInfo = images[i].GetCreateInfo();
+        for (uint32_t level = 0; level < createInfo.mipLevels; level++)
+        {
+          readbackSize += uint64_t(std::max(createInfo.extent.width >> level, 1u)) *
+                          std::max(createInfo.extent.height >> level, 1u) * 4;
+        }
+      }
+
+      std::optional<Fwog::Buffer> readbackBuffer;
+      if (readbackSize > 0)
+      {
+        readbackBuffer.emplace(readbackSize, Fwog::BufferStorageFlag::MAP_MEMORY, "Scene Cache Readback");
+
+        for (size_t i = 0; i < images.size(); i++)
+        {
+          if (rawImages[i].isKtx)
+          {
+            continue;
+          }
+
+          const auto& createInfo = images[i].GetCreateInfo();
+          uint64_t offset = readbackOffsets[i];
+          for (uint32_t level = 0; level < createInfo.mipLevels; level++)
+          {
+            uint32_t width = std::max(createInfo.extent.width >> level, 1u);
+            uint32_t height = std::max(createInfo.extent.height >> level, 1u);
+            Fwog::CopyTextureToBuffer({
+              .sourceTexture = images[i],
+              .targetBuffer = *readbackBuffer,
+              .level = level,
+              .targetOffset = offset,
+              .extent = {width, height, 1},
+              .format = Fwog::UploadFormat::RGBA,
+              .type = Fwog::UploadType::UBYTE,
+            });
+            offset += uint64_t(width) * height * 4;
+          }
+        }
+
+        auto fence = Fwog::Fence();
+        fence.Signal();
+        fence.Wait();
+      }
+
+      // Write to a temporary file first so an interrupted write can't leave a truncated cache behind
+      auto tempPath = cachePath;
+      tempPath += ".tmp";
+
+      {
+        auto writer = CacheWriter(tempPath);
+
+        writer.Write(SceneCacheHeader{
+          .magic = sceneCacheMagic,
+          .version = sceneCacheVersion,
+          .sourceHash = sourceHash,
+          .meshCount = meshes.size(),
+          .materialCount = materials.size(),
+          .imageCount = images.size(),
+        });
+
+        for (const auto& mesh : meshes)
+        {
+          writer.Write(CachedMeshHeader{
+            .vertexCount = mesh.vertices.size(),
+            .indexCount = mesh.indices.size(),
+            .materialIdx = mesh.materialIdx,
+            .transform = mesh.transform,
+            .boundingBox = mesh.boundingBox,
+          });
+          writer.WriteArray(std::span(mesh.vertices));
+          writer.WriteArray(std::span(mesh.indices));
+        }
+
+        writer.WriteArray(materials);
+
+        for (size_t i = 0; i < images.size(); i++)
+        {
+          const auto& rawImage = rawImages[i];
+          const auto& createInfo = images[i].GetCreateInfo();
+
+          writer.Write(CachedImageHeader{
+            .format = createInfo.format,
+            .isCompressed = rawImage.isKtx,
+            .width = createInfo.extent.width,
+            .height = createInfo.extent.height,
+            .levelCount = createInfo.mipLevels,
+            .nameLength = static_cast<uint32_t>(rawImage.name.size()),
+          });
+          writer.WriteBytes(rawImage.name.data(), rawImage.name.size());
+
+          uint64_t readbackOffset = readbackOffsets[i];
+          for (uint32_t level = 0; level < createInfo.mipLevels; level++)
+          {
+            const std::byte* levelData{};
+            uint64_t levelSize{};
+            if (rawImage.isKtx)
+            {
+              size_t offset{};
+              ktxTexture_GetImageOffset(ktxTexture(rawImage.ktx.get()), level, 0, 0, &offset);
+              levelData = reinterpret_cast<const std::byte*>(rawImage.ktx->pData + offset);
+              levelSize = ktxTexture_GetImageSize(ktxTexture(rawImage.ktx.get()), level);
+            }
+            else
+            {
+              levelData = static_cast<const std::byte*>(readbackBuffer->GetMappedPointer()) + readbackOffset;
+              levelSize = uint64_t(std::max(createInfo.extent.width >> level, 1u)) *
+                          std::max(createInfo.extent.height >> level, 1u) * 4;
+              readbackOffset += levelSize;
+            }
+
+            writer.Write(levelSize);
+            writer.Align();
+            writer.WriteBytes(levelData, levelSize);
+          }
+        }
+
+        if (!writer.Good())
+        {
+          std::cout << "Failed to write scene cache: " << cachePath << '\n';
+          return;
+        }
+      }
+
+      std::error_code ec;
+      std::filesystem::rename(tempPath, cachePath, ec);
+      if (ec)
+      {
+        std::cout << "Failed to write scene cache: " << cachePath << '\n';
+      }
+    }
+  } // namespace
+
+  struct ParsedModel
+  {
+    std::vector<CpuMesh> meshes;
+    std::vector<MaterialRecord> materials;
+    std::vector<Fwog::Texture> images;
+    std::vector<RawImageData> rawImages;
+  };
+
+  // Meshes are loaded with an identity root transform and materials are indexed from zero, so the result can be cached
+  std::optional<ParsedModel> LoadModelFromGltf(const std::filesystem::path& path, bool binary, LoadTimings& timings)
   {
+    Timer timer;
+
     using fastgltf::Extensions;
     auto parser = fastgltf::Parser(Extensions::KHR_texture_basisu | Extensions::KHR_mesh_quantization |
                                    Extensions::EXT_meshopt_compression | Extensions::KHR_lights_punctual);
@@ -539,8 +1077,6 @@ namespace Utility
     auto data = fastgltf::GltfDataBuffer();
     data.loadFromFile(path);
 
-    Timer timer;
-
     std::unique_ptr<fastgltf::glTF> gltf{};
     constexpr auto options = fastgltf::Options::LoadExternalBuffers | fastgltf::Options::LoadExternalImages |
                              fastgltf::Options::LoadGLBBuffers;
@@ -571,23 +1107,37 @@ namespace Utility
     // Let's not deal with glTFs containing multiple scenes right now
     FWOG_ASSERT(asset.scenes.size() == 1);
 
-    // Load images and boofers
-    auto images = LoadImages(asset);
+    timings.parse = timer.Elapsed_us() / 1000;
+
+    // Decode and transcode images on worker threads before touching the context
+    timer.Reset();
+    auto rawImages = DecodeImages(asset);
+    timings.decodeImages = timer.Elapsed_us() / 1000;
 
-    auto ms = timer.Elapsed_us() / 1000;
-    std::cout << "Loading took " << ms << " ms\n";
+    timer.Reset();
+    TranscodeImages(rawImages);
+    timings.transcodeImages = timer.Elapsed_us() / 1000;
 
-    LoadModelResult scene;
+    timer.Reset();
 
-    auto materials = LoadMaterials(asset, images);
-    std::ranges::move(materials, std::back_inserter(scene.materials));
+    // Gather primitive instances. Walking the hierarchy is cheap, so it's done serially
+    struct PrimitiveInstance
+    {
+      size_t geometryIndex;
+      uint32_t materialIdx;
+      glm::mat4 transform;
+    };
+
+    std::vector<const fastgltf::Primitive*> uniquePrimitives;
+    std::unordered_map<const fastgltf::Primitive*, size_t> primitiveToGeometry;
+    std::vector<PrimitiveInstance> instances;
 
     // <node*, global transform>
     std::stack<std::pair<const fastgltf::Node*, glm::mat4>> nodeStack;
 
     for (auto nodeIndex : asset.scenes[0].nodeIndices)
     {
-      nodeStack.emplace(&asset.nodes[nodeIndex], rootTransform);
+      nodeStack.emplace(&asset.nodes[nodeIndex], glm::mat4{1});
     }
 
     while (!nodeStack.empty())
@@ -596,8 +1146,6 @@ namespace Utility
       const auto& [node, parentGlobalTransform] = top;
       nodeStack.pop();
 
-      // std::cout << "Node: " << node->name << '\n';
-
       glm::mat4 localTransform = NodeToMat4(*node);
       glm::mat4 globalTransform = parentGlobalTransform * localTransform;
 
@@ -608,36 +1156,167 @@ namespace Utility
 
       if (node->meshIndex.has_value())
       {
-        // TODO: get a reference to the mesh instead of loading it from scratch
         for (const fastgltf::Mesh& mesh = asset.meshes[node->meshIndex.value()]; const auto& primitive : mesh.primitives)
         {
-          auto vertices = ConvertVertexBufferFormat(asset, primitive);
-          auto indices = ConvertIndexBufferFormat(asset, primitive);
+          // Meshes referenced by several nodes are only converted once
+          auto [it, inserted] = primitiveToGeometry.try_emplace(&primitive, uniquePrimitives.size());
+          if (inserted)
+          {
+            uniquePrimitives.push_back(&primitive);
+          }
 
-          scene.meshes.emplace_back(CpuMesh{
-            std::move(vertices),
-            std::move(indices),
-            baseMaterialIndex + std::max(uint32_t(primitive.materialIndex.value()), uint32_t(0)),
+          instances.emplace_back(PrimitiveInstance{
+            it->second,
+            std::max(uint32_t(primitive.materialIndex.value()), uint32_t(0)),
             globalTransform,
           });
         }
       }
     }
 
-    std::cout << "Loaded glTF: " << path << '\n';
+    // Convert each unique primitive's vertices and indices on worker threads
+    struct CpuGeometry
+    {
+      std::vector<Vertex> vertices;
+      std::vector<index_t> indices;
+      Box3D boundingBox;
+    };
+
+    auto geometry = std::vector<CpuGeometry>(uniquePrimitives.size());
+    std::transform(std::execution::par,
+                   uniquePrimitives.begin(),
+                   uniquePrimitives.end(),
+                   geometry.begin(),
+                   [&](const fastgltf::Primitive* primitive)
+                   {
+                     auto vertices = ConvertVertexBufferFormat(asset, *primitive);
+                     auto indices = ConvertIndexBufferFormat(asset, *primitive);
+                     auto boundingBox = GetBoundingBox(vertices);
+                     return CpuGeometry{std::move(vertices), std::move(indices), boundingBox};
+                   });
+
+    // Instances take ownership of their geometry on its last use and copy it otherwise
+    auto remainingUses = std::vector<uint32_t>(geometry.size());
+    for (const auto& instance : instances)
+    {
+      remainingUses[instance.geometryIndex]++;
+    }
+
+    ParsedModel model;
+    model.meshes.reserve(instances.size());
+    for (const auto& instance : instances)
+    {
+      auto& source = geometry[instance.geometryIndex];
+      const bool isLastUse = --remainingUses[instance.geometryIndex] == 0;
+
+      model.meshes.emplace_back(CpuMesh{
+        isLastUse ? std::move(source.vertices) : source.vertices,
+        isLastUse ? std::move(source.indices) : source.indices,
+        instance.materialIdx,
+        instance.transform,
+        source.boundingBox,
+      });
+    }
+
+    timings.convertGeometry = timer.Elapsed_us() / 1000;
+
+    // Everything that can be done off the context's thread is done, so create the textures
+    timer.Reset();
+    model.images = UploadImages(rawImages);
+    timings.uploadImages = timer.Elapsed_us() / 1000;
+
+    model.materials = LoadMaterials(asset);
+    model.rawImages = std::move(rawImages);
+
+    return model;
+  }
+
+  std::optional<LoadModelResult> LoadModelFromFileBase(std::filesystem::path path,
+                                                       glm::mat4 rootTransform,
+                                                       bool binary,
+                                                       uint32_t baseMaterialIndex,
+                                                       bool useCache,
+                                                       LoadTimings& timings)
+  {
+    std::vector<CpuMesh> meshes;
+    std::vector<MaterialRecord> materialRecords;
+    std::vector<Fwog::Texture> images;
+
+    auto cachePath = path;
+    cachePath += ".fwogcache";
+
+    uint64_t sourceHash{};
+    if (useCache)
+    {
+      Timer timer;
+      sourceHash = HashFile(path);
+      auto cache = ReadSceneCache(cachePath, sourceHash);
+      timings.parse = timer.Elapsed_us() / 1000;
+
+      if (cache)
+      {
+        timer.Reset();
+        images = UploadCachedImages(cache->images);
+        timings.uploadImages = timer.Elapsed_us() / 1000;
+
+        meshes = std::move(cache->meshes);
+        materialRecords = std::move(cache->materials);
+        timings.cacheHit = true;
+      }
+    }
+
+    if (!timings.cacheHit)
+    {
+      auto model = LoadModelFromGltf(path, binary, timings);
+      if (!model)
+      {
+        return std::nullopt;
+      }
+
+      if (useCache)
+      {
+        Timer timer;
+        WriteSceneCache(cachePath, sourceHash, model->meshes, model->materials, model->rawImages, model->images);
+        timings.writeCache = timer.Elapsed_us() / 1000;
+      }
+
+      meshes = std::move(model->meshes);
+      materialRecords = std::move(model->materials);
+      images = std::move(model->images);
+    }
+
+    for (auto& mesh : meshes)
+    {
+      mesh.transform = rootTransform * mesh.transform;
+      mesh.materialIdx += baseMaterialIndex;
+    }
 
-    return scene;
+    return LoadModelResult{
+      .meshes = std::move(meshes),
+      .materials = CreateMaterials(materialRecords, images),
+    };
   }
 
-  bool LoadModelFromFile(Scene& scene, std::string_view fileName, glm::mat4 rootTransform, bool binary)
+  bool LoadModelFromFile(Scene& scene,
+                         std::string_view fileName,
+                         glm::mat4 rootTransform,
+                         bool binary,
+                         bool useCache,
+                         LoadTimings* timings)
   {
+    Timer totalTimer;
+    LoadTimings localTimings;
+    auto& stageTimings = timings ? *timings : localTimings;
+    stageTimings = {};
+
     const auto baseMaterialIndex = static_cast<uint32_t>(scene.materials.size());
 
-    auto loadedScene = LoadModelFromFileBase(fileName, rootTransform, binary, baseMaterialIndex);
+    auto loadedScene = LoadModelFromFileBase(fileName, rootTransform, binary, baseMaterialIndex, useCache, stageTimings);
 
     if (!loadedScene)
       return false;
 
+    Timer timer;
     scene.meshes.reserve(scene.meshes.size() + loadedScene->meshes.size());
     for (auto& mesh : loadedScene->meshes)
     {
@@ -648,41 +1327,75 @@ namespace Utility
         .transform = mesh.transform,
       });
     }
+    stageTimings.uploadGeometry = timer.Elapsed_us() / 1000;
 
     std::ranges::move(loadedScene->materials, std::back_inserter(scene.materials));
 
+    stageTimings.total = totalTimer.Elapsed_us() / 1000;
+    PrintTimings(fileName, stageTimings);
+
     return true;
   }
 
-  bool LoadModelFromFileBindless(SceneBindless& scene, std::string_view fileName, glm::mat4 rootTransform, bool binary)
+  bool LoadModelFromFileBindless(SceneBindless& scene,
+                                 std::string_view fileName,
+                                 glm::mat4 rootTransform,
+                                 bool binary,
+                                 bool useCache,
+                                 LoadTimings* timings)
   {
+    Timer totalTimer;
+    LoadTimings localTimings;
+    auto& stageTimings = timings ? *timings : localTimings;
+    stageTimings = {};
+
     FWOG_ASSERT(scene.textures.size() == scene.samplers.size());
     const auto baseMaterialIndex = static_cast<uint32_t>(scene.materials.size());
 
-    auto loadedScene = LoadModelFromFileBase(fileName, rootTransform, binary, baseMaterialIndex);
+    auto loadedScene = LoadModelFromFileBase(fileName, rootTransform, binary, baseMaterialIndex, useCache, stageTimings);
 
     if (!loadedScene)
       return false;
 
+    // Concatenating geometry is part of conversion, since the caller uploads the combined buffers
+    Timer timer;
+
+    // Compute where each mesh goes in the combined buffers, then copy them in parallel
+    const auto firstMesh = scene.meshes.size();
+    auto vertexCount = scene.vertices.size();
+    auto indexCount = scene.indices.size();
+
     scene.meshes.reserve(scene.meshes.size() + loadedScene->meshes.size());
-    for (auto& mesh : loadedScene->meshes)
+    for (const auto& mesh : loadedScene->meshes)
     {
       scene.meshes.emplace_back(MeshBindless{
-        .startVertex = static_cast<int32_t>(scene.vertices.size()),
-        .startIndex = static_cast<uint32_t>(scene.indices.size()),
+        .startVertex = static_cast<int32_t>(vertexCount),
+        .startIndex = static_cast<uint32_t>(indexCount),
         .indexCount = static_cast<uint32_t>(mesh.indices.size()),
         .materialIdx = mesh.materialIdx,
         .transform = mesh.transform,
-        .boundingBox = GetBoundingBox(mesh.vertices),
+        .boundingBox = mesh.boundingBox,
       });
 
-      std::vector<Vertex> tempVertices = std::move(mesh.vertices);
-      scene.vertices.insert(scene.vertices.end(), tempVertices.begin(), tempVertices.end());
-
-      std::vector<index_t> tempIndices = std::move(mesh.indices);
-      scene.indices.insert(scene.indices.end(), tempIndices.begin(), tempIndices.end());
+      vertexCount += mesh.vertices.size();
+      indexCount += mesh.indices.size();
     }
 
+    scene.vertices.resize(vertexCount);
+    scene.indices.resize(indexCount);
+
+    std::for_each(std::execution::par,
+                  loadedScene->meshes.begin(),
+                  loadedScene->meshes.end(),
+                  [&](const CpuMesh& mesh)
+                  {
+                    const auto& placement = scene.meshes[firstMesh + (&mesh - loadedScene->meshes.data())];
+                    std::ranges::copy(mesh.vertices, scene.vertices.begin() + placement.startVertex);
+                    std::ranges::copy(mesh.indices, scene.indices.begin() + placement.startIndex);
+                  });
+
+    stageTimings.convertGeometry += timer.Elapsed_us() / 1000;
+
     scene.materials.reserve(scene.materials.size() + loadedScene->materials.size());
     for (auto& material : loadedScene->materials)
     {
@@ -700,6 +1413,9 @@ namespace Utility
       scene.materials.emplace_back(bindlessMaterial);
     }
 
+    stageTimings.total = totalTimer.Elapsed_us() / 1000;
+    PrintTimings(fileName, stageTimings);
+
     return true;
   }
 } // namespace Utility
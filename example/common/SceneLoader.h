@@ -99,13 +99,38 @@ namespace Utility
     std::vector<Fwog::SamplerState> samplers;
   };
 
+  // Time spent in each stage of loading a glTF, in milliseconds
+  struct LoadTimings
+  {
+    double parse{};
+    double decodeImages{};
+    double transcodeImages{};
+    double convertGeometry{};
+    double uploadImages{};
+    double uploadGeometry{};
+    double writeCache{};
+    double total{};
+
+    // True if the scene was loaded from its cache instead of being parsed. The parse time is the time spent reading
+    // the cache
+    bool cacheHit{};
+  };
+
+  // useCache: read the scene from "<fileName>.fwogcache" if it exists and was made from the same source file by the
+  // same loader version. Otherwise, load the scene normally and write the cache. Only fileName itself is hashed, so
+  // delete the cache after editing external buffers or images that a .gltf refers to
+
   bool LoadModelFromFile(Scene& scene, 
     std::string_view fileName, 
     glm::mat4 rootTransform = glm::mat4{ 1 }, 
-    bool binary = false);
+    bool binary = false,
+    bool useCache = false,
+    LoadTimings* timings = nullptr);
 
   bool LoadModelFromFileBindless(SceneBindless& scene, 
     std::string_view fileName, 
     glm::mat4 rootTransform = glm::mat4{ 1 }, 
-    bool binary = false);
+    bool binary = false,
+    bool useCache = false,
+    LoadTimings* timings = nullptr);
 }
\ No newline at end of file
@@ -0,0 +1,176 @@
+#version 460 core
+
+struct ObjectUniforms
+{
+  mat4 model;
+  uint materialIdx;
+};
+
+struct BoundingBox
+{
+  vec3 offset;
+  vec3 halfExtent;
+};
+
+struct DrawIndexedIndirectCommand
+{
+  uint indexCount;
+  uint instanceCount;
+  uint firstIndex;
+  int vertexOffset;
+  uint firstInstance;
+};
+
+layout(binding = 0, std140) uniform CullUniforms
+{
+  mat4 viewProj;
+  uint objectCount;
+  uint phase; // 0 = early, 1 = late
+  uint hizLevels;
+  uint enableOcclusion;
+  vec2 hizSize;
+}cullUniforms;
+
+layout(binding = 0, std430) readonly restrict buffer ObjectUniformsBuffer
+{
+  ObjectUniforms objects[];
+};
+
+layout(binding = 1, std430) readonly restrict buffer BoundingBoxesBuffer
+{
+  BoundingBox boundingBoxes[];
+};
+
+// The draw parameters of each object, before culling
+layout(binding = 2, std430) readonly restrict buffer DrawTemplatesBuffer
+{
+  DrawIndexedIndirectCommand drawTemplates[];
+};
+
+// The early list occupies [0, objectCount) and the late list occupies [objectCount, 2 * objectCount)
+layout(binding = 3, std430) writeonly restrict buffer DrawCommandsBuffer
+{
+  DrawIndexedIndirectCommand drawCommands[];
+};
+
+layout(binding = 4, std430) restrict buffer DrawCountsBuffer
+{
+  uint earlyDrawCount;
+  uint lateDrawCount;
+  uint visibleCount;
+};
+
+// Whether each object passed the late test in the previous frame
+layout(binding = 5, std430) restrict buffer VisibilityBuffer
+{
+  uint visibility[];
+};
+
+layout(binding = 0) uniform sampler2D s_hiz;
+
+bool IsVisible(uint objectIndex, bool testOcclusion)
+{
+  mat4 modelViewProj = cullUniforms.viewProj * objects[objectIndex].model;
+  BoundingBox box = boundingBoxes[objectIndex];
+
+  // A box is outside the frustum if all of its corners are outside the same clip plane
+  vec3 cornersBelow = vec3(0);
+  vec3 cornersAbove = vec3(0);
+  bool crossesNearPlane = false;
+  vec3 ndcMin = vec3(1e30);
+  vec3 ndcMax = vec3(-1e30);
+
+  for (uint i = 0; i < 8; i++)
+  {
+    vec3 corner = vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+    vec4 clip = modelViewProj * vec4(box.offset + box.halfExtent * corner, 1.0);
+
+    cornersBelow += vec3(lessThan(clip.xyz, vec3(-clip.w)));
+    cornersAbove += vec3(greaterThan(clip.xyz, vec3(clip.w)));
+
+    if (clip.w <= 0.0)
+    {
+      crossesNearPlane = true;
+    }
+    else
+    {
+      vec3 ndc = clip.xyz / clip.w;
+      ndcMin = min(ndcMin, ndc);
+      ndcMax = max(ndcMax, ndc);
+    }
+  }
+
+  if (any(equal(cornersBelow, vec3(8))) || any(equal(cornersAbove, vec3(8))))
+  {
+    return false;
+  }
+
+  // Boxes that intersect the near plane have no meaningful screen rect and are treated as visible
+  if (!testOcclusion || cullUniforms.enableOcclusion == 0 || crossesNearPlane)
+  {
+    return true;
+  }
+
+  vec2 uvMin = clamp(ndcMin.xy * 0.5 + 0.5, 0.0, 1.0);
+  vec2 uvMax = clamp(ndcMax.xy * 0.5 + 0.5, 0.0, 1.0);
+
+  // Choose the level where the rect is at most one texel wide, so it overlaps at most 2x2 texels
+  vec2 sizeTexels = (uvMax - uvMin) * cullUniforms.hizSize;
+  int level = int(ceil(log2(max(max(sizeTexels.x, sizeTexels.y), 1.0))));
+  level = min(level, int(cullUniforms.hizLevels) - 1);
+
+  ivec2 levelSize = textureSize(s_hiz, level);
+  ivec2 texelMin = clamp(ivec2(uvMin * levelSize), ivec2(0), levelSize - 1);
+  ivec2 texelMax = clamp(ivec2(uvMax * levelSize), ivec2(0), levelSize - 1);
+
+  float occluderDepth = max(
+    max(texelFetch(s_hiz, texelMin, level).r, texelFetch(s_hiz, ivec2(texelMax.x, texelMin.y), level).r),
+    max(texelFetch(s_hiz, ivec2(texelMin.x, texelMax.y), level).r, texelFetch(s_hiz, texelMax, level).r));
+
+  float nearestDepth = ndcMin.z * 0.5 + 0.5;
+  return nearestDepth <= occluderDepth;
+}
+
+void EmitDraw(uint objectIndex, uint slot)
+{
+  DrawIndexedIndirectCommand command = drawTemplates[objectIndex];
+  command.instanceCount = 1;
+  command.firstInstance = objectIndex;
+  drawCommands[slot] = command;
+}
+
+layout(local_size_x = 64) in;
+void main()
+{
+  uint objectIndex = gl_GlobalInvocationID.x;
+  if (objectIndex >= cullUniforms.objectCount)
+  {
+    return;
+  }
+
+  if (cullUniforms.phase == 0)
+  {
+    // Draw what was visible last frame, if it's still in the frustum. The depth buffer this produces is used to test
+    // occlusion in the late phase
+    if (visibility[objectIndex] != 0 && IsVisible(objectIndex, false))
+    {
+      EmitDraw(objectIndex, atomicAdd(earlyDrawCount, 1));
+    }
+  }
+  else
+  {
+    bool visible = IsVisible(objectIndex, true);
+    if (visible)
+    {
+      atomicAdd(visibleCount, 1);
+
+      // Objects that were drawn in the early phase are already in the depth buffer
+      if (visibility[objectIndex] == 0)
+      {
+        EmitDraw(objectIndex, cullUniforms.objectCount + atomicAdd(lateDrawCount, 1));
+      }
+    }
+
+    visibility[objectIndex] = visible ? 1 : 0;
+  }
+}
@@ -0,0 +1,34 @@
+#version 460 core
+
+// The depth buffer when building level 0, otherwise the previous level of the pyramid
+layout(binding = 0) uniform sampler2D s_source;
+
+layout(binding = 0, r32f) uniform restrict writeonly image2D i_target;
+
+layout(local_size_x = 8, local_size_y = 8) in;
+void main()
+{
+  ivec2 gid = ivec2(gl_GlobalInvocationID.xy);
+  ivec2 targetSize = imageSize(i_target);
+  if (any(greaterThanEqual(gid, targetSize)))
+  {
+    return;
+  }
+
+  // Each target texel takes the farthest depth of every source texel it overlaps. Level 0 can be up to twice as small
+  // as the depth buffer in each dimension, so a texel may overlap up to 3x3 source texels
+  ivec2 sourceSize = textureSize(s_source, 0);
+  ivec2 begin = (gid * sourceSize) / targetSize;
+  ivec2 end = min(((gid + 1) * sourceSize + targetSize - 1) / targetSize, sourceSize);
+
+  float maxDepth = 0.0;
+  for (int y = begin.y; y < end.y; y++)
+  {
+    for (int x = begin.x; x < end.x; x++)
+    {
+      maxDepth = max(maxDepth, texelFetch(s_source, ivec2(x, y), 0).r);
+    }
+  }
+
+  imageStore(i_target, gid, vec4(maxDepth));
+}
@@ -26,7 +26,7 @@ vec3 oct_to_float32x3(vec2 e)
 
 void main()
 {
-  uint i = objectIndices.array[gl_DrawID];
+  uint i = gl_BaseInstance;
   v_materialIdx = objects[i].materialIdx;
   v_position = (objects[i].model * vec4(a_pos, 1.0)).xyz;
   v_normal = normalize(inverse(transpose(mat3(objects[i].model))) * oct_to_float32x3(a_normal));
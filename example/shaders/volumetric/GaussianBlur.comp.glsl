@@ -4,7 +4,8 @@
 layout(binding = 0) uniform sampler2D s_in;
 layout(binding = 0) uniform writeonly restrict image2D i_out;
 
-layout(binding = 0, std140) uniform UNIFORMS
+// Written with Cmd::PushConstants. The binding is Fwog::PUSH_CONSTANT_BINDING
+layout(binding = 63, std140) uniform PushConstants
 {
   ivec2 direction;
   ivec2 targetDim;
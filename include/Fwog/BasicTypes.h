@@ -315,6 +315,12 @@ namespace Fwog
   /// If an offset is provided with this constant, then the range [offset, buffer.Size()) will be bound.
   constexpr inline uint64_t WHOLE_BUFFER = static_cast<uint64_t>(-1);
 
+  /// @brief The uniform buffer binding reserved for Cmd::PushConstants
+  ///
+  /// Shaders declare push constants as a std140 uniform block with this binding. Other resources must not be bound to
+  /// it.
+  constexpr inline uint32_t PUSH_CONSTANT_BINDING = 63;
+
   enum class Filter : uint32_t
   {
     NONE,
@@ -485,6 +491,14 @@ namespace Fwog
   };
   FWOG_DECLARE_FLAG_TYPE(MemoryBarrierBits, MemoryBarrierBit, uint32_t)
 
+  /// @brief Specifies how shaders access a storage buffer or image, like the readonly and writeonly qualifiers in GLSL
+  enum class ShaderAccess : uint32_t
+  {
+    READ_ONLY,
+    WRITE_ONLY,
+    READ_WRITE,
+  };
+
   enum class StencilOp : uint32_t
   {
     KEEP                = 0,
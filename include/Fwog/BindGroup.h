@@ -0,0 +1,107 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/BasicTypes.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Texture.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Fwog
+{
+  class Buffer;
+
+  /// @brief A range within a buffer that is bound to a uniform or storage buffer binding
+  struct BindGroupBuffer
+  {
+    uint32_t index;
+    ReferenceWrapper<const Buffer> buffer;
+    uint64_t offset = 0;
+    uint64_t size = WHOLE_BUFFER;
+
+    /// @brief How shaders access the buffer. Ignored for uniform buffers
+    /// @see Cmd::BindStorageBuffer
+    ShaderAccess access = ShaderAccess::READ_WRITE;
+  };
+
+  /// @brief A texture and a sampler that are bound to a texture unit
+  struct BindGroupSampledImage
+  {
+    uint32_t index;
+    ReferenceWrapper<const Texture> texture;
+    Sampler sampler;
+  };
+
+  /// @brief A texture level that is bound to an image unit
+  struct BindGroupImage
+  {
+    uint32_t index;
+    ReferenceWrapper<const Texture> texture;
+    uint32_t level = 0;
+
+    /// @see Cmd::BindImage
+    ShaderAccess access = ShaderAccess::READ_WRITE;
+  };
+
+  /// @brief Parameters for the constructor of BindGroup. Indices must be unique within each list
+  struct BindGroupCreateInfo
+  {
+    std::span<const BindGroupBuffer> uniformBuffers = {};
+    std::span<const BindGroupBuffer> storageBuffers = {};
+    std::span<const BindGroupSampledImage> sampledImages = {};
+    std::span<const BindGroupImage> images = {};
+  };
+
+  /// @brief An immutable set of resource bindings that is applied with a single call to Cmd::BindGroup
+  ///
+  /// Applying a group is equivalent to calling Cmd::BindUniformBuffer, Cmd::BindStorageBuffer,
+  /// Cmd::BindSampledImage, and Cmd::BindImage for each of its entries, but consecutive slots are bound with one
+  /// glBindBuffersRange, glBindTextures + glBindSamplers, or glBindImageTextures call each. Slots that already hold
+  /// the same binding are skipped, so applying groups that share resources only costs the bindings that differ.
+  ///
+  /// @note Resources are referenced by their OpenGL names, not copied. Every resource in a group must outlive the
+  /// group's last use
+  class BindGroup
+  {
+  public:
+    explicit BindGroup(const BindGroupCreateInfo& createInfo);
+
+  private:
+    friend void Cmd::BindGroup(const Fwog::BindGroup& group);
+
+    // Bindings of one kind, sorted by index. Each array is indexed in parallel so that consecutive entries can be
+    // passed directly to a multi-bind call
+    struct BufferBindings
+    {
+      std::vector<uint32_t> indices;
+      std::vector<uint32_t> buffers;
+      std::vector<intptr_t> offsets;
+      std::vector<intptr_t> sizes;
+      std::vector<ShaderAccess> accesses;
+    };
+
+    struct SampledImageBindings
+    {
+      std::vector<uint32_t> indices;
+      std::vector<uint32_t> textures;
+      std::vector<uint32_t> samplers;
+    };
+
+    struct ImageBindings
+    {
+      std::vector<uint32_t> indices;
+      std::vector<uint32_t> textures;
+      std::vector<uint32_t> levels;
+      std::vector<uint32_t> formats;
+      std::vector<ShaderAccess> accesses;
+    };
+
+    static BufferBindings MakeBufferBindings(std::span<const BindGroupBuffer> entries);
+
+    BufferBindings uniformBuffers_;
+    BufferBindings storageBuffers_;
+    SampledImageBindings sampledImages_;
+    ImageBindings images_;
+  };
+} // namespace Fwog
@@ -0,0 +1,125 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/Texture.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Fwog
+{
+  /// @brief A storage buffer of texture-sampler pairs that shaders can index, such as from a material
+  ///
+  /// Each pair acquired from the table occupies one uint64_t slot in the buffer returned by GetBuffer. Acquiring a
+  /// pair that is already in the table returns the same slot and increments its reference count, so many materials
+  /// can share a texture cheaply. Changes to the table are uploaded incrementally by Update.
+  ///
+  /// If DeviceFeatures::bindlessTextures is true, a slot holds a resident bindless texture handle that can be
+  /// converted to a sampler2D in a shader.
+  ///
+  /// Otherwise, textures are copied into layers of 2D array textures, grouped by their format, extent, mip count, and
+  /// sampler state. A slot then holds the group index in its upper 32 bits and the layer in its lower 32 bits. Bind the
+  /// arrays with BindFallbackTextures and index a sampler2DArray array with the group. Indices into sampler arrays
+  /// must be dynamically uniform, e.g., derived from gl_DrawID.
+  ///
+  /// Bindless handle residency is reference counted by the context, so several tables, and Texture::GetBindlessHandle,
+  /// can use the same texture and sampler. A handle stays resident until every one of them has released it.
+  ///
+  /// @note A texture must be released from the table before it is destroyed.
+  class BindlessTable
+  {
+  public:
+    /// @param initialCapacity The number of slots to allocate up front. The table grows as needed
+    explicit BindlessTable(uint32_t initialCapacity = 256, std::string_view name = "");
+    ~BindlessTable();
+
+    BindlessTable(const BindlessTable&) = delete;
+    BindlessTable& operator=(const BindlessTable&) = delete;
+    BindlessTable(BindlessTable&&) = delete;
+    BindlessTable& operator=(BindlessTable&&) = delete;
+
+    /// @brief Adds a reference to a texture-sampler pair
+    /// @return The index of the pair's slot in the table
+    /// @note In the fallback path, the texture's contents are copied when the pair is first acquired. The texture must
+    /// be a 2D texture
+    [[nodiscard]] uint32_t Acquire(const Texture& texture, const SamplerState& samplerState);
+
+    /// @brief Removes a reference to a slot. The slot is freed when no references remain
+    void Release(uint32_t index);
+
+    /// @brief Uploads slots that changed since the last call, reallocating the buffer if the table grew
+    /// @note Must be called before issuing commands that read the table
+    void Update();
+
+    /// @brief Binds each fallback texture array to consecutive texture units, starting at firstUnit
+    /// @note Must be called in a rendering or compute scope. Does nothing if bindless textures are supported
+    void BindFallbackTextures(uint32_t firstUnit) const;
+
+    /// @return The buffer of slots. Bind it with Cmd::BindStorageBuffer
+    [[nodiscard]] const Buffer& GetBuffer() const noexcept
+    {
+      return buffer_;
+    }
+
+    /// @return Whether slots hold bindless handles rather than fallback array locations
+    [[nodiscard]] bool IsBindless() const noexcept
+    {
+      return isBindless_;
+    }
+
+    /// @return The number of slots that are in use
+    [[nodiscard]] uint32_t Size() const noexcept
+    {
+      return static_cast<uint32_t>(entries_.size() - freeIndices_.size());
+    }
+
+    /// @return The number of fallback texture arrays. Zero if bindless textures are supported
+    [[nodiscard]] uint32_t FallbackTextureCount() const noexcept
+    {
+      return static_cast<uint32_t>(fallbackGroups_.size());
+    }
+
+  private:
+    struct Entry
+    {
+      uint64_t key;
+      uint32_t refCount;
+      uint32_t fallbackGroup;
+      uint32_t fallbackLayer;
+    };
+
+    struct FallbackGroup
+    {
+      TextureCreateInfo layerInfo;
+      SamplerState samplerState;
+      Texture array;
+      std::vector<uint32_t> freeLayers;
+      uint32_t usedLayers;
+    };
+
+    void MarkDirty(uint32_t index);
+    std::pair<uint32_t, uint32_t> AllocateFallbackLayer(const Texture& texture, const SamplerState& samplerState);
+
+    std::string name_;
+    bool isBindless_;
+
+    // CPU copy of the buffer's contents
+    std::vector<uint64_t> slots_;
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> freeIndices_;
+
+    // Texture and sampler handles -> slot
+    std::unordered_map<uint64_t, uint32_t> keyToIndex_;
+
+    Buffer buffer_;
+    bool needsReallocation_ = false;
+    uint32_t dirtyBegin_ = UINT32_MAX;
+    uint32_t dirtyEnd_ = 0;
+
+    std::vector<FallbackGroup> fallbackGroups_;
+  };
+} // namespace Fwog
@@ -0,0 +1,274 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/BasicTypes.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Texture.h>
+
+#include <cstdint>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace Fwog
+{
+  class Buffer;
+  class Texture;
+  struct GraphicsPipeline;
+  struct ComputePipeline;
+
+  namespace detail
+  {
+    // Commands reference resources by address. Resources must outlive the replay of any command buffer that uses them.
+    namespace Commands
+    {
+      struct BindGraphicsPipeline
+      {
+        const GraphicsPipeline* pipeline;
+      };
+
+      struct BindComputePipeline
+      {
+        const ComputePipeline* pipeline;
+      };
+
+      struct SetViewport
+      {
+        Viewport viewport;
+      };
+
+      struct SetScissor
+      {
+        Rect2D scissor;
+      };
+
+      struct BindVertexBuffer
+      {
+        uint32_t bindingIndex;
+        const Buffer* buffer;
+        uint64_t offset;
+        uint64_t stride;
+      };
+
+      struct BindIndexBuffer
+      {
+        const Buffer* buffer;
+        IndexType indexType;
+      };
+
+      struct BindUniformBuffer
+      {
+        uint32_t index;
+        const Buffer* buffer;
+        uint64_t offset;
+        uint64_t size;
+      };
+
+      struct BindStorageBuffer
+      {
+        uint32_t index;
+        const Buffer* buffer;
+        uint64_t offset;
+        uint64_t size;
+        ShaderAccess access;
+      };
+
+      struct BindSampledImage
+      {
+        uint32_t index;
+        const Texture* texture;
+        Sampler sampler;
+      };
+
+      struct BindImage
+      {
+        uint32_t index;
+        const Texture* texture;
+        uint32_t level;
+        ShaderAccess access;
+      };
+
+      struct BindGroup
+      {
+        const Fwog::BindGroup* group;
+      };
+
+      struct Draw
+      {
+        uint32_t vertexCount;
+        uint32_t instanceCount;
+        uint32_t firstVertex;
+        uint32_t firstInstance;
+      };
+
+      struct DrawIndexed
+      {
+        uint32_t indexCount;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t vertexOffset;
+        uint32_t firstInstance;
+      };
+
+      struct DrawIndirect
+      {
+        const Buffer* commandBuffer;
+        uint64_t commandBufferOffset;
+        uint32_t drawCount;
+        uint32_t stride;
+      };
+
+      struct DrawIndirectCount
+      {
+        const Buffer* commandBuffer;
+        uint64_t commandBufferOffset;
+        const Buffer* countBuffer;
+        uint64_t countBufferOffset;
+        uint32_t maxDrawCount;
+        uint32_t stride;
+      };
+
+      struct DrawIndexedIndirect
+      {
+        const Buffer* commandBuffer;
+        uint64_t commandBufferOffset;
+        uint32_t drawCount;
+        uint32_t stride;
+      };
+
+      struct DrawIndexedIndirectCount
+      {
+        const Buffer* commandBuffer;
+        uint64_t commandBufferOffset;
+        const Buffer* countBuffer;
+        uint64_t countBufferOffset;
+        uint32_t maxDrawCount;
+        uint32_t stride;
+      };
+
+      struct Dispatch
+      {
+        Extent3D groupCount;
+      };
+
+      struct DispatchInvocations
+      {
+        Extent3D invocationCount;
+      };
+
+      struct DispatchIndirect
+      {
+        const Buffer* commandBuffer;
+        uint64_t commandBufferOffset;
+      };
+    } // namespace Commands
+
+    using Command = std::variant<Commands::BindGraphicsPipeline,
+                                 Commands::BindComputePipeline,
+                                 Commands::SetViewport,
+                                 Commands::SetScissor,
+                                 Commands::BindVertexBuffer,
+                                 Commands::BindIndexBuffer,
+                                 Commands::BindUniformBuffer,
+                                 Commands::BindStorageBuffer,
+                                 Commands::BindSampledImage,
+                                 Commands::BindImage,
+                                 Commands::BindGroup,
+                                 Commands::Draw,
+                                 Commands::DrawIndexed,
+                                 Commands::DrawIndirect,
+                                 Commands::DrawIndirectCount,
+                                 Commands::DrawIndexedIndirect,
+                                 Commands::DrawIndexedIndirectCount,
+                                 Commands::Dispatch,
+                                 Commands::DispatchInvocations,
+                                 Commands::DispatchIndirect>;
+
+    static_assert(std::is_trivially_copyable_v<Command>);
+  } // namespace detail
+
+  /// @brief A list of commands that can be recorded without an OpenGL context and replayed later
+  ///
+  /// Recording makes no OpenGL calls, so command buffers may be recorded on any thread (one thread per command buffer
+  /// at a time). Replay them on the context's thread with Cmd::ExecuteCommandBuffer inside of a rendering or compute
+  /// scope. The functions here mirror those in the Cmd namespace, and the same validity rules apply at replay time.
+  ///
+  /// @note Resources are referenced, not copied. Every resource referenced by a command buffer must outlive its replay.
+  /// @note Binding resources by name is not supported, as it depends on the pipeline that is bound at replay time.
+  class CommandBuffer
+  {
+  public:
+    CommandBuffer() = default;
+
+    void BindGraphicsPipeline(const GraphicsPipeline& pipeline);
+    void BindComputePipeline(const ComputePipeline& pipeline);
+    void SetViewport(const Viewport& viewport);
+    void SetScissor(const Rect2D& scissor);
+    void BindVertexBuffer(uint32_t bindingIndex, const Buffer& buffer, uint64_t offset, uint64_t stride);
+    void BindIndexBuffer(const Buffer& buffer, IndexType indexType);
+    void BindUniformBuffer(uint32_t index, const Buffer& buffer, uint64_t offset = 0, uint64_t size = WHOLE_BUFFER);
+    void BindStorageBuffer(uint32_t index,
+                           const Buffer& buffer,
+                           uint64_t offset = 0,
+                           uint64_t size = WHOLE_BUFFER,
+                           ShaderAccess access = ShaderAccess::READ_WRITE);
+    void BindSampledImage(uint32_t index, const Texture& texture, const Sampler& sampler);
+    void BindImage(uint32_t index, const Texture& texture, uint32_t level, ShaderAccess access = ShaderAccess::READ_WRITE);
+    void BindGroup(const Fwog::BindGroup& group);
+    void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
+    void DrawIndexed(uint32_t indexCount,
+                     uint32_t instanceCount,
+                     uint32_t firstIndex,
+                     int32_t vertexOffset,
+                     uint32_t firstInstance);
+    void DrawIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset, uint32_t drawCount, uint32_t stride);
+    void DrawIndirectCount(const Buffer& commandBuffer,
+                           uint64_t commandBufferOffset,
+                           const Buffer& countBuffer,
+                           uint64_t countBufferOffset,
+                           uint32_t maxDrawCount,
+                           uint32_t stride);
+    void DrawIndexedIndirect(const Buffer& commandBuffer,
+                             uint64_t commandBufferOffset,
+                             uint32_t drawCount,
+                             uint32_t stride);
+    void DrawIndexedIndirectCount(const Buffer& commandBuffer,
+                                  uint64_t commandBufferOffset,
+                                  const Buffer& countBuffer,
+                                  uint64_t countBufferOffset,
+                                  uint32_t maxDrawCount,
+                                  uint32_t stride);
+    void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
+    void Dispatch(Extent3D groupCount);
+    void DispatchInvocations(uint32_t invocationCountX, uint32_t invocationCountY, uint32_t invocationCountZ);
+    void DispatchInvocations(Extent3D invocationCount);
+    void DispatchIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset);
+
+    /// @brief Removes all recorded commands while retaining the allocated storage
+    void Reset() noexcept
+    {
+      commands_.clear();
+    }
+
+    /// @brief Preallocates storage for a number of commands
+    void Reserve(size_t commandCount)
+    {
+      commands_.reserve(commandCount);
+    }
+
+    /// @return The number of recorded commands
+    [[nodiscard]] size_t Size() const noexcept
+    {
+      return commands_.size();
+    }
+
+    [[nodiscard]] bool Empty() const noexcept
+    {
+      return commands_.empty();
+    }
+
+  private:
+    friend void Cmd::ExecuteCommandBuffer(const CommandBuffer& commandBuffer);
+
+    std::vector<detail::Command> commands_;
+  };
+} // namespace Fwog
@@ -4,7 +4,6 @@
 #include <Fwog/Rendering.h>
 
 #include <string_view>
-#include <functional>
 
 namespace Fwog
 {
@@ -106,6 +105,7 @@ namespace Fwog
   {
     bool bindlessTextures{}; // GL_ARB_bindless_texture
     bool shaderSubgroup{}; // GL_KHR_shader_subgroup
+    bool parallelShaderCompile{}; // GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile
   };
 
   struct DeviceProperties
@@ -120,6 +120,24 @@ namespace Fwog
     DeviceFeatures features;
   };
 
+  /// @brief Counters for the redundant state elimination done by Cmd::BindGraphicsPipeline
+  struct PipelineStateStatistics
+  {
+    /// @brief The number of state-setting OpenGL calls that were made
+    uint64_t emittedCalls{};
+
+    /// @brief The number of state-setting OpenGL calls that were skipped because the state was already applied
+    uint64_t skippedCalls{};
+  };
+
+  /// @brief Counters for the barriers managed by hazard tracking
+  /// @see ContextInitializeInfo::enableHazardTracking
+  struct HazardTrackingStatistics
+  {
+    /// @brief The number of memory barriers that were issued, both automatically and by MemoryBarrier
+    uint64_t issuedBarriers{};
+  };
+
   struct ContextInitializeInfo
   {
     using ApiProc = void (*)();
@@ -135,11 +153,68 @@ namespace Fwog
     /// This callback can be useful for analyzing how Fwog implicitly creates objects.
     void (*verboseMessageCallback)(std::string_view message) = nullptr;
 
+    /// @brief If true, consecutive Cmd::DrawIndexed calls are combined into a single glMultiDrawElementsIndirect.
+    ///
+    /// Draws are combined while the pipeline, index buffer, and resource bindings are unchanged. Rebinding a vertex
+    /// buffer at a different offset doesn't interrupt a batch if the offset is a multiple of the stride, as the offset
+    /// is folded into the draw's vertex offset. Batching changes gl_DrawID, so shaders should identify draws with
+    /// gl_BaseInstance (the draw's firstInstance) instead.
+    ///
+    /// Batching only pays off when meshes share vertex and index buffers, e.g., when they are suballocated from a
+    /// GeometryArena. Binding a different index buffer per mesh issues the pending batch on every draw. Buffer and
+    /// texture updates, clears, copies, blits, and mipmap generation also issue the pending batch first, so draws
+    /// observe the data that was current when they were recorded.
+    bool enableDrawBatching = false;
+
+    /// @brief If not empty, linked programs are cached in this directory and reused by later runs.
+    ///
+    /// Entries are keyed by the sources of a pipeline's shaders and the driver's vendor, renderer, and version
+    /// strings. Entries that the driver rejects are relinked from source and overwritten. The directory is created if
+    /// it doesn't exist. Caching is disabled if the driver supports no program binary formats.
+    std::string_view programCacheDirectory = "";
+
+    /// @brief If true, memory barriers for shader writes are inserted automatically before the draws and dispatches
+    /// that depend on them.
+    ///
+    /// Images and storage buffers that are bound with write access are recorded as written by each draw or dispatch
+    /// that follows. Before a draw or dispatch, the resources that its pipeline reads through Cmd bindings, vertex and
+    /// index buffers, and indirect buffers are checked for writes that no barrier has made visible yet, and a single
+    /// barrier with just the needed bits is issued. Texture views are considered to alias the texture they view.
+    ///
+    /// Calls to MemoryBarrier are always issued, and make tracked writes visible so that no automatic barrier is issued
+    /// for them.
+    ///
+    /// @note Only writes made through Cmd::BindImage, Cmd::BindStorageBuffer, and BindGroup are tracked. Writes from
+    /// atomic counters or resources bound with plain OpenGL still need manual barriers, as do shader writes that are
+    /// read by something other than a draw or dispatch (e.g., a copy or a mapped pointer).
+    bool enableHazardTracking = false;
+
+    /// @brief If true, hazard tracking resolves hazards between draws in the same rendering scope with
+    /// glMemoryBarrierByRegion instead of glMemoryBarrier.
+    ///
+    /// A region barrier only orders fragment shader accesses to the same framebuffer region, so this must only be
+    /// enabled if no other stage reads what a draw in the same scope wrote, and fragments only read what was written
+    /// at their own location. Has no effect unless enableHazardTracking is true.
+    bool useRegionBarriers = false;
+
+    /// @brief The number of frames to defer the destruction of textures, buffers, and pipelines by, or 0 to destroy
+    /// them immediately.
+    ///
+    /// When nonzero, destructors only release their OpenGL names to a list for the current frame, which is destroyed
+    /// by ProcessDeferredDestruction this many frames later. This avoids stalls when objects that the device may still
+    /// be using are destroyed, and lets cached framebuffers that reference released textures be removed in one pass,
+    /// which makes recreating many render targets at once (e.g., on window resize) cheaper.
+    ///
+    /// @note ProcessDeferredDestruction must be called once per frame, or released objects are never destroyed
+    uint32_t deferredDestructionFrames = 0;
+
     /// @brief Profiling hooks. Note that you are responsible for calling func here if you use the hook!
-    void (*renderToSwapchainHook)(const SwapchainRenderInfo& renderInfo, const std::function<void()>& func) = nullptr;
-    void (*renderHook)(const RenderInfo& renderInfo, const std::function<void()>& func) = nullptr;
-    void (*renderNoAttachmentsHook)(const RenderNoAttachmentsInfo& renderInfo, const std::function<void()>& func) = nullptr;
-    void (*computeHook)(std::string_view name, const std::function<void()>& func) = nullptr;
+    ///
+    /// func refers to a callable owned by the scope function, so it must not be stored past the hook's return.
+    void (*renderToSwapchainHook)(const SwapchainRenderInfo& renderInfo, FunctionRef<void()> func) = nullptr;
+    void (*renderHook)(const RenderInfo& renderInfo, FunctionRef<void()> func) = nullptr;
+    void (*renderNoAttachmentsHook)(const RenderNoAttachmentsInfo& renderInfo, FunctionRef<void()> func) = nullptr;
+    void (*computeHook)(std::string_view name, FunctionRef<void()> func) = nullptr;
   };
 
   /// @brief Initializes Fwog's internal structures
@@ -164,4 +239,33 @@ namespace Fwog
   /// @return A DeviceProperties struct containing information about the OpenGL context and device limits
   /// @note This call can replace most calls to glGet.
   const DeviceProperties& GetDeviceProperties();
+
+  /// @brief Query the number of state-setting calls made and skipped when binding graphics pipelines
+  /// @return The counters accumulated since the context was initialized or the counters were last reset
+  const PipelineStateStatistics& GetPipelineStateStatistics();
+
+  /// @brief Resets the counters returned by GetPipelineStateStatistics
+  ///
+  /// Call once per frame to get per-frame counts.
+  void ResetPipelineStateStatistics();
+
+  /// @brief Query the number of memory barriers issued while hazard tracking is enabled
+  /// @return The counters accumulated since the context was initialized or the counters were last reset
+  const HazardTrackingStatistics& GetHazardTrackingStatistics();
+
+  /// @brief Resets the counters returned by GetHazardTrackingStatistics
+  ///
+  /// Call once per frame to get per-frame counts.
+  void ResetHazardTrackingStatistics();
+
+  /// @brief Ends a frame of deferred destruction
+  ///
+  /// Destroys the objects that were released ContextInitializeInfo::deferredDestructionFrames calls ago. Call once per
+  /// frame, e.g., after presenting. Does nothing if deferred destruction is disabled.
+  /// @note Must not be called inside a rendering or compute scope
+  void ProcessDeferredDestruction();
+
+  /// @brief Immediately destroys every object whose destruction was deferred
+  /// @note Must not be called inside a rendering or compute scope
+  void FlushDeferredDestruction();
 } // namespace Fwog
\ No newline at end of file
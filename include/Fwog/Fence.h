@@ -1,6 +1,7 @@
 #pragma once
 #include <Fwog/Config.h>
 #include <cstdint>
+#include <optional>
 
 namespace Fwog
 {
@@ -20,9 +21,25 @@ namespace Fwog
 
     /// @brief Waits for the fence to be signaled and returns
     /// @return How long (in nanoseconds) the fence blocked
-    /// @todo Add timeout parameter
     uint64_t Wait();
 
+    /// @brief Waits for the fence to be signaled or for a timeout to expire
+    /// @param timeoutNs The maximum time to block, in nanoseconds. Zero polls the fence
+    /// @return How long (in nanoseconds) the fence blocked, or std::nullopt if the timeout expired first. The fence
+    /// must be waited on again if it timed out
+    [[nodiscard]] std::optional<uint64_t> Wait(uint64_t timeoutNs);
+
+    /// @brief Queries whether the fence has been signaled and not yet waited on
+    [[nodiscard]] bool IsPending() const noexcept
+    {
+      return sync_ != nullptr;
+    }
+
+    /// @brief Queries whether the fence has been signaled without blocking
+    /// @return True if the fence has been signaled
+    /// @note The fence must have been signaled with Signal() and not yet waited on
+    [[nodiscard]] bool IsSignaled() const;
+
   private:
     void DeleteSync();
 
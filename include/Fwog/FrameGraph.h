@@ -0,0 +1,239 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/BasicTypes.h>
+#include <Fwog/Texture.h>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Fwog
+{
+  class Buffer;
+  class FrameGraph;
+
+  /// @brief Identifies a texture that was created in or imported into a FrameGraph
+  struct FrameGraphTexture
+  {
+    uint32_t index;
+
+    bool operator==(const FrameGraphTexture&) const noexcept = default;
+  };
+
+  /// @brief Identifies a buffer that was imported into a FrameGraph
+  struct FrameGraphBuffer
+  {
+    uint32_t index;
+
+    bool operator==(const FrameGraphBuffer&) const noexcept = default;
+  };
+
+  /// @brief Describes how a pass accesses a resource
+  enum class FrameGraphAccess : uint32_t
+  {
+    /// @brief Read through a sampler, e.g., with Cmd::BindSampledImage
+    SAMPLED_READ,
+
+    /// @brief Read with image loads, e.g., with Cmd::BindImage
+    IMAGE_READ,
+
+    /// @brief Written with image stores. These writes are incoherent
+    IMAGE_WRITE,
+
+    /// @brief Written as a color, depth, or stencil attachment
+    ATTACHMENT_WRITE,
+
+    /// @brief Read as a uniform buffer
+    UNIFORM_READ,
+
+    /// @brief Read as a storage buffer
+    STORAGE_READ,
+
+    /// @brief Written as a storage buffer. These writes are incoherent
+    STORAGE_WRITE,
+
+    /// @brief Read as a vertex buffer
+    VERTEX_READ,
+
+    /// @brief Read as an index buffer
+    INDEX_READ,
+
+    /// @brief Read as the source of indirect draw or dispatch parameters
+    INDIRECT_READ,
+
+    /// @brief Read by a copy or blit
+    TRANSFER_READ,
+
+    /// @brief Written by a copy, blit, clear, or upload
+    TRANSFER_WRITE,
+  };
+
+  struct FrameGraphTextureAccess
+  {
+    FrameGraphTexture texture;
+    FrameGraphAccess access;
+  };
+
+  struct FrameGraphBufferAccess
+  {
+    FrameGraphBuffer buffer;
+    FrameGraphAccess access;
+  };
+
+  /// @brief Parameters for FrameGraph::AddPass
+  ///
+  /// A pass that preserves the existing contents of a resource it writes (e.g., an attachment with
+  /// AttachmentLoadOp::LOAD) must also declare a read of the resource. Otherwise, passes that wrote the resource
+  /// earlier may be culled.
+  struct FrameGraphPassInfo
+  {
+    /// @brief An optional name for identifying the pass
+    std::string_view name;
+    std::span<const FrameGraphTextureAccess> textures = {};
+    std::span<const FrameGraphBufferAccess> buffers = {};
+
+    /// @brief If true, the pass is never culled. Use this for passes with effects the graph can't see, such as
+    /// rendering to the swapchain
+    bool hasSideEffects = false;
+  };
+
+  /// @brief Gives pass callbacks access to the resources of a FrameGraph
+  class FrameGraphResources
+  {
+  public:
+    /// @brief Gets the texture backing a FrameGraphTexture. Transient textures may share storage with other transient
+    /// textures whose lifetimes don't overlap
+    [[nodiscard]] Texture& GetTexture(FrameGraphTexture texture) const;
+
+    [[nodiscard]] Buffer& GetBuffer(FrameGraphBuffer buffer) const;
+
+  private:
+    friend class FrameGraph;
+    explicit FrameGraphResources(FrameGraph& graph) : graph_(&graph) {}
+    FrameGraph* graph_;
+  };
+
+  /// @brief A pass that survived culling, along with the synchronization to perform before it
+  struct FrameGraphCompiledPass
+  {
+    /// @brief The index of the pass, in the order passes were added
+    uint32_t pass;
+
+    /// @brief The barriers to insert with MemoryBarrier before executing the pass
+    MemoryBarrierBits barrierBits;
+
+    /// @brief Whether to call TextureBarrier before executing the pass
+    bool textureBarrier;
+  };
+
+  /// @brief Schedules passes and their synchronization from declared resource accesses
+  ///
+  /// Each frame, create or import resources, add passes that declare how they access those resources, then call
+  /// Compile and Execute. Compiling culls passes that don't contribute to an imported resource or a pass with side
+  /// effects, computes the minimal set of barriers between the remaining passes, and assigns transient textures with
+  /// disjoint lifetimes to shared storage. Compile does not interact with the context, so its results can be inspected
+  /// without one.
+  ///
+  /// Transient textures only share storage if their TextureCreateInfo is identical, since OpenGL textures are
+  /// immutable. Storage persists between frames and is freed when a frame no longer needs it.
+  class FrameGraph
+  {
+  public:
+    FrameGraph() = default;
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+    FrameGraph(FrameGraph&&) noexcept = default;
+    FrameGraph& operator=(FrameGraph&&) noexcept = default;
+
+    /// @brief Declares a texture whose contents only live for the duration of the graph
+    [[nodiscard]] FrameGraphTexture CreateTexture(const TextureCreateInfo& createInfo, std::string_view name = "");
+
+    /// @brief Declares a texture that outlives the graph. Passes that write imported textures are not culled
+    [[nodiscard]] FrameGraphTexture ImportTexture(Texture& texture, std::string_view name = "");
+
+    /// @brief Declares a buffer that outlives the graph. Passes that write imported buffers are not culled
+    [[nodiscard]] FrameGraphBuffer ImportBuffer(Buffer& buffer, std::string_view name = "");
+
+    /// @brief Adds a pass to the graph
+    /// @param info The resources the pass accesses
+    /// @param execute A callback that issues the pass's commands, e.g., with Render or Compute. Not called if the
+    /// pass is culled
+    void AddPass(const FrameGraphPassInfo& info, std::function<void(const FrameGraphResources&)> execute);
+
+    /// @brief Culls passes, computes barriers, and assigns storage to transient textures
+    void Compile();
+
+    /// @brief Executes the compiled passes in order, inserting barriers between them
+    /// @note Must be called outside of rendering and compute scopes
+    void Execute();
+
+    /// @brief Removes all passes and resources so the graph can be rebuilt for the next frame
+    ///
+    /// Storage for transient textures is kept so that the next frame can reuse it.
+    void Reset();
+
+    /// @return The passes that will be executed, in order
+    [[nodiscard]] std::span<const FrameGraphCompiledPass> GetCompiledPasses() const
+    {
+      return compiledPasses_;
+    }
+
+    /// @return The number of distinct textures needed to back the transient textures
+    [[nodiscard]] uint32_t GetPhysicalTextureCount() const
+    {
+      return static_cast<uint32_t>(physicalTextureInfos_.size());
+    }
+
+    /// @return The index of the storage assigned to a transient texture, or std::nullopt if the texture is imported
+    /// or unused by any remaining pass
+    [[nodiscard]] std::optional<uint32_t> GetPhysicalTextureIndex(FrameGraphTexture texture) const;
+
+  private:
+    friend class FrameGraphResources;
+
+    struct TextureResource
+    {
+      std::string name;
+      TextureCreateInfo createInfo;
+      Texture* imported;
+      std::optional<uint32_t> physicalIndex;
+    };
+
+    struct BufferResource
+    {
+      std::string name;
+      Buffer* imported;
+    };
+
+    struct Pass
+    {
+      std::string name;
+      std::vector<FrameGraphTextureAccess> textures;
+      std::vector<FrameGraphBufferAccess> buffers;
+      bool hasSideEffects;
+      std::function<void(const FrameGraphResources&)> execute;
+    };
+
+    struct PooledTexture
+    {
+      TextureCreateInfo createInfo;
+      Texture texture;
+    };
+
+    std::vector<TextureResource> textures_;
+    std::vector<BufferResource> buffers_;
+    std::vector<Pass> passes_;
+
+    // Results of Compile
+    bool isCompiled_ = false;
+    std::vector<FrameGraphCompiledPass> compiledPasses_;
+    std::vector<TextureCreateInfo> physicalTextureInfos_;
+
+    // Storage for transient textures. Indexed by physical texture index after Execute
+    std::vector<PooledTexture> texturePool_;
+  };
+} // namespace Fwog
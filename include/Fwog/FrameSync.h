@@ -0,0 +1,133 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/Fence.h>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace Fwog
+{
+  /// @brief Parameters for the constructor of FrameSync
+  struct FrameSyncCreateInfo
+  {
+    /// @brief The maximum number of frames the device may lag behind the host
+    uint32_t framesInFlight = 2;
+  };
+
+  /// @brief Counters for the time the host spent waiting on the device in FrameSync
+  struct FrameSyncStats
+  {
+    /// @brief How long the most recent call to BeginFrame or TryBeginFrame blocked, in nanoseconds
+    uint64_t lastStallNs{};
+
+    /// @brief The sum of every stall, in nanoseconds
+    uint64_t totalStallNs{};
+
+    /// @brief The number of frames that had to wait for an earlier frame to finish before they could begin
+    uint64_t stalledFrames{};
+
+    /// @brief The number of calls to TryBeginFrame that timed out
+    uint64_t timeouts{};
+  };
+
+  /// @brief Limits the number of frames in flight and retires per-frame resources when the device is done with them
+  ///
+  /// Every frame is delimited by BeginFrame and EndFrame, and a fence is inserted when it ends. Beginning a frame
+  /// waits until the frame framesInFlight frames before it has finished on the device, so that its resources can be
+  /// reused. Frames are retired in order, at which point the callbacks registered for them with OnFrameRetired run.
+  ///
+  /// Resources that are reused every frame, such as a set of uniform buffers, can be indexed by GetFrameSlot. Anything
+  /// else can key off GetFrameIndex and IsFrameComplete, which never block.
+  ///
+  /// @note OpenGL sync objects can't be reset, so a new one is created for each frame. The per-frame slots that own
+  /// them, including the storage for callbacks, are recycled
+  class FrameSync
+  {
+  public:
+    explicit FrameSync(const FrameSyncCreateInfo& createInfo = {});
+
+    /// @brief Waits for every frame in flight and retires it, then runs the callbacks registered for the next frame
+    ~FrameSync();
+
+    FrameSync(const FrameSync&) = delete;
+    FrameSync& operator=(const FrameSync&) = delete;
+    FrameSync(FrameSync&&) = delete;
+    FrameSync& operator=(FrameSync&&) = delete;
+
+    /// @brief Begins a frame, blocking until it has a free slot
+    void BeginFrame();
+
+    /// @brief Begins a frame if it gets a free slot before a timeout expires
+    /// @param timeoutNs The maximum time to block, in nanoseconds. Zero never blocks
+    /// @return True if the frame began. If false, the frame didn't begin and the call can be repeated later
+    [[nodiscard]] bool TryBeginFrame(uint64_t timeoutNs);
+
+    /// @brief Ends the current frame, inserting a fence after the commands issued during it
+    void EndFrame();
+
+    /// @brief Registers a callback to run when the device has finished the current frame
+    ///
+    /// Callbacks run in the order they were registered, during BeginFrame, TryBeginFrame, RetireCompletedFrames,
+    /// IsFrameComplete, or WaitIdle. Callbacks registered outside of a frame belong to the next frame.
+    void OnFrameRetired(std::function<void()> callback);
+
+    /// @brief Retires every frame that the device has finished without blocking
+    void RetireCompletedFrames();
+
+    /// @brief Queries whether the device has finished a frame without blocking
+    ///
+    /// Retires the frame and any frames before it if they are finished.
+    /// @param frameIndex A value returned by GetFrameIndex
+    [[nodiscard]] bool IsFrameComplete(uint64_t frameIndex);
+
+    /// @brief Waits for every frame in flight and retires it
+    /// @note Must not be called between BeginFrame and EndFrame
+    void WaitIdle();
+
+    /// @brief Gets the index of the current frame, or the next frame if called outside of one
+    [[nodiscard]] uint64_t GetFrameIndex() const noexcept
+    {
+      return frameIndex_;
+    }
+
+    /// @brief Gets the slot of the current frame, in [0, framesInFlight). A slot is reused every framesInFlight frames
+    [[nodiscard]] uint32_t GetFrameSlot() const noexcept
+    {
+      return static_cast<uint32_t>(frameIndex_ % slots_.size());
+    }
+
+    /// @brief Gets the number of frames that have been retired. Every frame with a lower index is complete
+    [[nodiscard]] uint64_t GetCompletedFrameCount() const noexcept
+    {
+      return completedFrames_;
+    }
+
+    [[nodiscard]] const FrameSyncStats& GetStats() const noexcept
+    {
+      return stats_;
+    }
+
+  private:
+    struct FrameSlot
+    {
+      Fence fence;
+      std::vector<std::function<void()>> callbacks;
+    };
+
+    // Retires the oldest frame in flight if its fence has been signaled within the timeout. Returns how long it blocked
+    std::optional<uint64_t> TryRetireOldest(uint64_t timeoutNs);
+
+    std::vector<FrameSlot> slots_;
+    std::vector<std::function<void()>> retiringCallbacks_;
+
+    // Callbacks registered outside of a frame. The slot of the next frame may still be in use by an earlier frame
+    // until it begins, so they are moved into it then
+    std::vector<std::function<void()>> pendingCallbacks_;
+    uint64_t frameIndex_{};
+    uint64_t completedFrames_{};
+    bool isRecording_{};
+    FrameSyncStats stats_;
+  };
+} // namespace Fwog
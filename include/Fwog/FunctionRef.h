@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace Fwog
+{
+  template<typename Signature>
+  class FunctionRef;
+
+  /// @brief A non-owning reference to a callable object
+  ///
+  /// Unlike std::function, constructing one never allocates, no matter how much state the callable captures. The
+  /// callable must outlive the reference, so it should only be used for parameters that are invoked before the
+  /// function that takes them returns.
+  template<typename R, typename... Args>
+  class FunctionRef<R(Args...)>
+  {
+  public:
+    template<typename F>
+      requires(!std::is_same_v<std::remove_cvref_t<F>, FunctionRef> && std::is_invocable_r_v<R, F&, Args...>)
+    FunctionRef(F&& func) noexcept
+      : object_(const_cast<void*>(static_cast<const void*>(std::addressof(func)))),
+        invoke_([](void* object, Args... args) -> R
+                { return (*static_cast<std::remove_reference_t<F>*>(object))(std::forward<Args>(args)...); })
+    {
+    }
+
+    R operator()(Args... args) const
+    {
+      return invoke_(object_, std::forward<Args>(args)...);
+    }
+
+  private:
+    void* object_;
+    R (*invoke_)(void*, Args...);
+  };
+} // namespace Fwog
@@ -0,0 +1,181 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/BasicTypes.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/detail/RangeAllocator.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Fwog
+{
+  /// @brief Parameters for the constructor of GeometryArena
+  struct GeometryArenaCreateInfo
+  {
+    /// @brief The size of a vertex, in bytes
+    uint32_t vertexStride;
+
+    /// @brief The number of vertices to allocate storage for up front. The arena grows as needed
+    uint64_t vertexCapacity = 1 << 20;
+
+    /// @brief The number of indices to allocate storage for up front. The arena grows as needed
+    uint64_t indexCapacity = 1 << 22;
+
+    /// @brief The type of every index in the arena
+    IndexType indexType = IndexType::UNSIGNED_INT;
+
+    /// @brief An optional name for the arena's buffers
+    std::string_view name = "";
+  };
+
+  /// @brief Identifies a mesh allocated in a GeometryArena
+  ///
+  /// Ids are recycled after a mesh is freed. The generation distinguishes the meshes that have used an id, so a stale
+  /// handle is caught instead of referring to another mesh.
+  struct GeometryHandle
+  {
+    uint32_t id;
+    uint32_t generation;
+
+    bool operator==(const GeometryHandle&) const noexcept = default;
+  };
+
+  /// @brief Where a mesh's data lives in the arena's buffers
+  ///
+  /// startVertex, startIndex, and indexCount can be used directly as vertexOffset, firstIndex, and indexCount in
+  /// Cmd::DrawIndexed or a DrawIndexedIndirectCommand.
+  struct GeometryRange
+  {
+    int32_t startVertex;
+    uint32_t startIndex;
+    uint32_t indexCount;
+    uint32_t vertexCount;
+  };
+
+  /// @brief Statistics describing the arena's memory usage
+  struct GeometryArenaStats
+  {
+    uint32_t allocationCount;
+
+    uint64_t vertexCapacity;
+    uint64_t usedVertices;
+    uint64_t freeVertexBlocks;
+    uint64_t largestFreeVertexBlock;
+
+    uint64_t indexCapacity;
+    uint64_t usedIndices;
+    uint64_t freeIndexBlocks;
+    uint64_t largestFreeIndexBlock;
+
+    /// @brief One minus the ratio of the largest free block to all free space. Zero means free space is contiguous
+    float vertexFragmentation;
+
+    /// @brief One minus the ratio of the largest free block to all free space. Zero means free space is contiguous
+    float indexFragmentation;
+  };
+
+  /// @brief Suballocates the vertices and indices of many meshes from one vertex buffer and one index buffer
+  ///
+  /// Since every mesh shares the same buffers, the buffers only need to be bound once per frame and any set of meshes
+  /// can be drawn with a single indirect draw.
+  ///
+  /// Ranges are managed with a best-fit free list that merges adjacent free blocks. When an allocation does not fit,
+  /// the buffers grow and their contents are copied with CopyBuffer. Defragment moves every allocation to the front of
+  /// the buffers so that free space becomes contiguous again.
+  ///
+  /// @note Growth and defragmentation replace the buffers and may move allocations, so buffer bindings and ranges
+  /// (e.g., those baked into indirect commands) must be refreshed after either happens. GetBufferGeneration can be
+  /// used to detect this.
+  class GeometryArena
+  {
+  public:
+    explicit GeometryArena(const GeometryArenaCreateInfo& createInfo);
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+    GeometryArena(GeometryArena&&) noexcept = default;
+    GeometryArena& operator=(GeometryArena&&) noexcept = default;
+
+    /// @brief Allocates space for a mesh and uploads its data
+    /// @param vertices The mesh's vertices. The size must be a multiple of the vertex stride
+    /// @param indices The mesh's indices, relative to its first vertex. The size must be a multiple of the index size
+    /// @note Must be called outside of rendering and compute scopes if the arena may need to grow
+    [[nodiscard]] GeometryHandle Allocate(TriviallyCopyableByteSpan vertices, TriviallyCopyableByteSpan indices);
+
+    /// @brief Frees a mesh's space. The handle becomes invalid
+    void Free(GeometryHandle handle);
+
+    /// @return The current location of a mesh's data
+    [[nodiscard]] GeometryRange GetRange(GeometryHandle handle) const;
+
+    /// @return Whether a handle refers to a mesh that hasn't been freed
+    [[nodiscard]] bool IsValid(GeometryHandle handle) const noexcept;
+
+    /// @brief Moves every allocation to the front of the buffers, in address order
+    /// @return Whether any allocation moved
+    /// @note Must be called outside of rendering and compute scopes
+    bool Defragment();
+
+    [[nodiscard]] GeometryArenaStats GetStats() const;
+
+    [[nodiscard]] const Buffer& GetVertexBuffer() const noexcept
+    {
+      return vertexBuffer_;
+    }
+
+    [[nodiscard]] const Buffer& GetIndexBuffer() const noexcept
+    {
+      return indexBuffer_;
+    }
+
+    [[nodiscard]] uint32_t GetVertexStride() const noexcept
+    {
+      return vertexStride_;
+    }
+
+    [[nodiscard]] IndexType GetIndexType() const noexcept
+    {
+      return indexType_;
+    }
+
+    /// @return A counter that increases whenever the buffers are replaced or allocations move
+    [[nodiscard]] uint64_t GetBufferGeneration() const noexcept
+    {
+      return bufferGeneration_;
+    }
+
+  private:
+    struct Allocation
+    {
+      uint64_t vertexOffset;
+      uint64_t vertexCount;
+      uint64_t indexOffset;
+      uint64_t indexCount;
+      uint32_t generation;
+      bool isLive;
+    };
+
+    uint64_t AllocateOrGrow(detail::RangeAllocator& allocator,
+                            Buffer& buffer,
+                            uint64_t count,
+                            uint64_t elementSize,
+                            const std::string& bufferName);
+
+    std::string vertexBufferName_;
+    std::string indexBufferName_;
+    uint32_t vertexStride_;
+    IndexType indexType_;
+    uint32_t indexSize_;
+
+    detail::RangeAllocator vertexAllocator_;
+    detail::RangeAllocator indexAllocator_;
+    Buffer vertexBuffer_;
+    Buffer indexBuffer_;
+    uint64_t bufferGeneration_ = 0;
+
+    std::vector<Allocation> allocations_;
+    std::vector<uint32_t> freeIds_;
+  };
+} // namespace Fwog
@@ -0,0 +1,178 @@
+#pragma once
+#include <Fwog/Config.h>
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Fwog
+{
+  /// @brief Parameters for the constructor of GpuProfiler
+  struct GpuProfilerCreateInfo
+  {
+    /// @brief The number of frames that can be recorded before the oldest one must be resolved
+    ///
+    /// Results are read this many frames late at most. If a frame's results still aren't available when its queries
+    /// are needed again, the frame is dropped instead of stalling.
+    uint32_t framesInFlight = 4;
+
+    /// @brief The maximum number of zones recorded per frame. Zones past this limit are counted and dropped
+    uint32_t maxZonesPerFrame = 256;
+
+    /// @brief The number of resolved frames to keep for GetFrames and ExportChromeTrace
+    uint32_t historySize = 64;
+
+    /// @brief If true, a zone is recorded for every pipeline bound with a name, nested in the scope it was bound in
+    bool recordPipelineZones = true;
+  };
+
+  /// @brief A timed zone in a resolved frame
+  struct GpuProfilerZone
+  {
+    std::string name;
+
+    /// @brief GPU timestamps in nanoseconds
+    uint64_t beginNs{};
+    uint64_t endNs{};
+
+    /// @brief The index of the enclosing zone in GpuProfilerFrame::zones, or noParent
+    uint32_t parent{};
+    uint32_t depth{};
+
+    static constexpr uint32_t noParent = UINT32_MAX;
+  };
+
+  /// @brief The zones of a frame. Zones are ordered by when they began, so every zone follows its parent
+  struct GpuProfilerFrame
+  {
+    uint64_t frameIndex{};
+    std::vector<GpuProfilerZone> zones;
+  };
+
+  /// @brief Counters for data that a GpuProfiler couldn't record
+  struct GpuProfilerStats
+  {
+    /// @brief Zones that began after GpuProfilerCreateInfo::maxZonesPerFrame was reached
+    uint64_t droppedZones{};
+
+    /// @brief Frames whose results weren't available in time
+    uint64_t droppedFrames{};
+  };
+
+  /// @brief Measures the GPU time of named, nested zones without stalling
+  ///
+  /// Each zone is delimited by a pair of timestamp queries. Results are read when they become available, up to
+  /// GpuProfilerCreateInfo::framesInFlight frames later.
+  ///
+  /// While a frame is being recorded, every Render, RenderToSwapchain, RenderNoAttachments, and Compute scope with a
+  /// name becomes a zone, as does every named pipeline that is bound. Other zones can be added with BeginZone and
+  /// EndZone or ScopedGpuZone.
+  ///
+  /// Only one profiler can record at a time.
+  class GpuProfiler
+  {
+  public:
+    explicit GpuProfiler(const GpuProfilerCreateInfo& createInfo = {});
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+    GpuProfiler(GpuProfiler&&) = delete;
+    GpuProfiler& operator=(GpuProfiler&&) = delete;
+
+    /// @brief Resolves finished frames and starts recording a new frame
+    /// @note Must not be called inside a rendering or compute scope
+    void BeginFrame();
+
+    /// @brief Stops recording the current frame. Every zone must have ended
+    void EndFrame();
+
+    /// @brief Begins a zone nested in the innermost open zone
+    /// @note Must be called between BeginFrame and EndFrame
+    void BeginZone(std::string_view name);
+
+    /// @brief Ends the innermost open zone
+    void EndZone();
+
+    /// @brief Gets the resolved frames, oldest first
+    [[nodiscard]] const std::deque<GpuProfilerFrame>& GetFrames() const
+    {
+      return frames_;
+    }
+
+    /// @brief Gets the most recently resolved frame
+    /// @return The frame, or nullptr if no frame has been resolved yet
+    [[nodiscard]] const GpuProfilerFrame* GetLatestFrame() const
+    {
+      return frames_.empty() ? nullptr : &frames_.back();
+    }
+
+    [[nodiscard]] const GpuProfilerStats& GetStats() const
+    {
+      return stats_;
+    }
+
+    /// @brief Formats the resolved frames as a Chrome trace
+    /// @return A JSON string that can be loaded in chrome://tracing or Perfetto
+    [[nodiscard]] std::string ExportChromeTrace() const;
+
+  private:
+    // A zone whose timestamps haven't been read yet. Its name is stored in FrameSlot::names
+    struct PendingZone
+    {
+      uint32_t nameOffset;
+      uint32_t nameLength;
+      uint32_t parent;
+      uint32_t depth;
+    };
+
+    // Queries and zones of a recorded frame. Slots are reused round-robin, so recording doesn't allocate once every
+    // slot has been used
+    struct FrameSlot
+    {
+      std::vector<uint32_t> queries; // A begin and end timestamp per zone
+      std::vector<PendingZone> zones;
+      std::string names;
+      uint32_t lastQuery{}; // The query whose timestamp was issued last. Zones end out of order when they are nested
+      uint64_t frameIndex{};
+      bool isPending{};
+    };
+
+    bool TryResolve(FrameSlot& slot);
+
+    GpuProfilerCreateInfo createInfo_;
+    std::vector<FrameSlot> slots_;
+    uint64_t frameIndex_{};
+    FrameSlot* currentSlot_{};
+
+    // Zones that are open in the current frame. Dropped zones are recorded as droppedZone
+    std::vector<uint32_t> openZones_;
+    static constexpr uint32_t droppedZone = UINT32_MAX;
+
+    std::deque<GpuProfilerFrame> frames_;
+    GpuProfilerStats stats_;
+  };
+
+  /// @brief RAII wrapper for GpuProfiler::BeginZone and GpuProfiler::EndZone
+  class ScopedGpuZone
+  {
+  public:
+    ScopedGpuZone(GpuProfiler& profiler, std::string_view name) : profiler_(profiler)
+    {
+      profiler_.BeginZone(name);
+    }
+
+    ~ScopedGpuZone()
+    {
+      profiler_.EndZone();
+    }
+
+    ScopedGpuZone(const ScopedGpuZone&) = delete;
+    ScopedGpuZone& operator=(const ScopedGpuZone&) = delete;
+
+  private:
+    GpuProfiler& profiler_;
+  };
+} // namespace Fwog
@@ -2,6 +2,8 @@
 #include <Fwog/Config.h>
 #include <Fwog/BasicTypes.h>
 #include <Fwog/detail/Flags.h>
+#include <memory>
+#include <optional>
 #include <span>
 #include <string>
 #include <string_view>
@@ -13,6 +15,12 @@ namespace Fwog
   // clang-format off
   class Shader;
 
+  namespace detail
+  {
+    struct PendingGraphicsPipeline;
+    struct PendingComputePipeline;
+  } // namespace detail
+
   struct InputAssemblyState
   {
     PrimitiveTopology topology  = PrimitiveTopology::TRIANGLE_LIST;
@@ -25,6 +33,8 @@ namespace Fwog
     uint32_t binding;  // glVertexArrayAttribBinding
     Format format;     // glVertexArrayAttribFormat
     uint32_t offset;   // glVertexArrayAttribFormat
+
+    bool operator==(const VertexInputBindingDescription&) const noexcept = default;
   };
 
   struct VertexInputState
@@ -159,14 +169,33 @@ namespace Fwog
 
     bool operator==(const GraphicsPipeline&) const = default;
 
-    /// @brief Gets the handle of the underlying OpenGL program object
-    /// @return The program
+    /// @brief Gets the handle of the pipeline
+    /// @return An opaque handle that identifies the pipeline. It is not the name of an OpenGL program object
     [[nodiscard]] uint64_t Handle() const
     {
       return id_;
     }
 
+    /// @brief Gets the binding of a uniform block in the pipeline
+    /// @param block The name of the uniform block
+    /// @return The binding, or std::nullopt if the pipeline has no active uniform block with the name
+    /// @note Resolving a binding once and passing it to the index-based Cmd::BindUniformBuffer avoids a lookup per bind
+    [[nodiscard]] std::optional<uint32_t> GetUniformBlockBinding(std::string_view block) const;
+
+    /// @brief Gets the binding of a storage block in the pipeline
+    /// @param block The name of the storage block
+    /// @return The binding, or std::nullopt if the pipeline has no active storage block with the name
+    [[nodiscard]] std::optional<uint32_t> GetStorageBlockBinding(std::string_view block) const;
+
+    /// @brief Gets the texture or image unit of a sampler or image uniform in the pipeline
+    /// @param uniform The name of the uniform
+    /// @return The unit, or std::nullopt if the pipeline has no active sampler or image uniform with the name
+    [[nodiscard]] std::optional<uint32_t> GetSamplerOrImageBinding(std::string_view uniform) const;
+
   private:
+    friend class GraphicsPipelineFuture;
+    explicit GraphicsPipeline(uint64_t id) : id_(id) {}
+
     uint64_t id_;
   };
 
@@ -185,16 +214,91 @@ namespace Fwog
     
     [[nodiscard]] Extent3D WorkgroupSize() const;
     
-    /// @brief Gets the handle of the underlying OpenGL program object
-    /// @return The program
+    /// @brief Gets the handle of the pipeline
+    /// @return An opaque handle that identifies the pipeline. It is not the name of an OpenGL program object
     [[nodiscard]] uint64_t Handle() const
     {
       return id_;
     }
 
+    /// @brief Gets the binding of a uniform block in the pipeline
+    /// @param block The name of the uniform block
+    /// @return The binding, or std::nullopt if the pipeline has no active uniform block with the name
+    /// @note Resolving a binding once and passing it to the index-based Cmd::BindUniformBuffer avoids a lookup per bind
+    [[nodiscard]] std::optional<uint32_t> GetUniformBlockBinding(std::string_view block) const;
+
+    /// @brief Gets the binding of a storage block in the pipeline
+    /// @param block The name of the storage block
+    /// @return The binding, or std::nullopt if the pipeline has no active storage block with the name
+    [[nodiscard]] std::optional<uint32_t> GetStorageBlockBinding(std::string_view block) const;
+
+    /// @brief Gets the texture or image unit of a sampler or image uniform in the pipeline
+    /// @param uniform The name of the uniform
+    /// @return The unit, or std::nullopt if the pipeline has no active sampler or image uniform with the name
+    [[nodiscard]] std::optional<uint32_t> GetSamplerOrImageBinding(std::string_view uniform) const;
+
   private:
+    friend class ComputePipelineFuture;
+    explicit ComputePipeline(uint64_t id) : id_(id) {}
+
     uint64_t id_;
   };
 
+  /// @brief A graphics pipeline whose program may still be linking
+  ///
+  /// Linking is started by the constructor, but its status isn't queried until Get is called. Creating every future
+  /// before calling Get on any of them lets the driver link the programs concurrently. The shaders only need to be
+  /// alive during construction. When DeviceFeatures::parallelShaderCompile is supported, IsReady can be polled to find
+  /// out whether Get would block.
+  class GraphicsPipelineFuture
+  {
+  public:
+    explicit GraphicsPipelineFuture(const GraphicsPipelineInfo& info);
+    ~GraphicsPipelineFuture();
+    GraphicsPipelineFuture(GraphicsPipelineFuture&& old) noexcept;
+    GraphicsPipelineFuture& operator=(GraphicsPipelineFuture&& old) noexcept;
+    GraphicsPipelineFuture(const GraphicsPipelineFuture&) = delete;
+    GraphicsPipelineFuture& operator=(const GraphicsPipelineFuture&) = delete;
+
+    /// @brief Queries whether linking has finished without blocking
+    /// @return If DeviceFeatures::parallelShaderCompile is supported, true means Get will not block. Otherwise, this
+    /// always returns true and says nothing about whether Get will block
+    [[nodiscard]] bool IsReady() const;
+
+    /// @brief Waits for linking to finish and takes the pipeline
+    /// @note May only be called once
+    /// @throws PipelineCompilationException
+    [[nodiscard]] GraphicsPipeline Get();
+
+  private:
+    std::unique_ptr<detail::PendingGraphicsPipeline> pending_;
+  };
+
+  /// @brief A compute pipeline whose program may still be linking
+  /// @see GraphicsPipelineFuture
+  class ComputePipelineFuture
+  {
+  public:
+    explicit ComputePipelineFuture(const ComputePipelineInfo& info);
+    ~ComputePipelineFuture();
+    ComputePipelineFuture(ComputePipelineFuture&& old) noexcept;
+    ComputePipelineFuture& operator=(ComputePipelineFuture&& old) noexcept;
+    ComputePipelineFuture(const ComputePipelineFuture&) = delete;
+    ComputePipelineFuture& operator=(const ComputePipelineFuture&) = delete;
+
+    /// @brief Queries whether linking has finished without blocking
+    /// @return If DeviceFeatures::parallelShaderCompile is supported, true means Get will not block. Otherwise, this
+    /// always returns true and says nothing about whether Get will block
+    [[nodiscard]] bool IsReady() const;
+
+    /// @brief Waits for linking to finish and takes the pipeline
+    /// @note May only be called once
+    /// @throws PipelineCompilationException
+    [[nodiscard]] ComputePipeline Get();
+
+  private:
+    std::unique_ptr<detail::PendingComputePipeline> pending_;
+  };
+
   // clang-format on
 } // namespace Fwog
\ No newline at end of file
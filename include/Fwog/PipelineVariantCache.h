@@ -0,0 +1,211 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/Pipeline.h>
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+
+namespace Fwog
+{
+  namespace detail
+  {
+    template<typename Pipeline>
+    struct PipelineFutureType;
+
+    template<>
+    struct PipelineFutureType<GraphicsPipeline>
+    {
+      using type = GraphicsPipelineFuture;
+    };
+
+    template<>
+    struct PipelineFutureType<ComputePipeline>
+    {
+      using type = ComputePipelineFuture;
+    };
+  } // namespace detail
+
+  /// @brief Counters for a PipelineVariantCache
+  struct PipelineVariantCacheStats
+  {
+    /// @brief The number of calls to Get that found a variant that had already been built or prefetched
+    uint64_t hits{};
+
+    /// @brief The number of variants that were built, including prefetched variants
+    uint64_t builds{};
+
+    /// @brief The number of variants that were destroyed to stay within the variant limit
+    uint64_t evictions{};
+  };
+
+  /// @brief Lazily builds and caches the variants of a pipeline
+  ///
+  /// Each variant is identified by a bitmask key in which every bit enables a feature, typically a specialization
+  /// constant or a define. Variants are built on first use by a user-provided function, so only the permutations that
+  /// are actually used are compiled.
+  ///
+  /// Keys are masked with CreateInfo::keyMask before lookup, so keys that only differ in bits that don't affect the
+  /// pipeline share one variant. If CreateInfo::maxVariants is nonzero, building a variant while the cache is full
+  /// first destroys the least recently used variant.
+  ///
+  /// @tparam Pipeline GraphicsPipeline or ComputePipeline
+  template<typename Pipeline>
+  class PipelineVariantCache
+  {
+  public:
+    using Future = typename detail::PipelineFutureType<Pipeline>::type;
+
+    /// @brief Starts building the variant for a masked key. Exceptions are propagated to the caller of Get or Prefetch
+    using BuildFunc = std::function<Future(uint64_t key)>;
+
+    struct CreateInfo
+    {
+      BuildFunc build;
+
+      /// @brief The bits of a key that select a variant
+      uint64_t keyMask = ~uint64_t(0);
+
+      /// @brief The maximum number of variants to keep, or 0 for no limit. Variants that are still building are never
+      /// evicted, so the limit may be exceeded temporarily
+      uint32_t maxVariants = 0;
+    };
+
+    explicit PipelineVariantCache(CreateInfo createInfo) : createInfo_(std::move(createInfo))
+    {
+      FWOG_ASSERT(createInfo_.build);
+    }
+
+    /// @brief Gets the variant for a key, building it if necessary
+    ///
+    /// Blocks if the variant hasn't been built yet or is still building.
+    /// @return A reference that is valid until the variant is evicted. Variants are evicted in least recently used
+    /// order, so the reference can be used until maxVariants - 1 other variants have been requested
+    /// @throws ShaderCompilationException
+    /// @throws PipelineCompilationException
+    [[nodiscard]] const Pipeline& Get(uint64_t key)
+    {
+      key &= createInfo_.keyMask;
+
+      auto it = variants_.find(key);
+      if (it == variants_.end())
+      {
+        it = BeginBuild(key);
+      }
+      else
+      {
+        stats_.hits++;
+      }
+
+      auto& variant = it->second;
+      variant.lastUse = ++useCounter_;
+      if (!variant.pipeline)
+      {
+        try
+        {
+          variant.pipeline.emplace(variant.future->Get());
+        }
+        catch (...)
+        {
+          variants_.erase(it);
+          throw;
+        }
+        variant.future.reset();
+      }
+
+      return *variant.pipeline;
+    }
+
+    /// @brief Starts building the variants for keys that haven't been built without waiting for them
+    ///
+    /// Variants are linked concurrently if DeviceFeatures::parallelShaderCompile is supported. Otherwise, this only
+    /// moves the cost of starting the build to the caller.
+    /// @throws ShaderCompilationException
+    void Prefetch(std::span<const uint64_t> keys)
+    {
+      for (auto key : keys)
+      {
+        key &= createInfo_.keyMask;
+        if (!variants_.contains(key))
+        {
+          BeginBuild(key)->second.lastUse = ++useCounter_;
+        }
+      }
+    }
+
+    /// @brief Queries whether the variant for a key has been built or is building
+    [[nodiscard]] bool Contains(uint64_t key) const
+    {
+      return variants_.contains(key & createInfo_.keyMask);
+    }
+
+    /// @brief Gets the number of variants that have been built or are building
+    [[nodiscard]] size_t Size() const
+    {
+      return variants_.size();
+    }
+
+    /// @brief Destroys every variant
+    void Clear()
+    {
+      variants_.clear();
+    }
+
+    [[nodiscard]] const PipelineVariantCacheStats& GetStats() const
+    {
+      return stats_;
+    }
+
+  private:
+    struct Variant
+    {
+      std::optional<Future> future;
+      std::optional<Pipeline> pipeline;
+      uint64_t lastUse{};
+    };
+
+    using VariantMap = std::unordered_map<uint64_t, Variant>;
+
+    typename VariantMap::iterator BeginBuild(uint64_t key)
+    {
+      EvictIfFull();
+      auto future = createInfo_.build(key);
+      stats_.builds++;
+      return variants_.emplace(key, Variant{.future = std::move(future), .pipeline = std::nullopt}).first;
+    }
+
+    void EvictIfFull()
+    {
+      if (createInfo_.maxVariants == 0 || variants_.size() < createInfo_.maxVariants)
+      {
+        return;
+      }
+
+      auto victim = variants_.end();
+      for (auto it = variants_.begin(); it != variants_.end(); ++it)
+      {
+        if (it->second.pipeline && (victim == variants_.end() || it->second.lastUse < victim->second.lastUse))
+        {
+          victim = it;
+        }
+      }
+
+      if (victim != variants_.end())
+      {
+        variants_.erase(victim);
+        stats_.evictions++;
+      }
+    }
+
+    CreateInfo createInfo_;
+    VariantMap variants_;
+    uint64_t useCounter_{};
+    PipelineVariantCacheStats stats_;
+  };
+
+  using GraphicsPipelineVariantCache = PipelineVariantCache<GraphicsPipeline>;
+  using ComputePipelineVariantCache = PipelineVariantCache<ComputePipeline>;
+} // namespace Fwog
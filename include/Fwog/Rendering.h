@@ -1,9 +1,10 @@
 #pragma once
 #include <Fwog/Config.h>
 #include <Fwog/BasicTypes.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/FunctionRef.h>
 #include <Fwog/Texture.h>
 #include <array>
-#include <functional>
 #include <optional>
 #include <span>
 #include <string_view>
@@ -17,6 +18,8 @@ namespace Fwog
   class Texture;
   class Sampler;
   class Buffer;
+  class CommandBuffer;
+  class BindGroup;
   struct GraphicsPipeline;
   struct ComputePipeline;
 
@@ -182,21 +185,21 @@ namespace Fwog
   /// The swapchain can be thought of as "the window". This function is provided because OpenGL nor 
   /// windowing libraries provide a simple mechanism to access the swapchain as a set of images without 
   /// interop with an explicit API like Vulkan or D3D12.
-  void RenderToSwapchain(const SwapchainRenderInfo& renderInfo, const std::function<void()>& func);
+  void RenderToSwapchain(const SwapchainRenderInfo& renderInfo, FunctionRef<void()> func);
   
   /// @brief Renders to a set of textures
   /// @param renderInfo Rendering parameters
   /// @param func A callback that invokes rendering commands
-  void Render(const RenderInfo& renderInfo, const std::function<void()>& func);
+  void Render(const RenderInfo& renderInfo, FunctionRef<void()> func);
 
   /// @brief Renders to a virtual texture
   /// @param renderInfo Rendering parameters
   /// @param func A callback that invokes rendering commands
-  void RenderNoAttachments(const RenderNoAttachmentsInfo& renderInfo, const std::function<void()>& func);
+  void RenderNoAttachments(const RenderNoAttachmentsInfo& renderInfo, FunctionRef<void()> func);
 
   /// @brief Begins a compute scope
   /// @param func A callback that invokes dispatch commands
-  void Compute(std::string_view name, const std::function<void()>& func);
+  void Compute(std::string_view name, FunctionRef<void()> func);
 
   /// @brief Blits a texture to another texture. Supports minification and magnification
   void BlitTexture(const Texture& source,
@@ -443,12 +446,22 @@ namespace Fwog
     /// @brief Binds a range within a buffer as a storage buffer
     ///
     /// Similar to glBindBufferRange(GL_SHADER_STORAGE_BUFFER, ...)
-    void BindStorageBuffer(uint32_t index, const Buffer& buffer, uint64_t offset = 0, uint64_t size = WHOLE_BUFFER);
+    /// @param access How shaders access the buffer. Only used by hazard tracking, where buffers that aren't bound as
+    /// READ_ONLY are treated as written by every draw or dispatch in the scope
+    void BindStorageBuffer(uint32_t index,
+                           const Buffer& buffer,
+                           uint64_t offset = 0,
+                           uint64_t size = WHOLE_BUFFER,
+                           ShaderAccess access = ShaderAccess::READ_WRITE);
     
     /// @brief Binds a range within a buffer as a storage buffer
     /// @param block The name of the storage block whose index to bind to
     /// @note Must be called after a pipeline is bound in order to get reflected program info
-    void BindStorageBuffer(std::string_view block, const Buffer& buffer, uint64_t offset = 0, uint64_t size = WHOLE_BUFFER);
+    void BindStorageBuffer(std::string_view block,
+                           const Buffer& buffer,
+                           uint64_t offset = 0,
+                           uint64_t size = WHOLE_BUFFER,
+                           ShaderAccess access = ShaderAccess::READ_WRITE);
 
     /// @brief Binds a texture and a sampler to a texture unit
     ///
@@ -463,12 +476,32 @@ namespace Fwog
     /// @brief Binds a texture to an image unit
     ///
     /// Similar to glBindImageTexture{s}
-    void BindImage(uint32_t index, const Texture& texture, uint32_t level);
+    /// @param access How shaders access the image. Images that aren't bound as READ_ONLY are treated as written by every
+    /// draw or dispatch in the scope when hazard tracking is enabled
+    void BindImage(uint32_t index, const Texture& texture, uint32_t level, ShaderAccess access = ShaderAccess::READ_WRITE);
     
     /// @brief Binds a texture to an image unit
     /// @param uniform The name of the uniform whose index to bind to
     /// @note Must be called after a pipeline is bound in order to get reflected program info
-    void BindImage(std::string_view uniform, const Texture& texture, uint32_t level);
+    void BindImage(std::string_view uniform,
+                   const Texture& texture,
+                   uint32_t level,
+                   ShaderAccess access = ShaderAccess::READ_WRITE);
+
+    /// @brief Binds every resource in a BindGroup, skipping slots that already hold the same binding
+    ///
+    /// Similar to glBindBuffersRange + glBindTextures + glBindSamplers + glBindImageTextures
+    void BindGroup(const Fwog::BindGroup& group);
+
+    /// @brief Updates a range of the push constant block and binds it to PUSH_CONSTANT_BINDING
+    /// @param data The data to write. Its size and offset must fit in the bound pipeline's push constant block
+    /// @param offset The byte offset into the block
+    ///
+    /// OpenGL has no push constants, so they are emulated with a uniform block. The whole block is written to a
+    /// persistently mapped ring buffer on each call, so it only costs a memcpy and a glBindBufferRange. Bytes outside of
+    /// the updated range keep the values that were pushed last, even across pipeline binds.
+    /// @note Must be called after a pipeline is bound in order to get reflected program info
+    void PushConstants(TriviallyCopyableByteSpan data, uint32_t offset = 0);
 
     /// @brief Invokes a compute shader
     /// @param groupCountX The number of local workgroups to dispatch in the X dimension
@@ -522,6 +555,14 @@ namespace Fwog
     /// Valid in compute scopes.
     void DispatchIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset);
 
+    /// @brief Replays the commands recorded in a command buffer
+    /// @param commandBuffer The command buffer to replay
+    ///
+    /// Commands are executed in the order in which they were recorded, as if the corresponding functions in this
+    /// namespace were called directly. Valid in rendering and compute scopes, subject to the scope requirements of
+    /// each recorded command.
+    void ExecuteCommandBuffer(const CommandBuffer& commandBuffer);
+
     // clang-format on
   } // namespace Cmd
 } // namespace Fwog
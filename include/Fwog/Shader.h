@@ -6,6 +6,13 @@
 
 namespace Fwog
 {
+  class Shader;
+
+  namespace detail
+  {
+    uint64_t GetSourceHash(const Shader& shader);
+  } // namespace detail
+
   enum class PipelineStage
   {
     VERTEX_SHADER,
@@ -66,13 +73,63 @@ namespace Fwog
       return id_;
     }
 
+  private:
+    friend class ShaderFuture;
+    friend uint64_t detail::GetSourceHash(const Shader& shader);
+
+    // Takes ownership of a shader that has already been validated
+    Shader(uint32_t id, uint64_t sourceHash) : id_(id), sourceHash_(sourceHash) {}
+
+    uint32_t id_{};
+
+    // Identifies the stage and source the shader was created from. Used to key the program binary cache
+    uint64_t sourceHash_{};
+  };
+
+  /// @brief A shader whose compilation may still be in progress
+  ///
+  /// Compilation is started by the constructor, but its status isn't queried until Get is called. Creating every
+  /// ShaderFuture before calling Get on any of them lets the driver compile them concurrently. When
+  /// DeviceFeatures::parallelShaderCompile is supported, IsReady can be polled to find out whether Get would block.
+  class ShaderFuture
+  {
+  public:
+    /// @brief Starts compiling a shader from GLSL
+    /// @param stage A pipeline stage
+    /// @param source A GLSL source string
+    /// @param name An optional debug identifier
+    explicit ShaderFuture(PipelineStage stage, std::string_view source, std::string_view name = "");
+
+    /// @brief Starts compiling a shader from SPIR-V
+    explicit ShaderFuture(PipelineStage stage, const ShaderSpirvInfo& spirvInfo, std::string_view name = "");
+    ShaderFuture(const ShaderFuture&) = delete;
+    ShaderFuture(ShaderFuture&& old) noexcept;
+    ShaderFuture& operator=(const ShaderFuture&) = delete;
+    ShaderFuture& operator=(ShaderFuture&& old) noexcept;
+    ~ShaderFuture();
+
+    /// @brief Queries whether compilation has finished without blocking
+    /// @return If DeviceFeatures::parallelShaderCompile is supported, true means Get will not block. Otherwise, this
+    /// always returns true and says nothing about whether Get will block
+    [[nodiscard]] bool IsReady() const;
+
+    /// @brief Waits for compilation to finish and takes the shader
+    /// @note May only be called once
+    /// @throws ShaderCompilationException if the shader is malformed
+    [[nodiscard]] Shader Get();
+
   private:
     uint32_t id_{};
+    uint64_t sourceHash_{};
   };
 
   namespace detail
   {
     // Checks shader compile status and throws if it failed
     void ValidateShader(uint32_t id);
+
+    // Returns true if compiling or linking has finished, or if completion can't be queried without blocking
+    bool IsShaderCompileComplete(uint32_t id);
+    bool IsProgramLinkComplete(uint32_t id);
   }
 } // namespace Fwog
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+#include <Fwog/Config.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Fwog
+{
+  /// @brief A macro to define in a preprocessed shader
+  struct ShaderDefine
+  {
+    std::string_view name;
+    std::string_view value = "";
+  };
+
+  /// @brief The result of ShaderPreprocessor::Preprocess
+  struct PreprocessedShader
+  {
+    /// @brief The source with every include expanded and every define injected
+    std::string source;
+
+    /// @brief A 64-bit FNV-1a hash of source. Equal sources have equal hashes across runs
+    uint64_t hash{};
+
+    /// @brief The normalized paths of the root file and the files it includes, in the order they were first included
+    ///
+    /// The index of a path is the source string number that #line directives refer to, so a compiler error like
+    /// "2(15)" refers to line 15 of files[2].
+    std::vector<std::string> files;
+  };
+
+  /// @brief Expands #include directives in GLSL and injects defines for shader permutations
+  ///
+  /// Files are read through a virtual filesystem: files added with AddFile take precedence, then the loader is
+  /// called. Each file is read and scanned for includes once. Later expansions reuse the parsed file, so building
+  /// many permutations of the same shader only costs the concatenation.
+  ///
+  /// `#include "path"` and `#include <path>` are resolved relative to the including file's directory first, then
+  /// relative to each include directory in the order they were added. Include guards work as usual, as included files
+  /// are pasted verbatim.
+  class ShaderPreprocessor
+  {
+  public:
+    /// @brief Returns the contents of the file at a path, or std::nullopt if it doesn't exist
+    using FileLoader = std::function<std::optional<std::string>(const std::string& path)>;
+
+    /// @brief Constructs a preprocessor
+    /// @param loader The function used to read files. If empty, files are read from disk
+    explicit ShaderPreprocessor(FileLoader loader = {});
+    ShaderPreprocessor(const ShaderPreprocessor&) = delete;
+    ShaderPreprocessor(ShaderPreprocessor&&) noexcept;
+    ShaderPreprocessor& operator=(const ShaderPreprocessor&) = delete;
+    ShaderPreprocessor& operator=(ShaderPreprocessor&&) noexcept;
+    ~ShaderPreprocessor();
+
+    /// @brief Adds a directory to search for included files
+    void AddIncludeDirectory(std::string_view directory);
+
+    /// @brief Adds an in-memory file that can be included or preprocessed. Replaces any file with the same path
+    void AddFile(std::string_view path, std::string_view contents);
+
+    /// @brief Expands a shader's includes and injects defines
+    /// @param path The path of the root file. It is not searched for in the include directories
+    /// @param defines Macros to define. They are inserted after the #version directive, or at the top if there is none
+    /// @throws ShaderCompilationException if a file can't be found or includes are nested too deeply
+    [[nodiscard]] PreprocessedShader Preprocess(std::string_view path, std::span<const ShaderDefine> defines = {});
+
+    /// @brief Forgets every file read through the loader, so that changed files will be read again
+    void ClearCache();
+
+  private:
+    struct ParsedFile;
+    struct Expansion;
+
+    const ParsedFile* GetFile(const std::string& path);
+    void Expand(const ParsedFile& file, uint32_t fileIndex, size_t start, Expansion& expansion, uint32_t depth);
+
+    FileLoader loader_;
+    std::vector<std::string> includeDirectories_;
+    std::unordered_map<std::string, std::string> virtualFiles_;
+
+    // Null entries record files that couldn't be found
+    std::unordered_map<std::string, std::unique_ptr<const ParsedFile>> cache_;
+  };
+} // namespace Fwog
@@ -0,0 +1,137 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/BasicTypes.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/Fence.h>
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Fwog
+{
+  class Texture;
+
+  /// @brief Parameters for the constructor of TextureStreamer
+  struct TextureStreamerCreateInfo
+  {
+    /// @brief The size of each staging buffer, in bytes. This limits the size of a single submission
+    uint64_t stagingBufferSize = 16 * 1024 * 1024;
+
+    /// @brief The number of staging buffers in the pool
+    uint32_t stagingBufferCount = 4;
+
+    /// @brief The maximum number of bytes that TextureStreamer::Update will copy to textures per call
+    ///
+    /// At least one submission is processed per call, even if it exceeds the budget.
+    uint64_t uploadBudgetPerUpdate = 32 * 1024 * 1024;
+  };
+
+  /// @brief Describes a region of a texture to be filled with data from a staging buffer
+  ///
+  /// Members have the same meaning as their counterparts in CopyBufferToTextureInfo, except that sourceOffset is
+  /// relative to the start of the staging buffer.
+  struct TextureStreamRegion
+  {
+    uint32_t level = 0;
+    uint64_t sourceOffset = 0;
+    Offset3D targetOffset = {};
+    Extent3D extent = {};
+    UploadFormat format = UploadFormat::INFER_FORMAT;
+    UploadType type = UploadType::INFER_TYPE;
+    uint32_t bufferRowLength = 0;
+    uint32_t bufferImageHeight = 0;
+  };
+
+  /// @brief A staging buffer that has been acquired for writing
+  struct TextureStreamStaging
+  {
+    uint32_t index;
+    uint64_t size;
+    void* mappedPointer;
+  };
+
+  /// @brief Streams texture data to the device through a pool of persistently mapped staging buffers
+  ///
+  /// Worker threads acquire a staging buffer with TryAcquireStaging, write texel data (e.g., by decoding an image)
+  /// directly into its mapped memory, then call Submit. TryAcquireStaging and Submit are thread-safe.
+  ///
+  /// The thread that owns the context calls Update once per frame. Update issues CopyBufferToTexture for submitted
+  /// regions, up to the upload budget, and recycles staging buffers once fences show the device is done with them.
+  ///
+  /// @note Textures referenced by a submission must stay alive until the submission has been processed by Update.
+  class TextureStreamer
+  {
+  public:
+    explicit TextureStreamer(const TextureStreamerCreateInfo& createInfo = {});
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+    TextureStreamer(TextureStreamer&&) = delete;
+    TextureStreamer& operator=(TextureStreamer&&) = delete;
+
+    /// @brief Acquires a free staging buffer. Thread-safe
+    /// @return The staging buffer, or std::nullopt if every staging buffer is in use
+    [[nodiscard]] std::optional<TextureStreamStaging> TryAcquireStaging();
+
+    /// @brief Queues the contents of a staging buffer to be copied into a texture. Thread-safe
+    /// @param staging A staging buffer acquired with TryAcquireStaging. Ownership returns to the streamer
+    /// @param texture The texture to copy to
+    /// @param regions The regions of the texture to fill
+    /// @param size The number of bytes of the staging buffer that the regions read. Counted against the upload budget
+    void Submit(const TextureStreamStaging& staging,
+                Texture& texture,
+                std::span<const TextureStreamRegion> regions,
+                uint64_t size);
+
+    /// @brief Returns an acquired staging buffer without uploading anything. Thread-safe
+    void Release(const TextureStreamStaging& staging);
+
+    /// @brief Issues queued copies and recycles staging buffers that the device is done with
+    /// @note Must be called on the thread that owns the context, outside of rendering and compute scopes
+    void Update();
+
+    /// @return The number of bytes of staging memory submitted and not yet known to be consumed by the device
+    /// @note Must be called on the thread that owns the context
+    [[nodiscard]] uint64_t BytesInFlight() const;
+
+    /// @return The number of bytes copied to textures in the most recent call to Update
+    [[nodiscard]] uint64_t BytesUploadedLastUpdate() const noexcept
+    {
+      return bytesUploadedLastUpdate_;
+    }
+
+  private:
+    struct PendingUpload
+    {
+      uint32_t stagingIndex;
+      Texture* texture;
+      std::vector<TextureStreamRegion> regions;
+      uint64_t size;
+    };
+
+    struct InFlightUpload
+    {
+      uint32_t stagingIndex;
+      uint64_t size;
+      Fence fence;
+    };
+
+    TextureStreamerCreateInfo createInfo_;
+    std::vector<Buffer> stagingBuffers_;
+
+    // Shared with worker threads
+    mutable std::mutex mutex_;
+    std::vector<uint32_t> freeStaging_;
+    std::deque<PendingUpload> pending_;
+    uint64_t bytesPending_{};
+
+    // Only accessed by the thread that owns the context
+    std::deque<InFlightUpload> inFlight_;
+    uint64_t bytesInFlight_{};
+    uint64_t bytesUploadedLastUpdate_{};
+  };
+} // namespace Fwog
@@ -0,0 +1,88 @@
+#pragma once
+#include <Fwog/Config.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/Fence.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/detail/RingAllocator.h>
+
+#include <cstdint>
+#include <string_view>
+
+namespace Fwog
+{
+  /// @brief A range of an UploadRing's buffer that can be written by the host and read by the device
+  struct UploadAllocation
+  {
+    /// @brief The buffer containing the allocation. Pass this, offset, and size to Cmd::BindUniformBuffer or
+    /// Cmd::BindStorageBuffer
+    ReferenceWrapper<const Buffer> buffer;
+
+    /// @brief The offset of the allocation in the buffer, in bytes
+    uint64_t offset;
+
+    /// @brief The size of the allocation, in bytes
+    uint64_t size;
+
+    /// @brief A pointer to the allocation's mapped memory
+    void* mappedPointer;
+  };
+
+  /// @brief A persistently mapped buffer that sub-allocates transient ranges for data that changes every frame
+  ///
+  /// Allocations are written directly through mapped memory, which avoids the driver-side copies and implicit
+  /// synchronization of Buffer::UpdateData. Call EndFrame once per frame after the commands that consume that frame's
+  /// allocations have been issued. When the ring is full, allocating waits for the oldest frame's fence, so the
+  /// ring should be sized to hold a few frames worth of allocations.
+  ///
+  /// @note Data written to an allocation must not be modified after commands that read it have been issued.
+  class UploadRing
+  {
+  public:
+    /// @param size The size of the underlying buffer, in bytes
+    explicit UploadRing(size_t size, std::string_view name = "");
+
+    UploadRing(UploadRing&& old) noexcept = default;
+    UploadRing& operator=(UploadRing&& old) noexcept = default;
+    UploadRing(const UploadRing&) = delete;
+    UploadRing& operator=(const UploadRing&) = delete;
+
+    /// @brief Allocates a range of memory
+    /// @param size The size of the allocation, in bytes. Must not exceed the capacity of the ring
+    /// @param alignment The alignment of the allocation's offset, in bytes. Must be a power of two
+    /// @note May block if the ring is full
+    [[nodiscard]] UploadAllocation Allocate(uint64_t size, uint64_t alignment);
+
+    /// @brief Allocates a range of memory suitable for binding with Cmd::BindUniformBuffer
+    [[nodiscard]] UploadAllocation AllocateUniform(uint64_t size);
+
+    /// @brief Allocates a range of memory suitable for binding with Cmd::BindStorageBuffer
+    [[nodiscard]] UploadAllocation AllocateStorage(uint64_t size);
+
+    /// @brief Allocates a range of memory suitable for binding with Cmd::BindUniformBuffer and copies data into it
+    UploadAllocation UploadUniform(TriviallyCopyableByteSpan data);
+
+    /// @brief Allocates a range of memory suitable for binding with Cmd::BindStorageBuffer and copies data into it
+    UploadAllocation UploadStorage(TriviallyCopyableByteSpan data);
+
+    /// @brief Marks the end of a frame's allocations
+    ///
+    /// Inserts a fence into the command stream, after which memory allocated since the previous call to EndFrame can
+    /// be reused.
+    void EndFrame();
+
+    [[nodiscard]] const Buffer& GetBuffer() const noexcept
+    {
+      return buffer_;
+    }
+
+    /// @return The number of bytes that are allocated or waiting for the device to finish using them
+    [[nodiscard]] uint64_t BytesInUse() const noexcept
+    {
+      return ring_.BytesInUse();
+    }
+
+  private:
+    Buffer buffer_;
+    detail::RingAllocator<Fence> ring_;
+  };
+} // namespace Fwog
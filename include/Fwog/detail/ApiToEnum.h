@@ -29,6 +29,8 @@ namespace Fwog::detail
 
   GLint ComponentSwizzleToGL(ComponentSwizzle swizzle);
 
+  GLenum ShaderAccessToGL(ShaderAccess access);
+
   int ImageTypeToDimension(ImageType imageType);
 
   UploadFormat FormatToUploadFormat(Format format);
@@ -2,30 +2,268 @@
 #include <Fwog/Context.h>
 
 #include <Fwog/BasicTypes.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/UploadRing.h>
 #include <Fwog/detail/FramebufferCache.h>
 #include <Fwog/detail/PipelineManager.h>
 #include <Fwog/detail/SamplerCache.h>
 #include <Fwog/detail/VertexArrayCache.h>
 
+#include <array>
 #include <sstream>
+#include <string>
 #include <memory>
+#include <optional>
 #include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include FWOG_OPENGL_HEADER
 
+// GL_KHR_parallel_shader_compile and GL_ARB_parallel_shader_compile share this token. Neither is in the loader
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace Fwog
+{
+  class GpuProfiler;
+}
+
 namespace Fwog::detail
 {
-  constexpr int MAX_COLOR_ATTACHMENTS = 8;
+  struct StencilOps
+  {
+    StencilOp failOp;
+    StencilOp depthFailOp;
+    StencilOp passOp;
+
+    bool operator==(const StencilOps&) const noexcept = default;
+  };
+
+  struct StencilFunc
+  {
+    CompareOp compareOp;
+    uint32_t reference;
+    uint32_t compareMask;
+
+    bool operator==(const StencilFunc&) const noexcept = default;
+  };
+
+  struct BlendEquation
+  {
+    BlendFactor srcColorBlendFactor;
+    BlendFactor dstColorBlendFactor;
+    BlendFactor srcAlphaBlendFactor;
+    BlendFactor dstAlphaBlendFactor;
+    BlendOp colorBlendOp;
+    BlendOp alphaBlendOp;
+
+    bool operator==(const BlendEquation&) const noexcept = default;
+  };
+
+  // Shadow copy of the fixed-function state that was last applied by BindGraphicsPipeline.
+  // Empty optionals mean the state is unknown and must be applied on the next bind.
+  struct AppliedGraphicsState
+  {
+    std::optional<bool> primitiveRestartEnable;
+    std::optional<uint32_t> patchControlPoints;
+
+    std::optional<bool> depthClampEnable;
+    std::optional<PolygonMode> polygonMode;
+    std::optional<CullMode> cullMode;
+    std::optional<FrontFace> frontFace;
+    std::optional<bool> depthBiasEnable;
+    std::optional<std::array<float, 2>> depthBiasFactors; // slope, constant
+    std::optional<float> lineWidth;
+    std::optional<float> pointSize;
+
+    std::optional<bool> sampleShadingEnable;
+    std::optional<float> minSampleShading;
+    std::optional<uint32_t> sampleMask;
+    std::optional<bool> alphaToCoverageEnable;
+    std::optional<bool> alphaToOneEnable;
+
+    std::optional<bool> depthTestEnable;
+    std::optional<CompareOp> depthCompareOp;
+    std::optional<bool> stencilTestEnable;
+    std::array<std::optional<StencilOps>, 2> stencilOps;     // front, back
+    std::array<std::optional<StencilFunc>, 2> stencilFuncs; // front, back
+
+    std::optional<bool> logicOpEnable;
+    std::optional<LogicOp> logicOp;
+    std::optional<std::array<float, 4>> blendConstants;
+    std::optional<bool> blendEnable;
+    std::array<std::optional<BlendEquation>, MAX_COLOR_ATTACHMENTS> blendEquations;
+  };
+
+  struct VertexBufferBinding
+  {
+    GLuint buffer;
+    uint64_t offset;
+    uint64_t stride;
+  };
+
+  struct BufferRangeBinding
+  {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+
+    bool operator==(const BufferRangeBinding&) const noexcept = default;
+  };
+
+  struct SampledImageBinding
+  {
+    GLuint texture;
+    GLuint sampler;
+
+    bool operator==(const SampledImageBinding&) const noexcept = default;
+  };
+
+  struct ImageBinding
+  {
+    GLuint texture;
+    GLint level;
+    ShaderAccess access;
+
+    bool operator==(const ImageBinding&) const noexcept = default;
+  };
+
+  // Shadow copy of the resource bindings made by the Cmd::Bind* functions, by slot. Empty optionals and slots past the
+  // end are unknown. Used by Cmd::BindGroup to skip slots that already hold the same binding.
+  struct AppliedResourceBindings
+  {
+    std::vector<std::optional<BufferRangeBinding>> uniformBuffers;
+    std::vector<std::optional<BufferRangeBinding>> storageBuffers;
+    std::vector<std::optional<SampledImageBinding>> sampledImages;
+    std::vector<std::optional<ImageBinding>> images;
+
+    // Must be called whenever bindings change behind the shadow's back. Deleting a buffer or texture unbinds it, and
+    // its name may be reused by a new object
+    void Reset()
+    {
+      uniformBuffers.clear();
+      storageBuffers.clear();
+      sampledImages.clear();
+      images.clear();
+    }
+  };
+
+  // A resource that the next draw or dispatch may access. Resources are identified by their buffer handle, or by the
+  // handle of the texture whose memory they use shifted left by 32 bits, so that texture views alias their texture
+  struct TrackedBinding
+  {
+    uint64_t resource;
+    bool isWrite;
+  };
+
+  // Shader writes to images and storage buffers are incoherent, so commands that later access the written memory need a
+  // barrier. Every draw and dispatch is given a serial. The tracker remembers the serial of the last command that wrote
+  // each resource and, for each barrier bit, the serial of the last command whose writes a barrier with that bit made
+  // visible. Barriers by region only make writes visible within the rendering scope they were issued in, so they are
+  // tracked separately.
+  struct HazardTrackerState
+  {
+    // Resources bound in the current scope, by slot
+    std::vector<std::optional<TrackedBinding>> uniformBuffers;
+    std::vector<std::optional<TrackedBinding>> storageBuffers;
+    std::vector<std::optional<TrackedBinding>> sampledImages;
+    std::vector<std::optional<TrackedBinding>> images;
+    std::vector<std::optional<TrackedBinding>> vertexBuffers;
+    std::optional<TrackedBinding> indexBuffer;
+
+    std::unordered_map<uint64_t, uint64_t> lastWrites;
+    std::array<uint64_t, 32> lastBarriers{};       // Indexed by the position of a MemoryBarrierBit
+    std::array<uint64_t, 32> lastRegionBarriers{}; // Indexed by the position of a MemoryBarrierBit
+    uint64_t commandSerial = 0;
+    uint64_t renderScopeBeginSerial = 0;
+
+    // Maps the handle of each texture view to the handle of the texture whose memory it uses
+    std::unordered_map<GLuint, GLuint> viewStorage;
+
+    HazardTrackingStatistics statistics;
+
+    // Called at the start of every scope, as Fwog doesn't guarantee that bindings persist between scopes. Writes stay
+    // tracked
+    void ResetBindings()
+    {
+      uniformBuffers.clear();
+      storageBuffers.clear();
+      sampledImages.clear();
+      images.clear();
+      vertexBuffers.clear();
+      indexBuffer.reset();
+    }
+  };
+
+  // Consecutive indexed draws that are recorded while batching is enabled. They are issued with a single
+  // glMultiDrawElementsIndirect when a command that could affect them is recorded.
+  struct DrawBatchState
+  {
+    std::vector<DrawIndexedIndirectCommand> commands;
+
+    // Vertex buffer bindings in the current vertex array, by binding index. Draws in the batch are relative to these
+    std::vector<std::optional<VertexBufferBinding>> appliedVertexBuffers;
+
+    // Rebinds of an applied buffer at a different offset, which are deferred while the batch is open and folded into
+    // the vertex offset of subsequent draws instead
+    std::vector<std::pair<uint32_t, VertexBufferBinding>> pendingVertexBuffers;
+
+    GLuint appliedIndexBuffer = 0;
+
+    // Indirect commands are streamed through this buffer
+    std::optional<Buffer> indirectBuffer;
+    uint64_t indirectBufferHead = 0;
+
+    // Set while the batch is being issued, so that anything FlushDrawBatch calls that flushes the batch does nothing
+    bool isFlushing = false;
+  };
+
+  // OpenGL names whose destruction was deferred, sorted by the frame they were released in. Names aren't reused until
+  // they are deleted, so caches and shadowed bindings that refer to them stay valid until then and are updated in one
+  // pass per frame
+  struct DeferredDestructionState
+  {
+    struct Frame
+    {
+      std::vector<GLuint> textures;
+      std::vector<GLuint> buffers;
+      std::vector<GLuint> programs;
+    };
+
+    // Holds one more frame than the delay, so the frame that is destroyed is reused for the next frame's releases
+    std::vector<Frame> frames;
+    uint64_t frameIndex = 0;
+
+    [[nodiscard]] bool IsEnabled() const noexcept
+    {
+      return !frames.empty();
+    }
+
+    [[nodiscard]] Frame& CurrentFrame()
+    {
+      return frames[frameIndex % frames.size()];
+    }
+  };
 
   struct ContextState
   {
     DeviceProperties properties;
 
     void (*verboseMessageCallback)(std::string_view) = nullptr;
-    void (*renderToSwapchainHook)(const SwapchainRenderInfo& renderInfo, const std::function<void()>& func) = nullptr;
-    void (*renderHook)(const RenderInfo& renderInfo, const std::function<void()>& func) = nullptr;
-    void (*renderNoAttachmentsHook)(const RenderNoAttachmentsInfo& renderInfo, const std::function<void()>& func) = nullptr;
-    void (*computeHook)(std::string_view name, const std::function<void()>& func) = nullptr;
+    void (*renderToSwapchainHook)(const SwapchainRenderInfo& renderInfo, FunctionRef<void()> func) = nullptr;
+    void (*renderHook)(const RenderInfo& renderInfo, FunctionRef<void()> func) = nullptr;
+    void (*renderNoAttachmentsHook)(const RenderNoAttachmentsInfo& renderInfo, FunctionRef<void()> func) = nullptr;
+    void (*computeHook)(std::string_view name, FunctionRef<void()> func) = nullptr;
+
+    // Declared before every member that owns OpenGL objects, as their destructors check whether it is enabled
+    DeferredDestructionState deferredDestruction{};
+
+    // Reference counts of resident bindless texture handles. A texture and sampler always produce the same handle, and
+    // making it non-resident affects every user of it, so residency is shared by all bindless tables and textures
+    std::unordered_map<uint64_t, uint32_t> residentTextureHandles;
 
     // Used for scope error checking
     bool isComputeActive = false;
@@ -43,18 +281,30 @@ namespace Fwog::detail
     // True when a pipeline with a name is bound during a render or compute scope.
     bool isPipelineDebugGroupPushed = false;
 
+    // The profiler recording the current frame, if any. Named scopes and pipelines open zones in it
+    GpuProfiler* activeProfiler = nullptr;
+    bool isProfilingPipelines = false;
+    bool isScopedZoneOpen = false;
+    bool isPipelineZoneOpen = false;
+
     // True during SwapchainRendering scopes that disable sRGB.
     // This is needed since regular Rendering scopes always have framebuffer sRGB enabled
     // (the user uses framebuffer attachments to decide if they want the linear->sRGB conversion).
     bool srgbWasDisabled = false;
 
-    // Stores a pointer to the previously bound graphics pipeline state. This is used for state deduplication.
-    // A shared_ptr is needed as the user can delete pipelines at any time, but we need to ensure it stays alive until
-    // the next pipeline is bound.
-    std::shared_ptr<const detail::GraphicsPipelineInfoOwning> lastGraphicsPipeline{};
+    // Fixed-function state applied by the last graphics pipeline bind. Cleared by InvalidatePipelineState.
+    AppliedGraphicsState appliedGraphicsState{};
+    PipelineStateStatistics pipelineStateStatistics{};
+
+    // Stores a pointer to the previously bound graphics pipeline state. This is used to skip rebinding the program.
+    // The user can delete pipelines at any time, so if the last bound pipeline is destroyed, its state is moved into
+    // retiredGraphicsPipeline to keep it alive until the next pipeline is bound.
+    const detail::GraphicsPipelineInfoOwning* lastGraphicsPipeline{};
+    std::unique_ptr<const detail::GraphicsPipelineInfoOwning> retiredGraphicsPipeline{};
     bool lastPipelineWasCompute = false;
 
-    std::shared_ptr<const detail::ComputePipelineInfoOwning> lastComputePipeline{};
+    const detail::ComputePipelineInfoOwning* lastComputePipeline{};
+    std::unique_ptr<const detail::ComputePipelineInfoOwning> retiredComputePipeline{};
 
     // Currently unused (and probably shouldn't be used)
     const RenderInfo* lastRenderInfo{};
@@ -72,6 +322,28 @@ namespace Fwog::detail
     GLuint currentVao = 0;
     GLuint currentFbo = 0;
 
+    // Declared before pushConstantRing and drawBatch, as the buffers they own forget their writes when destroyed
+    bool isHazardTrackingEnabled = false;
+    bool useRegionBarriers = false;
+    HazardTrackerState hazardTracker{};
+
+    // Declared before drawBatch, as the batch's buffer resets the shadow when it is destroyed
+    AppliedResourceBindings appliedResourceBindings{};
+
+    // Cmd::PushConstants writes the whole block to the ring on each call. pushConstants holds the block's current
+    // contents so that partial updates preserve the rest. The ring is created on first use. A fence is inserted at the
+    // end of every scope that pushed constants, and whenever a scope has used a quarter of the ring, so that the ring
+    // can be reused without waiting for the end of the frame
+    std::vector<std::byte> pushConstants;
+    std::optional<UploadRing> pushConstantRing;
+    uint64_t pushConstantBytesSinceFence = 0;
+
+    bool isDrawBatchingEnabled = false;
+    DrawBatchState drawBatch{};
+
+    // Empty if the program binary cache is disabled
+    std::string programCacheDirectory;
+
     // These persist until another Pipeline is bound.
     // They are not used for state deduplication, as they are arguments for GL draw calls.
     PrimitiveTopology currentTopology{};
@@ -87,6 +359,18 @@ namespace Fwog::detail
   // or when the pipeline state has been invalidated, but only in debug mode.
   void ZeroResourceBindings();
 
+  // Issues any batched draws and applies deferred vertex buffer bindings. Does nothing if no draws are batched
+  void FlushDrawBatch();
+
+  // Deletes the objects in a frame of deferredDestruction and removes every reference to them from the context
+  void DestroyDeferredFrame(DeferredDestructionState::Frame& frame);
+
+  // Adds a reference to a bindless texture handle, making it resident if it had none
+  void AcquireResidentTextureHandle(uint64_t handle);
+
+  // Removes a reference to a bindless texture handle, making it non-resident when no references remain
+  void ReleaseResidentTextureHandle(uint64_t handle);
+
   // Prints a formatted message to a stringstream, then
   // invokes the message callback with the formatted message
   template<class... Args>
@@ -2,12 +2,17 @@
 #include "Fwog/Rendering.h"
 #include "Fwog/Texture.h"
 
+#include <array>
 #include <cstdint>
-#include <vector>
 #include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
 
 namespace Fwog::detail
 {
+  constexpr int MAX_COLOR_ATTACHMENTS = 8;
+
   struct TextureProxy
   {
     TextureCreateInfo createInfo;
@@ -16,15 +21,26 @@ namespace Fwog::detail
     bool operator==(const TextureProxy&) const noexcept = default;
   };
 
+  // Fixed-capacity so that building a key for a lookup does not allocate
   struct RenderAttachments
   {
-    std::vector<TextureProxy> colorAttachments{};
+    std::array<TextureProxy, MAX_COLOR_ATTACHMENTS> colorAttachments{};
+    uint32_t colorAttachmentCount{};
     std::optional<TextureProxy> depthAttachment{};
     std::optional<TextureProxy> stencilAttachment{};
 
     bool operator==(const RenderAttachments& rhs) const;
   };
+} // namespace Fwog::detail
+
+template<>
+struct std::hash<Fwog::detail::RenderAttachments>
+{
+  std::size_t operator()(const Fwog::detail::RenderAttachments& k) const noexcept;
+};
 
+namespace Fwog::detail
+{
   class FramebufferCache
   {
   public:
@@ -38,7 +54,7 @@ namespace Fwog::detail
 
     [[nodiscard]] std::size_t Size() const
     {
-      return framebufferCacheKey_.size();
+      return framebufferCache_.size();
     }
 
     void Clear();
@@ -50,8 +66,18 @@ namespace Fwog::detail
 
     void RemoveTexture(const Texture& texture);
 
+    // Removes the framebuffers that reference any of the textures
+    void RemoveTextures(std::span<const uint32_t> textureHandles);
+
   private:
-    std::vector<RenderAttachments> framebufferCacheKey_;
-    std::vector<uint32_t> framebufferCacheValue_;
+    // Unlinks the framebuffers that reference a texture and appends them to deadFramebuffers
+    void RemoveTextureFramebuffers(uint32_t textureHandle, std::vector<uint32_t>& deadFramebuffers);
+
+    std::unordered_map<RenderAttachments, uint32_t> framebufferCache_;
+
+    // Reverse lookups so texture destruction only touches the framebuffers that reference the texture.
+    // Pointers refer to keys in framebufferCache_, which are stable until their element is erased.
+    std::unordered_map<uint32_t, const RenderAttachments*> framebufferAttachments_;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> textureFramebuffers_;
   };
 } // namespace Fwog::detail
@@ -1,5 +1,8 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <span>
 #include <tuple>
 
 namespace Fwog::detail::hashing
@@ -7,6 +10,19 @@ namespace Fwog::detail::hashing
   template<typename T>
   struct hash;
 
+  inline constexpr uint64_t fnv1aOffsetBasis = 14695981039346656037ull;
+
+  // 64-bit FNV-1a. Pass a previous result as the seed to hash several ranges as if they were one
+  inline uint64_t fnv1a(std::span<const std::byte> data, uint64_t seed = fnv1aOffsetBasis)
+  {
+    for (auto byte : data)
+    {
+      seed ^= static_cast<uint64_t>(byte);
+      seed *= 1099511628211ull;
+    }
+    return seed;
+  }
+
   template<class T>
   inline void hash_combine(std::size_t& seed, const T& v)
   {
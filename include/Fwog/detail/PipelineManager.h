@@ -1,7 +1,10 @@
 #pragma once
 #include <Fwog/Pipeline.h>
+#include <Fwog/detail/ProgramCache.h>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Fwog::detail
@@ -23,8 +26,10 @@ namespace Fwog::detail
   struct GraphicsPipelineInfoOwning
   {
     std::string name;
+    uint32_t program;
     InputAssemblyState inputAssemblyState;
     VertexInputStateOwning vertexInputState;
+    uint32_t vertexArray; // Resolved from vertexInputState when the pipeline is created
     TessellationState tessellationState;
     RasterizationState rasterizationState;
     MultisampleState multisampleState;
@@ -34,22 +39,58 @@ namespace Fwog::detail
     std::vector<std::pair<std::string, uint32_t>> uniformBlocks;
     std::vector<std::pair<std::string, uint32_t>> storageBlocks;
     std::vector<std::pair<std::string, uint32_t>> samplersAndImages;
+    uint32_t pushConstantSize;
   };
 
   struct ComputePipelineInfoOwning
   {
     std::string name;
+    uint32_t program;
     Extent3D workgroupSize;
     std::vector<std::pair<std::string, uint32_t>> uniformBlocks;
     std::vector<std::pair<std::string, uint32_t>> storageBlocks;
     std::vector<std::pair<std::string, uint32_t>> samplersAndImages;
+    uint32_t pushConstantSize;
   };
 
+  // A program that was loaded from the cache, or whose link has been started but not waited on
+  struct PendingProgram
+  {
+    uint32_t program{};
+    uint64_t cacheKey{};
+    bool isCached{}; // If true, the program is already linked and reflection is populated
+    ProgramReflection reflection;
+  };
+
+  struct PendingGraphicsPipeline
+  {
+    PendingProgram program;
+    GraphicsPipelineInfoOwning info;
+  };
+
+  struct PendingComputePipeline
+  {
+    PendingProgram program;
+    ComputePipelineInfoOwning info;
+  };
+
+  // Reflected tables are sorted by name
+  std::optional<uint32_t> FindReflectedBinding(const std::vector<std::pair<std::string, uint32_t>>& bindings,
+                                               std::string_view name);
+
+  // Pipelines are referred to by handles that encode a slot index and generation.
+  // Get*Internal returns null for handles whose pipeline has been destroyed.
+  // Begin*Internal starts linking without waiting for it. Finish*Internal waits, then reflects and registers the
+  // pipeline. Compile*Internal does both
+  std::unique_ptr<PendingGraphicsPipeline> BeginGraphicsPipelineInternal(const GraphicsPipelineInfo& info);
+  uint64_t FinishGraphicsPipelineInternal(std::unique_ptr<PendingGraphicsPipeline> pending);
   uint64_t CompileGraphicsPipelineInternal(const GraphicsPipelineInfo& info);
-  std::shared_ptr<const GraphicsPipelineInfoOwning> GetGraphicsPipelineInternal(uint64_t pipeline);
+  const GraphicsPipelineInfoOwning* GetGraphicsPipelineInternal(uint64_t pipeline);
   void DestroyGraphicsPipelineInternal(uint64_t pipeline);
 
+  std::unique_ptr<PendingComputePipeline> BeginComputePipelineInternal(const ComputePipelineInfo& info);
+  uint64_t FinishComputePipelineInternal(std::unique_ptr<PendingComputePipeline> pending);
   uint64_t CompileComputePipelineInternal(const ComputePipelineInfo& info);
-  std::shared_ptr<const ComputePipelineInfoOwning> GetComputePipelineInternal(uint64_t pipeline);
+  const ComputePipelineInfoOwning* GetComputePipelineInternal(uint64_t pipeline);
   void DestroyComputePipelineInternal(uint64_t pipeline);
 } // namespace Fwog::detail
\ No newline at end of file
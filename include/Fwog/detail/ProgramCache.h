@@ -0,0 +1,41 @@
+#pragma once
+#include <Fwog/BasicTypes.h>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Fwog
+{
+  class Shader;
+}
+
+namespace Fwog::detail
+{
+  struct ProgramReflection
+  {
+    std::vector<std::pair<std::string, uint32_t>> uniformBlocks;
+    std::vector<std::pair<std::string, uint32_t>> storageBlocks;
+    std::vector<std::pair<std::string, uint32_t>> samplersAndImages;
+    Extent3D workgroupSize{};
+
+    // Size of the uniform block at PUSH_CONSTANT_BINDING, or 0 if the program has none
+    uint32_t pushConstantSize{};
+  };
+
+  // Combines the source hashes of a program's shaders with the vendor, renderer, and version of the driver, so that
+  // binaries produced by a different driver are never loaded
+  uint64_t ComputeProgramCacheKey(std::span<const Shader* const> shaders);
+
+  // Creates a program from a cached binary. Returns 0 if the entry is missing or malformed, or if the driver rejects
+  // the binary, in which case the program should be linked from its shaders and stored again
+  uint32_t LoadCachedProgram(uint64_t key, ProgramReflection& reflection);
+
+  // Must be called before linking a program that will be stored
+  void PrepareProgramForCache(uint32_t program);
+
+  // Writes a linked program's binary and reflection data to the cache directory. Failures are ignored
+  void StoreCachedProgram(uint64_t key, uint32_t program, const ProgramReflection& reflection);
+} // namespace Fwog::detail
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+
+namespace Fwog::detail
+{
+  // Best-fit allocator of ranges of elements, independent of any buffer. Adjacent free blocks are merged
+  class RangeAllocator
+  {
+  public:
+    explicit RangeAllocator(uint64_t capacity);
+
+    [[nodiscard]] std::optional<uint64_t> Allocate(uint64_t size);
+    void Free(uint64_t offset, uint64_t size);
+
+    // Adds space to the end of the range
+    void Grow(uint64_t newCapacity);
+
+    // Marks [0, usedSize) as allocated and the rest as free
+    void Reset(uint64_t usedSize);
+
+    [[nodiscard]] uint64_t Capacity() const noexcept
+    {
+      return capacity_;
+    }
+
+    [[nodiscard]] uint64_t FreeSize() const noexcept
+    {
+      return freeSize_;
+    }
+
+    [[nodiscard]] uint64_t FreeBlockCount() const noexcept
+    {
+      return freeBlocks_.size();
+    }
+
+    [[nodiscard]] uint64_t LargestFreeBlock() const noexcept;
+
+    // The size of the free block that ends at the end of the range, which growing extends
+    [[nodiscard]] uint64_t TrailingFreeSize() const noexcept;
+
+    [[nodiscard]] bool IsCompact() const noexcept;
+
+  private:
+    uint64_t capacity_;
+    uint64_t freeSize_;
+
+    // Offset -> size
+    std::map<uint64_t, uint64_t> freeBlocks_;
+  };
+} // namespace Fwog::detail
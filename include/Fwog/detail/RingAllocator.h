@@ -0,0 +1,131 @@
+#pragma once
+#include <Fwog/Config.h>
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+namespace Fwog::detail
+{
+  // Byte accounting for UploadRing, independent of any buffer. Allocations are made from a head that wraps around to
+  // the start of the range, and frames of allocations are retired in order by waiting on the fence they were ended
+  // with. FenceT must be movable and have a Wait() member that blocks until the frame's memory is no longer in use
+  template<typename FenceT>
+  class RingAllocator
+  {
+  public:
+    explicit RingAllocator(uint64_t capacity) : capacity_(capacity) {}
+
+    // Returns the offset of a contiguous range of the given size, waiting on the fences of old frames as needed
+    [[nodiscard]] uint64_t Allocate(uint64_t size, uint64_t alignment)
+    {
+      FWOG_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+      FWOG_ASSERT(size > 0 && size <= capacity_);
+
+      // Nothing is in flight, so the next allocation can start at the beginning of the range
+      if (bytesInUse_ == 0)
+      {
+        head_ = 0;
+      }
+
+      uint64_t offset = AlignUp(head_, alignment);
+      uint64_t consumed = offset - head_ + size;
+
+      // Allocations must be contiguous, so skip the remainder of the range if the allocation doesn't fit at the end
+      if (offset + size > capacity_)
+      {
+        offset = 0;
+        consumed = capacity_ - head_ + size;
+
+        // The skipped remainder and the allocation don't fit in the ring together. The allocation can only be made at
+        // the start once everything in flight has been retired, after which the remainder doesn't need to be skipped
+        if (consumed > capacity_)
+        {
+          while (!frames_.empty())
+          {
+            RetireOldestFrame();
+          }
+
+          // Allocations of the current frame haven't been fenced, so they can't be waited for
+          FWOG_ASSERT(bytesInUse_ == 0 && "UploadRing is too small for a frame's allocations");
+          consumed = size;
+        }
+      }
+
+      WaitForSpace(consumed);
+
+      head_ = offset + size;
+      bytesInUse_ += consumed;
+      currentFrameSize_ += consumed;
+      return offset;
+    }
+
+    // Ends the current frame. Its memory is reused after fence.Wait() returns
+    void EndFrame(FenceT fence)
+    {
+      frames_.push_back(FrameRegion{.size = std::exchange(currentFrameSize_, 0), .fence = std::move(fence)});
+    }
+
+    [[nodiscard]] uint64_t Capacity() const noexcept
+    {
+      return capacity_;
+    }
+
+    [[nodiscard]] uint64_t BytesInUse() const noexcept
+    {
+      return bytesInUse_;
+    }
+
+    [[nodiscard]] uint64_t CurrentFrameSize() const noexcept
+    {
+      return currentFrameSize_;
+    }
+
+    [[nodiscard]] uint64_t FramesInFlight() const noexcept
+    {
+      return frames_.size();
+    }
+
+  private:
+    static constexpr uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+      return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Retires frames until there is room for a contiguous allocation of the given size
+    void WaitForSpace(uint64_t size)
+    {
+      while (capacity_ - bytesInUse_ < size)
+      {
+        // If this fails, a single frame has allocated more than the ring can hold
+        FWOG_ASSERT(!frames_.empty() && "UploadRing is too small for a frame's allocations");
+        if (frames_.empty())
+        {
+          return;
+        }
+
+        RetireOldestFrame();
+      }
+    }
+
+    // Waits for the oldest fenced frame and makes its memory available
+    void RetireOldestFrame()
+    {
+      frames_.front().fence.Wait();
+      bytesInUse_ -= frames_.front().size;
+      frames_.pop_front();
+    }
+
+    struct FrameRegion
+    {
+      uint64_t size;
+      FenceT fence;
+    };
+
+    uint64_t capacity_;
+    uint64_t head_{};
+    uint64_t bytesInUse_{};
+    uint64_t currentFrameSize_{};
+    std::deque<FrameRegion> frames_;
+  };
+} // namespace Fwog::detail
@@ -1,7 +1,10 @@
 #pragma once
+#include <Fwog/Pipeline.h>
+
 #include <cstddef>
 #include <cstdint>
 #include <unordered_map>
+#include <vector>
 
 namespace Fwog::detail
 {
@@ -21,6 +24,7 @@ namespace Fwog::detail
       Clear();
     }
 
+    // Intended to be called once per pipeline at creation time, not when binding
     uint32_t CreateOrGetCachedVertexArray(const VertexInputStateOwning& inputState);
 
     [[nodiscard]] size_t Size() const
@@ -31,6 +35,23 @@ namespace Fwog::detail
     void Clear();
 
   private:
-    std::unordered_map<size_t, uint32_t> vertexArrayCache_;
+    // The full (canonicalized) layout is stored so that hash collisions cannot alias distinct layouts
+    struct VertexArrayKey
+    {
+      uint64_t hash;
+      std::vector<VertexInputBindingDescription> vertexBindingDescriptions;
+
+      bool operator==(const VertexArrayKey&) const noexcept = default;
+    };
+
+    struct VertexArrayKeyHash
+    {
+      size_t operator()(const VertexArrayKey& k) const noexcept
+      {
+        return static_cast<size_t>(k.hash);
+      }
+    };
+
+    std::unordered_map<VertexArrayKey, uint32_t, VertexArrayKeyHash> vertexArrayCache_;
   };
 } // namespace Fwog::detail
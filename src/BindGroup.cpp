@@ -0,0 +1,71 @@
+#include <Fwog/BindGroup.h>
+#include <Fwog/Buffer.h>
+#include <Fwog/detail/ApiToEnum.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace Fwog
+{
+  namespace
+  {
+    // Returns the order in which entries should be stored so that their indices are ascending
+    template<typename Entry>
+    std::vector<size_t> SortByIndex(std::span<const Entry> entries)
+    {
+      auto order = std::vector<size_t>(entries.size());
+      std::iota(order.begin(), order.end(), size_t{0});
+      std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return entries[a].index < entries[b].index; });
+
+      for (size_t i = 1; i < order.size(); i++)
+      {
+        FWOG_ASSERT(entries[order[i - 1]].index != entries[order[i]].index && "Indices must be unique");
+      }
+
+      return order;
+    }
+  } // namespace
+
+  BindGroup::BindGroup(const BindGroupCreateInfo& createInfo)
+    : uniformBuffers_(MakeBufferBindings(createInfo.uniformBuffers)),
+      storageBuffers_(MakeBufferBindings(createInfo.storageBuffers))
+  {
+    for (auto i : SortByIndex(createInfo.sampledImages))
+    {
+      const auto& entry = createInfo.sampledImages[i];
+      sampledImages_.indices.push_back(entry.index);
+      sampledImages_.textures.push_back(detail::GetHandle(entry.texture.get()));
+      sampledImages_.samplers.push_back(entry.sampler.Handle());
+    }
+
+    for (auto i : SortByIndex(createInfo.images))
+    {
+      const auto& entry = createInfo.images[i];
+      FWOG_ASSERT(entry.level < entry.texture.get().GetCreateInfo().mipLevels);
+      images_.indices.push_back(entry.index);
+      images_.textures.push_back(detail::GetHandle(entry.texture.get()));
+      images_.levels.push_back(entry.level);
+      images_.formats.push_back(static_cast<uint32_t>(detail::FormatToGL(entry.texture.get().GetCreateInfo().format)));
+      images_.accesses.push_back(entry.access);
+    }
+  }
+
+  BindGroup::BufferBindings BindGroup::MakeBufferBindings(std::span<const BindGroupBuffer> entries)
+  {
+    auto bindings = BufferBindings{};
+    for (auto i : SortByIndex(entries))
+    {
+      const auto& entry = entries[i];
+      const auto& buffer = entry.buffer.get();
+      const auto size = entry.size == WHOLE_BUFFER ? buffer.Size() - entry.offset : entry.size;
+      FWOG_ASSERT(entry.offset + size <= buffer.Size());
+
+      bindings.indices.push_back(entry.index);
+      bindings.buffers.push_back(buffer.Handle());
+      bindings.offsets.push_back(static_cast<intptr_t>(entry.offset));
+      bindings.sizes.push_back(static_cast<intptr_t>(size));
+      bindings.accesses.push_back(entry.access);
+    }
+    return bindings;
+  }
+} // namespace Fwog
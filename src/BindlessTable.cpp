@@ -0,0 +1,237 @@
+#include <Fwog/BindlessTable.h>
+#include <Fwog/Context.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/detail/ContextState.h>
+
+#include <algorithm>
+#include <span>
+#include <tuple>
+#include <utility>
+
+#include FWOG_OPENGL_HEADER
+
+namespace Fwog
+{
+  namespace
+  {
+    constexpr uint32_t initialFallbackLayers = 8;
+
+    uint64_t MakeKey(const Texture& texture, const Sampler& sampler)
+    {
+      return (static_cast<uint64_t>(detail::GetHandle(texture)) << 32) | sampler.Handle();
+    }
+  } // namespace
+
+  BindlessTable::BindlessTable(uint32_t initialCapacity, std::string_view name)
+    : name_(name),
+      isBindless_(GetDeviceProperties().features.bindlessTextures),
+      buffer_(std::max(initialCapacity, 1u) * sizeof(uint64_t), BufferStorageFlag::DYNAMIC_STORAGE, name)
+  {
+    slots_.reserve(std::max(initialCapacity, 1u));
+  }
+
+  BindlessTable::~BindlessTable()
+  {
+    if (!isBindless_)
+    {
+      return;
+    }
+
+    for (size_t i = 0; i < entries_.size(); i++)
+    {
+      if (entries_[i].refCount > 0)
+      {
+        detail::ReleaseResidentTextureHandle(slots_[i]);
+      }
+    }
+  }
+
+  uint32_t BindlessTable::Acquire(const Texture& texture, const SamplerState& samplerState)
+  {
+    auto sampler = Sampler(samplerState);
+    const auto key = MakeKey(texture, sampler);
+
+    if (auto it = keyToIndex_.find(key); it != keyToIndex_.end())
+    {
+      entries_[it->second].refCount++;
+      return it->second;
+    }
+
+    uint32_t index{};
+    if (!freeIndices_.empty())
+    {
+      index = freeIndices_.back();
+      freeIndices_.pop_back();
+    }
+    else
+    {
+      index = static_cast<uint32_t>(entries_.size());
+      entries_.emplace_back();
+      slots_.emplace_back();
+      if (slots_.size() * sizeof(uint64_t) > buffer_.Size())
+      {
+        needsReallocation_ = true;
+      }
+    }
+
+    auto& entry = entries_[index];
+    entry = {.key = key, .refCount = 1, .fallbackGroup = 0, .fallbackLayer = 0};
+
+    if (isBindless_)
+    {
+      // The same texture and sampler always produce the same handle, so other tables or the texture itself may have
+      // made it resident already. Residency is reference counted by the context
+      const auto handle = glGetTextureSamplerHandleARB(detail::GetHandle(texture), sampler.Handle());
+      FWOG_ASSERT(handle != 0 && "Failed to create texture sampler handle.");
+      detail::AcquireResidentTextureHandle(handle);
+      slots_[index] = handle;
+    }
+    else
+    {
+      std::tie(entry.fallbackGroup, entry.fallbackLayer) = AllocateFallbackLayer(texture, samplerState);
+      slots_[index] = (static_cast<uint64_t>(entry.fallbackGroup) << 32) | entry.fallbackLayer;
+    }
+
+    keyToIndex_.emplace(key, index);
+    MarkDirty(index);
+    return index;
+  }
+
+  void BindlessTable::Release(uint32_t index)
+  {
+    FWOG_ASSERT(index < entries_.size() && entries_[index].refCount > 0);
+    auto& entry = entries_[index];
+    if (--entry.refCount > 0)
+    {
+      return;
+    }
+
+    if (isBindless_)
+    {
+      detail::ReleaseResidentTextureHandle(slots_[index]);
+    }
+    else
+    {
+      auto& group = fallbackGroups_[entry.fallbackGroup];
+      group.freeLayers.push_back(entry.fallbackLayer);
+    }
+
+    keyToIndex_.erase(entry.key);
+    freeIndices_.push_back(index);
+
+    // Freed slots are zeroed so stale indices read a null handle instead of a handle that is no longer resident
+    slots_[index] = 0;
+    MarkDirty(index);
+  }
+
+  void BindlessTable::Update()
+  {
+    if (needsReallocation_)
+    {
+      // Grow geometrically so that acquiring many pairs doesn't reallocate every frame
+      auto newSize = std::max(buffer_.Size() * 2, slots_.size() * sizeof(uint64_t));
+      buffer_ = Buffer(newSize, BufferStorageFlag::DYNAMIC_STORAGE, name_);
+      buffer_.UpdateData(std::span<const uint64_t>(slots_));
+      needsReallocation_ = false;
+    }
+    else if (dirtyBegin_ < dirtyEnd_)
+    {
+      buffer_.UpdateData(std::span<const uint64_t>(slots_).subspan(dirtyBegin_, dirtyEnd_ - dirtyBegin_),
+                         dirtyBegin_ * sizeof(uint64_t));
+    }
+
+    dirtyBegin_ = UINT32_MAX;
+    dirtyEnd_ = 0;
+  }
+
+  void BindlessTable::BindFallbackTextures(uint32_t firstUnit) const
+  {
+    for (uint32_t i = 0; i < fallbackGroups_.size(); i++)
+    {
+      const auto& group = fallbackGroups_[i];
+      Cmd::BindSampledImage(firstUnit + i, group.array, Sampler(group.samplerState));
+    }
+  }
+
+  void BindlessTable::MarkDirty(uint32_t index)
+  {
+    dirtyBegin_ = std::min(dirtyBegin_, index);
+    dirtyEnd_ = std::max(dirtyEnd_, index + 1);
+  }
+
+  std::pair<uint32_t, uint32_t> BindlessTable::AllocateFallbackLayer(const Texture& texture,
+                                                                     const SamplerState& samplerState)
+  {
+    const auto& createInfo = texture.GetCreateInfo();
+    FWOG_ASSERT(createInfo.imageType == ImageType::TEX_2D && "Only 2D textures can be added to a fallback table");
+
+    auto it = std::ranges::find_if(fallbackGroups_,
+                                   [&](const FallbackGroup& group)
+                                   { return group.layerInfo == createInfo && group.samplerState == samplerState; });
+
+    if (it == fallbackGroups_.end())
+    {
+      auto arrayInfo = createInfo;
+      arrayInfo.imageType = ImageType::TEX_2D_ARRAY;
+      arrayInfo.arrayLayers = initialFallbackLayers;
+      fallbackGroups_.emplace_back(FallbackGroup{
+        .layerInfo = createInfo,
+        .samplerState = samplerState,
+        .array = Texture(arrayInfo, name_),
+        .freeLayers = {},
+        .usedLayers = 0,
+      });
+      it = fallbackGroups_.end() - 1;
+    }
+
+    auto& group = *it;
+    const auto groupIndex = static_cast<uint32_t>(it - fallbackGroups_.begin());
+
+    uint32_t layer{};
+    if (!group.freeLayers.empty())
+    {
+      layer = group.freeLayers.back();
+      group.freeLayers.pop_back();
+    }
+    else
+    {
+      auto arrayInfo = group.array.GetCreateInfo();
+      if (group.usedLayers == arrayInfo.arrayLayers)
+      {
+        // Grow the array and copy existing layers into it
+        const auto oldLayers = arrayInfo.arrayLayers;
+        arrayInfo.arrayLayers *= 2;
+        auto newArray = Texture(arrayInfo, name_);
+        for (uint32_t level = 0; level < arrayInfo.mipLevels; level++)
+        {
+          CopyTexture({
+            .source = group.array,
+            .target = newArray,
+            .sourceLevel = level,
+            .targetLevel = level,
+            .extent = {std::max(arrayInfo.extent.width >> level, 1u),
+                       std::max(arrayInfo.extent.height >> level, 1u),
+                       oldLayers},
+          });
+        }
+        group.array = std::move(newArray);
+      }
+
+      layer = group.usedLayers++;
+    }
+
+    for (uint32_t level = 0; level < createInfo.mipLevels; level++)
+    {
+      CopyTexture({
+        .source = texture,
+        .target = group.array,
+        .sourceLevel = level,
+        .targetLevel = level,
+        .targetOffset = {0, 0, layer},
+        .extent = {std::max(createInfo.extent.width >> level, 1u), std::max(createInfo.extent.height >> level, 1u), 1},
+      });
+    }
+
+    return {groupIndex, layer};
+  }
+} // namespace Fwog
@@ -69,7 +69,16 @@ namespace Fwog
       {
         glUnmapNamedBuffer(id_);
       }
+
+      if (auto& deferredDestruction = detail::context->deferredDestruction; deferredDestruction.IsEnabled())
+      {
+        deferredDestruction.CurrentFrame().buffers.push_back(id_);
+        return;
+      }
+
       glDeleteBuffers(1, &id_);
+      detail::context->appliedResourceBindings.Reset();
+      detail::context->hazardTracker.lastWrites.erase(id_);
     }
   }
 
@@ -83,6 +92,7 @@ namespace Fwog
     FWOG_ASSERT((storageFlags_ & BufferStorageFlag::DYNAMIC_STORAGE) &&
                 "UpdateData can only be called on buffers created with the DYNAMIC_STORAGE flag");
     FWOG_ASSERT(size + offset <= Size());
+    detail::FlushDrawBatch();
     glNamedBufferSubData(id_, static_cast<GLuint>(offset), static_cast<GLuint>(size), data);
   }
 
@@ -90,6 +100,7 @@ namespace Fwog
   {
     const auto actualSize = clear.size == WHOLE_BUFFER ? size_ : clear.size;
     FWOG_ASSERT(actualSize % 4 == 0 && "Size must be a multiple of 4 bytes");
+    detail::FlushDrawBatch();
     glClearNamedBufferSubData(id_,
                               GL_R32UI,
                               clear.offset,
@@ -101,6 +112,7 @@ namespace Fwog
 
   void Buffer::Invalidate()
   {
+    detail::FlushDrawBatch();
     glInvalidateBufferData(id_);
   }
 } // namespace Fwog
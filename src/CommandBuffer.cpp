@@ -0,0 +1,279 @@
+#include <Fwog/CommandBuffer.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/detail/ContextState.h>
+
+namespace Fwog
+{
+  namespace
+  {
+    // Each overload forwards a recorded command to its immediate counterpart in the Cmd namespace
+    void Execute(const detail::Commands::BindGraphicsPipeline& c)
+    {
+      Cmd::BindGraphicsPipeline(*c.pipeline);
+    }
+
+    void Execute(const detail::Commands::BindComputePipeline& c)
+    {
+      Cmd::BindComputePipeline(*c.pipeline);
+    }
+
+    void Execute(const detail::Commands::SetViewport& c)
+    {
+      Cmd::SetViewport(c.viewport);
+    }
+
+    void Execute(const detail::Commands::SetScissor& c)
+    {
+      Cmd::SetScissor(c.scissor);
+    }
+
+    void Execute(const detail::Commands::BindVertexBuffer& c)
+    {
+      Cmd::BindVertexBuffer(c.bindingIndex, *c.buffer, c.offset, c.stride);
+    }
+
+    void Execute(const detail::Commands::BindIndexBuffer& c)
+    {
+      Cmd::BindIndexBuffer(*c.buffer, c.indexType);
+    }
+
+    void Execute(const detail::Commands::BindUniformBuffer& c)
+    {
+      Cmd::BindUniformBuffer(c.index, *c.buffer, c.offset, c.size);
+    }
+
+    void Execute(const detail::Commands::BindStorageBuffer& c)
+    {
+      Cmd::BindStorageBuffer(c.index, *c.buffer, c.offset, c.size, c.access);
+    }
+
+    void Execute(const detail::Commands::BindSampledImage& c)
+    {
+      Cmd::BindSampledImage(c.index, *c.texture, c.sampler);
+    }
+
+    void Execute(const detail::Commands::BindImage& c)
+    {
+      Cmd::BindImage(c.index, *c.texture, c.level, c.access);
+    }
+
+    void Execute(const detail::Commands::BindGroup& c)
+    {
+      Cmd::BindGroup(*c.group);
+    }
+
+    void Execute(const detail::Commands::Draw& c)
+    {
+      Cmd::Draw(c.vertexCount, c.instanceCount, c.firstVertex, c.firstInstance);
+    }
+
+    void Execute(const detail::Commands::DrawIndexed& c)
+    {
+      Cmd::DrawIndexed(c.indexCount, c.instanceCount, c.firstIndex, c.vertexOffset, c.firstInstance);
+    }
+
+    void Execute(const detail::Commands::DrawIndirect& c)
+    {
+      Cmd::DrawIndirect(*c.commandBuffer, c.commandBufferOffset, c.drawCount, c.stride);
+    }
+
+    void Execute(const detail::Commands::DrawIndirectCount& c)
+    {
+      Cmd::DrawIndirectCount(*c.commandBuffer,
+                             c.commandBufferOffset,
+                             *c.countBuffer,
+                             c.countBufferOffset,
+                             c.maxDrawCount,
+                             c.stride);
+    }
+
+    void Execute(const detail::Commands::DrawIndexedIndirect& c)
+    {
+      Cmd::DrawIndexedIndirect(*c.commandBuffer, c.commandBufferOffset, c.drawCount, c.stride);
+    }
+
+    void Execute(const detail::Commands::DrawIndexedIndirectCount& c)
+    {
+      Cmd::DrawIndexedIndirectCount(*c.commandBuffer,
+                                    c.commandBufferOffset,
+                                    *c.countBuffer,
+                                    c.countBufferOffset,
+                                    c.maxDrawCount,
+                                    c.stride);
+    }
+
+    void Execute(const detail::Commands::Dispatch& c)
+    {
+      Cmd::Dispatch(c.groupCount);
+    }
+
+    void Execute(const detail::Commands::DispatchInvocations& c)
+    {
+      Cmd::DispatchInvocations(c.invocationCount);
+    }
+
+    void Execute(const detail::Commands::DispatchIndirect& c)
+    {
+      Cmd::DispatchIndirect(*c.commandBuffer, c.commandBufferOffset);
+    }
+  } // namespace
+
+  void CommandBuffer::BindGraphicsPipeline(const GraphicsPipeline& pipeline)
+  {
+    commands_.emplace_back(detail::Commands::BindGraphicsPipeline{&pipeline});
+  }
+
+  void CommandBuffer::BindComputePipeline(const ComputePipeline& pipeline)
+  {
+    commands_.emplace_back(detail::Commands::BindComputePipeline{&pipeline});
+  }
+
+  void CommandBuffer::SetViewport(const Viewport& viewport)
+  {
+    commands_.emplace_back(detail::Commands::SetViewport{viewport});
+  }
+
+  void CommandBuffer::SetScissor(const Rect2D& scissor)
+  {
+    commands_.emplace_back(detail::Commands::SetScissor{scissor});
+  }
+
+  void CommandBuffer::BindVertexBuffer(uint32_t bindingIndex, const Buffer& buffer, uint64_t offset, uint64_t stride)
+  {
+    commands_.emplace_back(detail::Commands::BindVertexBuffer{bindingIndex, &buffer, offset, stride});
+  }
+
+  void CommandBuffer::BindIndexBuffer(const Buffer& buffer, IndexType indexType)
+  {
+    commands_.emplace_back(detail::Commands::BindIndexBuffer{&buffer, indexType});
+  }
+
+  void CommandBuffer::BindUniformBuffer(uint32_t index, const Buffer& buffer, uint64_t offset, uint64_t size)
+  {
+    commands_.emplace_back(detail::Commands::BindUniformBuffer{index, &buffer, offset, size});
+  }
+
+  void CommandBuffer::BindStorageBuffer(
+    uint32_t index, const Buffer& buffer, uint64_t offset, uint64_t size, ShaderAccess access)
+  {
+    commands_.emplace_back(detail::Commands::BindStorageBuffer{index, &buffer, offset, size, access});
+  }
+
+  void CommandBuffer::BindSampledImage(uint32_t index, const Texture& texture, const Sampler& sampler)
+  {
+    commands_.emplace_back(detail::Commands::BindSampledImage{index, &texture, sampler});
+  }
+
+  void CommandBuffer::BindImage(uint32_t index, const Texture& texture, uint32_t level, ShaderAccess access)
+  {
+    commands_.emplace_back(detail::Commands::BindImage{index, &texture, level, access});
+  }
+
+  void CommandBuffer::BindGroup(const Fwog::BindGroup& group)
+  {
+    commands_.emplace_back(detail::Commands::BindGroup{&group});
+  }
+
+  void CommandBuffer::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+  {
+    commands_.emplace_back(detail::Commands::Draw{vertexCount, instanceCount, firstVertex, firstInstance});
+  }
+
+  void CommandBuffer::DrawIndexed(uint32_t indexCount,
+                                  uint32_t instanceCount,
+                                  uint32_t firstIndex,
+                                  int32_t vertexOffset,
+                                  uint32_t firstInstance)
+  {
+    commands_.emplace_back(
+      detail::Commands::DrawIndexed{indexCount, instanceCount, firstIndex, vertexOffset, firstInstance});
+  }
+
+  void CommandBuffer::DrawIndirect(const Buffer& commandBuffer,
+                                   uint64_t commandBufferOffset,
+                                   uint32_t drawCount,
+                                   uint32_t stride)
+  {
+    commands_.emplace_back(detail::Commands::DrawIndirect{&commandBuffer, commandBufferOffset, drawCount, stride});
+  }
+
+  void CommandBuffer::DrawIndirectCount(const Buffer& commandBuffer,
+                                        uint64_t commandBufferOffset,
+                                        const Buffer& countBuffer,
+                                        uint64_t countBufferOffset,
+                                        uint32_t maxDrawCount,
+                                        uint32_t stride)
+  {
+    commands_.emplace_back(detail::Commands::DrawIndirectCount{
+      &commandBuffer,
+      commandBufferOffset,
+      &countBuffer,
+      countBufferOffset,
+      maxDrawCount,
+      stride,
+    });
+  }
+
+  void CommandBuffer::DrawIndexedIndirect(const Buffer& commandBuffer,
+                                          uint64_t commandBufferOffset,
+                                          uint32_t drawCount,
+                                          uint32_t stride)
+  {
+    commands_.emplace_back(
+      detail::Commands::DrawIndexedIndirect{&commandBuffer, commandBufferOffset, drawCount, stride});
+  }
+
+  void CommandBuffer::DrawIndexedIndirectCount(const Buffer& commandBuffer,
+                                               uint64_t commandBufferOffset,
+                                               const Buffer& countBuffer,
+                                               uint64_t countBufferOffset,
+                                               uint32_t maxDrawCount,
+                                               uint32_t stride)
+  {
+    commands_.emplace_back(detail::Commands::DrawIndexedIndirectCount{
+      &commandBuffer,
+      commandBufferOffset,
+      &countBuffer,
+      countBufferOffset,
+      maxDrawCount,
+      stride,
+    });
+  }
+
+  void CommandBuffer::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+  {
+    Dispatch(Extent3D{groupCountX, groupCountY, groupCountZ});
+  }
+
+  void CommandBuffer::Dispatch(Extent3D groupCount)
+  {
+    commands_.emplace_back(detail::Commands::Dispatch{groupCount});
+  }
+
+  void CommandBuffer::DispatchInvocations(uint32_t invocationCountX,
+                                          uint32_t invocationCountY,
+                                          uint32_t invocationCountZ)
+  {
+    DispatchInvocations(Extent3D{invocationCountX, invocationCountY, invocationCountZ});
+  }
+
+  void CommandBuffer::DispatchInvocations(Extent3D invocationCount)
+  {
+    commands_.emplace_back(detail::Commands::DispatchInvocations{invocationCount});
+  }
+
+  void CommandBuffer::DispatchIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset)
+  {
+    commands_.emplace_back(detail::Commands::DispatchIndirect{&commandBuffer, commandBufferOffset});
+  }
+
+  void Cmd::ExecuteCommandBuffer(const CommandBuffer& commandBuffer)
+  {
+    FWOG_ASSERT(detail::context->isRendering || detail::context->isComputeActive);
+
+    for (const auto& command : commandBuffer.commands_)
+    {
+      std::visit([](const auto& c) { Execute(c); }, command);
+    }
+  }
+} // namespace Fwog
@@ -2,6 +2,9 @@
 #include <Fwog/detail/ContextState.h>
 #include FWOG_OPENGL_HEADER
 
+#include <filesystem>
+#include <system_error>
+
 namespace Fwog
 {
   namespace detail
@@ -29,6 +32,67 @@ namespace Fwog
         glBindTextureUnit(i, 0);
         glBindSampler(i, 0);
       }
+
+      context->appliedResourceBindings.Reset();
+      context->hazardTracker.ResetBindings();
+    }
+
+    void DestroyDeferredFrame(DeferredDestructionState::Frame& frame)
+    {
+      if (frame.textures.empty() && frame.buffers.empty() && frame.programs.empty())
+      {
+        return;
+      }
+
+      if (!frame.textures.empty())
+      {
+        context->fboCache.RemoveTextures(frame.textures);
+        for (auto texture : frame.textures)
+        {
+          context->hazardTracker.viewStorage.erase(texture);
+        }
+        glDeleteTextures(static_cast<GLsizei>(frame.textures.size()), frame.textures.data());
+      }
+
+      if (!frame.buffers.empty())
+      {
+        for (auto buffer : frame.buffers)
+        {
+          context->hazardTracker.lastWrites.erase(buffer);
+        }
+        glDeleteBuffers(static_cast<GLsizei>(frame.buffers.size()), frame.buffers.data());
+      }
+
+      for (auto program : frame.programs)
+      {
+        glDeleteProgram(program);
+      }
+
+      // Deleted names can be reused, so bindings that refer to them must not be considered applied anymore
+      context->appliedResourceBindings.Reset();
+
+      frame.textures.clear();
+      frame.buffers.clear();
+      frame.programs.clear();
+    }
+
+    void AcquireResidentTextureHandle(uint64_t handle)
+    {
+      if (context->residentTextureHandles[handle]++ == 0)
+      {
+        glMakeTextureHandleResidentARB(handle);
+      }
+    }
+
+    void ReleaseResidentTextureHandle(uint64_t handle)
+    {
+      auto it = context->residentTextureHandles.find(handle);
+      FWOG_ASSERT(it != context->residentTextureHandles.end() && "The handle isn't resident");
+      if (--it->second == 0)
+      {
+        glMakeTextureHandleNonResidentARB(handle);
+        context->residentTextureHandles.erase(it);
+      }
     }
   } // namespace detail
 
@@ -131,6 +195,11 @@ namespace Fwog
         features.bindlessTextures = true;
       }
 
+      if (extensionString == "GL_KHR_parallel_shader_compile" || extensionString == "GL_ARB_parallel_shader_compile")
+      {
+        features.parallelShaderCompile = true;
+      }
+
       if (extensionString == "GL_KHR_shader_subgroup")
       {
         features.shaderSubgroup = true;
@@ -180,7 +249,50 @@ namespace Fwog
     detail::context->renderHook = contextInfo.renderHook;
     detail::context->renderNoAttachmentsHook = contextInfo.renderNoAttachmentsHook;
     detail::context->computeHook = contextInfo.computeHook;
+    detail::context->isDrawBatchingEnabled = contextInfo.enableDrawBatching;
+    detail::context->isHazardTrackingEnabled = contextInfo.enableHazardTracking;
+    detail::context->useRegionBarriers = contextInfo.useRegionBarriers;
+    if (contextInfo.deferredDestructionFrames > 0)
+    {
+      detail::context->deferredDestruction.frames.resize(contextInfo.deferredDestructionFrames + 1);
+    }
     QueryGlDeviceProperties(detail::context->properties);
+
+    // Let the driver use as many compiler threads as it wants. The initial limit is implementation-defined and may be 1.
+    // The entry point isn't in the loader, so it can only be fetched if a load function was provided
+    if (detail::context->properties.features.parallelShaderCompile && contextInfo.glLoadFunc)
+    {
+#ifdef GLAD_API_PTR
+      using MaxShaderCompilerThreadsFunc = void(GLAD_API_PTR*)(GLuint count);
+#else
+      using MaxShaderCompilerThreadsFunc = void (*)(GLuint count);
+#endif
+      auto maxShaderCompilerThreads =
+        reinterpret_cast<MaxShaderCompilerThreadsFunc>(contextInfo.glLoadFunc("glMaxShaderCompilerThreadsKHR"));
+      if (!maxShaderCompilerThreads)
+      {
+        maxShaderCompilerThreads =
+          reinterpret_cast<MaxShaderCompilerThreadsFunc>(contextInfo.glLoadFunc("glMaxShaderCompilerThreadsARB"));
+      }
+      if (maxShaderCompilerThreads)
+      {
+        maxShaderCompilerThreads(0xFFFFFFFF);
+      }
+    }
+
+    if (!contextInfo.programCacheDirectory.empty())
+    {
+      GLint numBinaryFormats{};
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+
+      std::error_code ec;
+      std::filesystem::create_directories(contextInfo.programCacheDirectory, ec);
+      if (numBinaryFormats > 0 && !ec)
+      {
+        detail::context->programCacheDirectory = contextInfo.programCacheDirectory;
+      }
+    }
+
     glDisable(GL_DITHER);
     glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
   }
@@ -188,6 +300,11 @@ namespace Fwog
   void Terminate()
   {
     FWOG_ASSERT(detail::context && "Fwog has already been terminated");
+
+    // Objects owned by the context are destroyed immediately
+    FlushDeferredDestruction();
+    detail::context->deferredDestruction.frames.clear();
+
     delete detail::context;
     detail::context = nullptr;
   }
@@ -202,6 +319,10 @@ namespace Fwog
     detail::ZeroResourceBindings();
 #endif
 
+    // The user may have rebound any slot, so nothing that Fwog thinks is bound can be skipped
+    context->appliedResourceBindings.Reset();
+    context->hazardTracker.ResetBindings();
+
     for (int i = 0; i < detail::MAX_COLOR_ATTACHMENTS; i++)
     {
       ColorComponentFlags& flags = context->lastColorMask[i];
@@ -218,7 +339,9 @@ namespace Fwog
 
     context->currentFbo = 0;
     context->currentVao = 0;
-    context->lastGraphicsPipeline.reset();
+    context->lastGraphicsPipeline = nullptr;
+    context->retiredGraphicsPipeline.reset();
+    context->appliedGraphicsState = {};
     context->initViewport = true;
     context->lastScissor = {};
 
@@ -231,4 +354,49 @@ namespace Fwog
   {
     return Fwog::detail::context->properties;
   }
+
+  const PipelineStateStatistics& GetPipelineStateStatistics()
+  {
+    return Fwog::detail::context->pipelineStateStatistics;
+  }
+
+  void ResetPipelineStateStatistics()
+  {
+    Fwog::detail::context->pipelineStateStatistics = {};
+  }
+
+  const HazardTrackingStatistics& GetHazardTrackingStatistics()
+  {
+    return Fwog::detail::context->hazardTracker.statistics;
+  }
+
+  void ResetHazardTrackingStatistics()
+  {
+    Fwog::detail::context->hazardTracker.statistics = {};
+  }
+
+  void ProcessDeferredDestruction()
+  {
+    auto& deferredDestruction = detail::context->deferredDestruction;
+    if (!deferredDestruction.IsEnabled())
+    {
+      return;
+    }
+
+    FWOG_ASSERT(!detail::context->isRendering && !detail::context->isComputeActive);
+
+    // After advancing, the current frame holds the objects released deferredDestructionFrames calls ago
+    deferredDestruction.frameIndex++;
+    detail::DestroyDeferredFrame(deferredDestruction.CurrentFrame());
+  }
+
+  void FlushDeferredDestruction()
+  {
+    FWOG_ASSERT(!detail::context->isRendering && !detail::context->isComputeActive);
+
+    for (auto& frame : detail::context->deferredDestruction.frames)
+    {
+      detail::DestroyDeferredFrame(frame);
+    }
+  }
 } // namespace Fwog
\ No newline at end of file
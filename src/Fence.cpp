@@ -1,4 +1,5 @@
 #include <Fwog/Fence.h>
+#include <chrono>
 #include <limits>
 #include <utility>
 #include <new>
@@ -30,21 +31,41 @@ namespace Fwog
   }
 
   uint64_t Fence::Wait()
+  {
+    // Implementations may clamp the timeout, so keep waiting until the fence is actually signaled
+    const auto start = std::chrono::steady_clock::now();
+    while (!Wait(std::numeric_limits<uint64_t>::max()))
+    {
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  }
+
+  std::optional<uint64_t> Fence::Wait(uint64_t timeoutNs)
   {
     FWOG_ASSERT(sync_ != nullptr);
-    GLuint id;
-    glGenQueries(1, &id);
-    glBeginQuery(GL_TIME_ELAPSED, id);
-    GLenum result = glClientWaitSync(reinterpret_cast<GLsync>(sync_),
-                                     GL_SYNC_FLUSH_COMMANDS_BIT,
-                                     std::numeric_limits<GLuint64>::max());
-    FWOG_ASSERT(result == GL_CONDITION_SATISFIED);
-    glEndQuery(GL_TIME_ELAPSED);
-    uint64_t elapsed;
-    glGetQueryObjectui64v(id, GL_QUERY_RESULT, &elapsed);
-    glDeleteQueries(1, &id);
+
+    // The time is measured on the CPU, as that is what blocks. The flush ensures the fence will eventually be signaled
+    const auto start = std::chrono::steady_clock::now();
+    GLenum result = glClientWaitSync(reinterpret_cast<GLsync>(sync_), GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+    const auto end = std::chrono::steady_clock::now();
+    FWOG_ASSERT(result != GL_WAIT_FAILED);
+
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+      return std::nullopt;
+    }
+
     DeleteSync();
-    return elapsed;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  }
+
+  bool Fence::IsSignaled() const
+  {
+    FWOG_ASSERT(sync_ != nullptr);
+    // A timeout of zero polls the fence. The flush ensures the fence will eventually be signaled
+    GLenum result = glClientWaitSync(reinterpret_cast<GLsync>(sync_), GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
   }
 
   void Fence::DeleteSync()
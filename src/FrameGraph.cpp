@@ -0,0 +1,404 @@
+#include <Fwog/FrameGraph.h>
+#include <Fwog/Rendering.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace Fwog
+{
+  namespace
+  {
+    bool IsWrite(FrameGraphAccess access)
+    {
+      switch (access)
+      {
+      case FrameGraphAccess::IMAGE_WRITE:
+      case FrameGraphAccess::ATTACHMENT_WRITE:
+      case FrameGraphAccess::STORAGE_WRITE:
+      case FrameGraphAccess::TRANSFER_WRITE: return true;
+      default: return false;
+      }
+    }
+
+    // Writes whose results are not visible to subsequent commands until a memory barrier is issued
+    bool IsIncoherentWrite(FrameGraphAccess access)
+    {
+      return access == FrameGraphAccess::IMAGE_WRITE || access == FrameGraphAccess::STORAGE_WRITE;
+    }
+
+    // The barrier that makes incoherent writes visible to an access
+    MemoryBarrierBit AccessToBarrierBit(FrameGraphAccess access, bool isTexture)
+    {
+      switch (access)
+      {
+      case FrameGraphAccess::SAMPLED_READ: return MemoryBarrierBit::TEXTURE_FETCH_BIT;
+      case FrameGraphAccess::IMAGE_READ:
+      case FrameGraphAccess::IMAGE_WRITE: return MemoryBarrierBit::IMAGE_ACCESS_BIT;
+      case FrameGraphAccess::ATTACHMENT_WRITE: return MemoryBarrierBit::FRAMEBUFFER_BIT;
+      case FrameGraphAccess::UNIFORM_READ: return MemoryBarrierBit::UNIFORM_BUFFER_BIT;
+      case FrameGraphAccess::STORAGE_READ:
+      case FrameGraphAccess::STORAGE_WRITE: return MemoryBarrierBit::SHADER_STORAGE_BIT;
+      case FrameGraphAccess::VERTEX_READ: return MemoryBarrierBit::VERTEX_BUFFER_BIT;
+      case FrameGraphAccess::INDEX_READ: return MemoryBarrierBit::INDEX_BUFFER_BIT;
+      case FrameGraphAccess::INDIRECT_READ: return MemoryBarrierBit::COMMAND_BUFFER_BIT;
+      case FrameGraphAccess::TRANSFER_READ:
+      case FrameGraphAccess::TRANSFER_WRITE:
+        return isTexture ? MemoryBarrierBit::TEXTURE_UPDATE_BIT : MemoryBarrierBit::BUFFER_UPDATE_BIT;
+      default: FWOG_UNREACHABLE; return MemoryBarrierBit::ALL_BITS;
+      }
+    }
+
+    struct HazardState
+    {
+      // Whether the last write was incoherent
+      bool hasIncoherentWrite = false;
+
+      // Barriers issued since the last incoherent write
+      MemoryBarrierBits visibleBits = MemoryBarrierBit::NONE;
+
+      // Whether the last write was as an attachment
+      bool hasAttachmentWrite = false;
+    };
+  } // namespace
+
+  Texture& FrameGraphResources::GetTexture(FrameGraphTexture texture) const
+  {
+    FWOG_ASSERT(texture.index < graph_->textures_.size());
+    const auto& resource = graph_->textures_[texture.index];
+    if (resource.imported)
+    {
+      return *resource.imported;
+    }
+
+    FWOG_ASSERT(resource.physicalIndex.has_value() && "The texture is not accessed by a pass that was executed");
+    return graph_->texturePool_[*resource.physicalIndex].texture;
+  }
+
+  Buffer& FrameGraphResources::GetBuffer(FrameGraphBuffer buffer) const
+  {
+    FWOG_ASSERT(buffer.index < graph_->buffers_.size());
+    return *graph_->buffers_[buffer.index].imported;
+  }
+
+  FrameGraphTexture FrameGraph::CreateTexture(const TextureCreateInfo& createInfo, std::string_view name)
+  {
+    isCompiled_ = false;
+    textures_.emplace_back(TextureResource{
+      .name = std::string(name),
+      .createInfo = createInfo,
+      .imported = nullptr,
+      .physicalIndex = std::nullopt,
+    });
+    return {static_cast<uint32_t>(textures_.size() - 1)};
+  }
+
+  FrameGraphTexture FrameGraph::ImportTexture(Texture& texture, std::string_view name)
+  {
+    isCompiled_ = false;
+    textures_.emplace_back(TextureResource{
+      .name = std::string(name),
+      .createInfo = texture.GetCreateInfo(),
+      .imported = &texture,
+      .physicalIndex = std::nullopt,
+    });
+    return {static_cast<uint32_t>(textures_.size() - 1)};
+  }
+
+  FrameGraphBuffer FrameGraph::ImportBuffer(Buffer& buffer, std::string_view name)
+  {
+    isCompiled_ = false;
+    buffers_.emplace_back(BufferResource{.name = std::string(name), .imported = &buffer});
+    return {static_cast<uint32_t>(buffers_.size() - 1)};
+  }
+
+  void FrameGraph::AddPass(const FrameGraphPassInfo& info, std::function<void(const FrameGraphResources&)> execute)
+  {
+    isCompiled_ = false;
+    passes_.emplace_back(Pass{
+      .name = std::string(info.name),
+      .textures = {info.textures.begin(), info.textures.end()},
+      .buffers = {info.buffers.begin(), info.buffers.end()},
+      .hasSideEffects = info.hasSideEffects,
+      .execute = std::move(execute),
+    });
+  }
+
+  void FrameGraph::Compile()
+  {
+    compiledPasses_.clear();
+    physicalTextureInfos_.clear();
+    for (auto& texture : textures_)
+    {
+      texture.physicalIndex.reset();
+    }
+
+    //////////////////////////////////////////////////////////////// culling
+    // Walk backwards from the graph's outputs. A pass is needed if it has side effects or writes a resource that a
+    // later needed pass reads. Imported resources are always needed, since they are observable outside the graph
+    auto textureNeeded = std::vector<bool>(textures_.size());
+    for (size_t i = 0; i < textures_.size(); i++)
+    {
+      textureNeeded[i] = textures_[i].imported != nullptr;
+    }
+
+    auto passNeeded = std::vector<bool>(passes_.size());
+    for (size_t p = passes_.size(); p-- > 0;)
+    {
+      const auto& pass = passes_[p];
+
+      bool needed = pass.hasSideEffects;
+      for (const auto& [buffer, access] : pass.buffers)
+      {
+        needed = needed || IsWrite(access);
+      }
+      for (const auto& [texture, access] : pass.textures)
+      {
+        needed = needed || (IsWrite(access) && textureNeeded[texture.index]);
+      }
+
+      if (!needed)
+      {
+        continue;
+      }
+
+      passNeeded[p] = true;
+
+      // Earlier contents of transient textures that this pass overwrites are dead, unless this pass also reads them
+      for (const auto& [texture, access] : pass.textures)
+      {
+        if (IsWrite(access) && !textures_[texture.index].imported)
+        {
+          textureNeeded[texture.index] = false;
+        }
+      }
+
+      for (const auto& [texture, access] : pass.textures)
+      {
+        if (!IsWrite(access))
+        {
+          textureNeeded[texture.index] = true;
+        }
+      }
+    }
+
+    for (uint32_t p = 0; p < passes_.size(); p++)
+    {
+      if (passNeeded[p])
+      {
+        compiledPasses_.push_back({.pass = p, .barrierBits = MemoryBarrierBit::NONE, .textureBarrier = false});
+      }
+    }
+
+    //////////////////////////////////////////////////////////////// transient texture aliasing
+    struct Lifetime
+    {
+      uint32_t texture;
+      uint32_t first;
+      uint32_t last;
+    };
+
+    std::vector<Lifetime> lifetimes;
+    auto lifetimeIndices = std::vector<std::optional<size_t>>(textures_.size());
+    for (uint32_t i = 0; i < compiledPasses_.size(); i++)
+    {
+      for (const auto& [texture, access] : passes_[compiledPasses_[i].pass].textures)
+      {
+        if (textures_[texture.index].imported)
+        {
+          continue;
+        }
+
+        if (auto& lifetimeIndex = lifetimeIndices[texture.index])
+        {
+          lifetimes[*lifetimeIndex].last = i;
+        }
+        else
+        {
+          lifetimeIndex = lifetimes.size();
+          lifetimes.push_back({.texture = texture.index, .first = i, .last = i});
+        }
+      }
+    }
+
+    // Lifetimes are already sorted by their first use. Greedily place each texture in the first compatible storage
+    // whose previous occupant is no longer used
+    std::vector<uint32_t> physicalLastUse;
+    for (const auto& lifetime : lifetimes)
+    {
+      auto& resource = textures_[lifetime.texture];
+
+      for (uint32_t i = 0; i < physicalTextureInfos_.size(); i++)
+      {
+        if (physicalLastUse[i] < lifetime.first && physicalTextureInfos_[i] == resource.createInfo)
+        {
+          resource.physicalIndex = i;
+          physicalLastUse[i] = lifetime.last;
+          break;
+        }
+      }
+
+      if (!resource.physicalIndex)
+      {
+        resource.physicalIndex = static_cast<uint32_t>(physicalTextureInfos_.size());
+        physicalTextureInfos_.push_back(resource.createInfo);
+        physicalLastUse.push_back(lifetime.last);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////// barriers
+    // glMemoryBarrier is global, so a barrier issued for one resource also applies to every other resource with
+    // outstanding incoherent writes.
+    // Transient textures that alias the same storage share its hazard state, as writes made through one of them must
+    // be visible before the next occupant accesses the memory. Imported textures come first, by texture index
+    auto textureHazards = std::vector<HazardState>(textures_.size() + physicalTextureInfos_.size());
+    auto textureHazardIndex = [this](FrameGraphTexture texture) -> size_t
+    {
+      const auto& resource = textures_[texture.index];
+      return resource.imported ? texture.index : textures_.size() + *resource.physicalIndex;
+    };
+    auto bufferHazards = std::vector<HazardState>(buffers_.size());
+
+    auto requiredBits = [](const HazardState& state, FrameGraphAccess access, bool isTexture) -> MemoryBarrierBits
+    {
+      if (!state.hasIncoherentWrite)
+      {
+        return MemoryBarrierBit::NONE;
+      }
+
+      const auto bit = AccessToBarrierBit(access, isTexture);
+      return (state.visibleBits & bit) ? MemoryBarrierBit::NONE : MemoryBarrierBits(bit);
+    };
+
+    auto applyWrite = [](HazardState& state, FrameGraphAccess access)
+    {
+      if (IsIncoherentWrite(access))
+      {
+        state.hasIncoherentWrite = true;
+        state.visibleBits = MemoryBarrierBit::NONE;
+      }
+      else
+      {
+        state.hasIncoherentWrite = false;
+        state.hasAttachmentWrite = access == FrameGraphAccess::ATTACHMENT_WRITE;
+      }
+    };
+
+    for (auto& compiled : compiledPasses_)
+    {
+      const auto& pass = passes_[compiled.pass];
+
+      for (const auto& [texture, access] : pass.textures)
+      {
+        const auto& state = textureHazards[textureHazardIndex(texture)];
+        compiled.barrierBits |= requiredBits(state, access, true);
+
+        // Sampling a texture that is also attached in this pass forms a feedback loop. Earlier attachment writes
+        // may not be visible without a texture barrier, since the pass may reuse the same framebuffer
+        if ((access == FrameGraphAccess::SAMPLED_READ || access == FrameGraphAccess::IMAGE_READ) &&
+            state.hasAttachmentWrite)
+        {
+          compiled.textureBarrier = compiled.textureBarrier ||
+                                    std::ranges::any_of(pass.textures,
+                                                        [&](const FrameGraphTextureAccess& other)
+                                                        {
+                                                          return other.texture == texture &&
+                                                                 other.access == FrameGraphAccess::ATTACHMENT_WRITE;
+                                                        });
+        }
+      }
+
+      for (const auto& [buffer, access] : pass.buffers)
+      {
+        compiled.barrierBits |= requiredBits(bufferHazards[buffer.index], access, false);
+      }
+
+      if (compiled.barrierBits != MemoryBarrierBit::NONE)
+      {
+        for (auto& state : textureHazards)
+        {
+          state.visibleBits |= compiled.barrierBits;
+        }
+        for (auto& state : bufferHazards)
+        {
+          state.visibleBits |= compiled.barrierBits;
+        }
+      }
+
+      // Apply incoherent writes last, so they take precedence if a pass writes a resource in several ways
+      for (bool incoherent : {false, true})
+      {
+        for (const auto& [texture, access] : pass.textures)
+        {
+          if (IsWrite(access) && IsIncoherentWrite(access) == incoherent)
+          {
+            applyWrite(textureHazards[textureHazardIndex(texture)], access);
+          }
+        }
+        for (const auto& [buffer, access] : pass.buffers)
+        {
+          if (IsWrite(access) && IsIncoherentWrite(access) == incoherent)
+          {
+            applyWrite(bufferHazards[buffer.index], access);
+          }
+        }
+      }
+    }
+
+    isCompiled_ = true;
+  }
+
+  void FrameGraph::Execute()
+  {
+    FWOG_ASSERT(isCompiled_ && "FrameGraph::Compile must be called after the graph is modified");
+
+    // Reuse storage from previous frames where possible. Storage that this frame doesn't need is freed
+    std::vector<PooledTexture> pool;
+    pool.reserve(physicalTextureInfos_.size());
+    for (const auto& createInfo : physicalTextureInfos_)
+    {
+      auto it = std::ranges::find(texturePool_, createInfo, &PooledTexture::createInfo);
+      if (it != texturePool_.end())
+      {
+        pool.emplace_back(std::move(*it));
+        texturePool_.erase(it);
+      }
+      else
+      {
+        pool.emplace_back(PooledTexture{createInfo, Texture(createInfo, "FrameGraph Transient Texture")});
+      }
+    }
+    texturePool_ = std::move(pool);
+
+    const auto resources = FrameGraphResources(*this);
+    for (const auto& compiled : compiledPasses_)
+    {
+      if (compiled.barrierBits != MemoryBarrierBit::NONE)
+      {
+        MemoryBarrier(compiled.barrierBits);
+      }
+
+      if (compiled.textureBarrier)
+      {
+        TextureBarrier();
+      }
+
+      passes_[compiled.pass].execute(resources);
+    }
+  }
+
+  void FrameGraph::Reset()
+  {
+    textures_.clear();
+    buffers_.clear();
+    passes_.clear();
+    compiledPasses_.clear();
+    physicalTextureInfos_.clear();
+    isCompiled_ = false;
+  }
+
+  std::optional<uint32_t> FrameGraph::GetPhysicalTextureIndex(FrameGraphTexture texture) const
+  {
+    FWOG_ASSERT(texture.index < textures_.size());
+    return textures_[texture.index].physicalIndex;
+  }
+} // namespace Fwog
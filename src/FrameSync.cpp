@@ -0,0 +1,136 @@
+#include <Fwog/FrameSync.h>
+
+#include <limits>
+#include <utility>
+
+namespace Fwog
+{
+  FrameSync::FrameSync(const FrameSyncCreateInfo& createInfo) : slots_(createInfo.framesInFlight)
+  {
+    FWOG_ASSERT(createInfo.framesInFlight > 0);
+  }
+
+  FrameSync::~FrameSync()
+  {
+    WaitIdle();
+
+    // Nothing is in flight, so the callbacks for the frame that never began can run now. Callbacks that they register
+    // are dropped
+    std::swap(retiringCallbacks_, pendingCallbacks_);
+    for (auto& callback : retiringCallbacks_)
+    {
+      callback();
+    }
+  }
+
+  void FrameSync::BeginFrame()
+  {
+    [[maybe_unused]] const bool isBegun = TryBeginFrame(std::numeric_limits<uint64_t>::max());
+    FWOG_ASSERT(isBegun);
+  }
+
+  bool FrameSync::TryBeginFrame(uint64_t timeoutNs)
+  {
+    FWOG_ASSERT(!isRecording_ && "EndFrame must be called before beginning another frame");
+
+    RetireCompletedFrames();
+
+    // The slot is still in use by the frame framesInFlight frames ago
+    stats_.lastStallNs = 0;
+    if (frameIndex_ - completedFrames_ >= slots_.size())
+    {
+      const auto blockedNs = TryRetireOldest(timeoutNs);
+      if (!blockedNs)
+      {
+        stats_.timeouts++;
+        return false;
+      }
+
+      stats_.lastStallNs = *blockedNs;
+      stats_.totalStallNs += *blockedNs;
+      stats_.stalledFrames++;
+    }
+
+    // The slot's callbacks were run when it was retired, so swapping keeps both allocations around for reuse
+    auto& slot = slots_[GetFrameSlot()];
+    FWOG_ASSERT(slot.callbacks.empty());
+    std::swap(slot.callbacks, pendingCallbacks_);
+
+    isRecording_ = true;
+    return true;
+  }
+
+  void FrameSync::EndFrame()
+  {
+    FWOG_ASSERT(isRecording_ && "BeginFrame must be called before EndFrame");
+
+    slots_[GetFrameSlot()].fence.Signal();
+    frameIndex_++;
+    isRecording_ = false;
+  }
+
+  void FrameSync::OnFrameRetired(std::function<void()> callback)
+  {
+    FWOG_ASSERT(callback);
+    if (isRecording_)
+    {
+      slots_[GetFrameSlot()].callbacks.push_back(std::move(callback));
+    }
+    else
+    {
+      pendingCallbacks_.push_back(std::move(callback));
+    }
+  }
+
+  void FrameSync::RetireCompletedFrames()
+  {
+    while (completedFrames_ < frameIndex_ && TryRetireOldest(0))
+    {
+    }
+  }
+
+  bool FrameSync::IsFrameComplete(uint64_t frameIndex)
+  {
+    while (completedFrames_ <= frameIndex && completedFrames_ < frameIndex_)
+    {
+      if (!TryRetireOldest(0))
+      {
+        return false;
+      }
+    }
+
+    return frameIndex < completedFrames_;
+  }
+
+  void FrameSync::WaitIdle()
+  {
+    FWOG_ASSERT(!isRecording_ && "Cannot wait for the current frame before it ends");
+
+    while (completedFrames_ < frameIndex_)
+    {
+      TryRetireOldest(std::numeric_limits<uint64_t>::max());
+    }
+  }
+
+  std::optional<uint64_t> FrameSync::TryRetireOldest(uint64_t timeoutNs)
+  {
+    auto& slot = slots_[completedFrames_ % slots_.size()];
+    const auto blockedNs = slot.fence.Wait(timeoutNs);
+    if (!blockedNs)
+    {
+      return std::nullopt;
+    }
+
+    // The current frame may use the same slot, so callbacks that it registers from here must not be run or lost.
+    // Swapping with the scratch list keeps both allocations around for reuse
+    completedFrames_++;
+    std::swap(retiringCallbacks_, slot.callbacks);
+    for (auto& callback : retiringCallbacks_)
+    {
+      callback();
+    }
+    retiringCallbacks_.clear();
+
+    return blockedNs;
+  }
+} // namespace Fwog
@@ -0,0 +1,236 @@
+#include <Fwog/GeometryArena.h>
+#include <Fwog/Rendering.h>
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace Fwog
+{
+  namespace
+  {
+    uint32_t GetIndexSize(IndexType indexType)
+    {
+      switch (indexType)
+      {
+      case IndexType::UNSIGNED_BYTE: return 1;
+      case IndexType::UNSIGNED_SHORT: return 2;
+      case IndexType::UNSIGNED_INT: return 4;
+      default: FWOG_UNREACHABLE; return 0;
+      }
+    }
+
+    float ComputeFragmentation(uint64_t freeSize, uint64_t largestFreeBlock)
+    {
+      if (freeSize == 0)
+      {
+        return 0;
+      }
+
+      return 1.0f - static_cast<float>(largestFreeBlock) / static_cast<float>(freeSize);
+    }
+  } // namespace
+
+  GeometryArena::GeometryArena(const GeometryArenaCreateInfo& createInfo)
+    : vertexBufferName_(std::string(createInfo.name) + " Vertices"),
+      indexBufferName_(std::string(createInfo.name) + " Indices"),
+      vertexStride_(createInfo.vertexStride),
+      indexType_(createInfo.indexType),
+      indexSize_(GetIndexSize(createInfo.indexType)),
+      vertexAllocator_(std::max<uint64_t>(createInfo.vertexCapacity, 1)),
+      indexAllocator_(std::max<uint64_t>(createInfo.indexCapacity, 1)),
+      vertexBuffer_(vertexAllocator_.Capacity() * vertexStride_, BufferStorageFlag::DYNAMIC_STORAGE, vertexBufferName_),
+      indexBuffer_(indexAllocator_.Capacity() * indexSize_, BufferStorageFlag::DYNAMIC_STORAGE, indexBufferName_)
+  {
+    FWOG_ASSERT(vertexStride_ > 0);
+  }
+
+  uint64_t GeometryArena::AllocateOrGrow(detail::RangeAllocator& allocator,
+                                         Buffer& buffer,
+                                         uint64_t count,
+                                         uint64_t elementSize,
+                                         const std::string& bufferName)
+  {
+    if (auto offset = allocator.Allocate(count))
+    {
+      return *offset;
+    }
+
+    // Only the free block at the end of the range is extended, so the allocation must fit in it after growing
+    auto newCapacity = allocator.Capacity();
+    while (newCapacity - allocator.Capacity() + allocator.TrailingFreeSize() < count)
+    {
+      newCapacity *= 2;
+    }
+
+    auto newBuffer = Buffer(newCapacity * elementSize, BufferStorageFlag::DYNAMIC_STORAGE, bufferName);
+    CopyBuffer({.source = buffer, .target = newBuffer, .size = buffer.Size()});
+    buffer = std::move(newBuffer);
+    allocator.Grow(newCapacity);
+    bufferGeneration_++;
+
+    // The grown trailing block holds at least count elements
+    auto offset = allocator.Allocate(count);
+    FWOG_ASSERT(offset.has_value());
+    return *offset;
+  }
+
+  GeometryHandle GeometryArena::Allocate(TriviallyCopyableByteSpan vertices, TriviallyCopyableByteSpan indices)
+  {
+    FWOG_ASSERT(vertices.size_bytes() % vertexStride_ == 0);
+    FWOG_ASSERT(indices.size_bytes() % indexSize_ == 0);
+
+    const auto vertexCount = vertices.size_bytes() / vertexStride_;
+    const auto indexCount = indices.size_bytes() / indexSize_;
+
+    const auto vertexOffset = AllocateOrGrow(vertexAllocator_, vertexBuffer_, vertexCount, vertexStride_, vertexBufferName_);
+    const auto indexOffset = AllocateOrGrow(indexAllocator_, indexBuffer_, indexCount, indexSize_, indexBufferName_);
+
+    FWOG_ASSERT(vertexOffset <= INT32_MAX && "Vertex offsets must be representable as a base vertex");
+
+    if (vertexCount > 0)
+    {
+      vertexBuffer_.UpdateData(vertices, vertexOffset * vertexStride_);
+    }
+
+    if (indexCount > 0)
+    {
+      indexBuffer_.UpdateData(indices, indexOffset * indexSize_);
+    }
+
+    auto allocation = Allocation{
+      .vertexOffset = vertexOffset,
+      .vertexCount = vertexCount,
+      .indexOffset = indexOffset,
+      .indexCount = indexCount,
+      .generation = 0,
+      .isLive = true,
+    };
+
+    if (!freeIds_.empty())
+    {
+      const auto id = freeIds_.back();
+      freeIds_.pop_back();
+      allocation.generation = allocations_[id].generation;
+      allocations_[id] = allocation;
+      return {id, allocation.generation};
+    }
+
+    allocations_.push_back(allocation);
+    return {static_cast<uint32_t>(allocations_.size() - 1), allocation.generation};
+  }
+
+  void GeometryArena::Free(GeometryHandle handle)
+  {
+    FWOG_ASSERT(IsValid(handle) && "The handle was already freed");
+
+    auto& allocation = allocations_[handle.id];
+    vertexAllocator_.Free(allocation.vertexOffset, allocation.vertexCount);
+    indexAllocator_.Free(allocation.indexOffset, allocation.indexCount);
+    allocation.isLive = false;
+
+    // Handles to this allocation become stale once the id is reused
+    allocation.generation++;
+    freeIds_.push_back(handle.id);
+  }
+
+  bool GeometryArena::IsValid(GeometryHandle handle) const noexcept
+  {
+    return handle.id < allocations_.size() && allocations_[handle.id].isLive &&
+           allocations_[handle.id].generation == handle.generation;
+  }
+
+  GeometryRange GeometryArena::GetRange(GeometryHandle handle) const
+  {
+    FWOG_ASSERT(IsValid(handle) && "The handle was freed");
+
+    const auto& allocation = allocations_[handle.id];
+    return {
+      .startVertex = static_cast<int32_t>(allocation.vertexOffset),
+      .startIndex = static_cast<uint32_t>(allocation.indexOffset),
+      .indexCount = static_cast<uint32_t>(allocation.indexCount),
+      .vertexCount = static_cast<uint32_t>(allocation.vertexCount),
+    };
+  }
+
+  bool GeometryArena::Defragment()
+  {
+    if (vertexAllocator_.IsCompact() && indexAllocator_.IsCompact())
+    {
+      return false;
+    }
+
+    // Copy allocations in address order into new buffers. Copying into the same buffer would risk overlapping ranges
+    auto newVertexBuffer = Buffer(vertexBuffer_.Size(), BufferStorageFlag::DYNAMIC_STORAGE, vertexBufferName_);
+    auto newIndexBuffer = Buffer(indexBuffer_.Size(), BufferStorageFlag::DYNAMIC_STORAGE, indexBufferName_);
+
+    auto ids = std::vector<uint32_t>(allocations_.size());
+    std::iota(ids.begin(), ids.end(), 0u);
+    std::erase_if(ids, [this](uint32_t id) { return !allocations_[id].isLive; });
+
+    std::ranges::sort(ids, {}, [this](uint32_t id) { return allocations_[id].vertexOffset; });
+    uint64_t vertexHead = 0;
+    for (auto id : ids)
+    {
+      auto& allocation = allocations_[id];
+      if (allocation.vertexCount > 0)
+      {
+        CopyBuffer({
+          .source = vertexBuffer_,
+          .target = newVertexBuffer,
+          .sourceOffset = allocation.vertexOffset * vertexStride_,
+          .targetOffset = vertexHead * vertexStride_,
+          .size = allocation.vertexCount * vertexStride_,
+        });
+      }
+      allocation.vertexOffset = vertexHead;
+      vertexHead += allocation.vertexCount;
+    }
+
+    std::ranges::sort(ids, {}, [this](uint32_t id) { return allocations_[id].indexOffset; });
+    uint64_t indexHead = 0;
+    for (auto id : ids)
+    {
+      auto& allocation = allocations_[id];
+      if (allocation.indexCount > 0)
+      {
+        CopyBuffer({
+          .source = indexBuffer_,
+          .target = newIndexBuffer,
+          .sourceOffset = allocation.indexOffset * indexSize_,
+          .targetOffset = indexHead * indexSize_,
+          .size = allocation.indexCount * indexSize_,
+        });
+      }
+      allocation.indexOffset = indexHead;
+      indexHead += allocation.indexCount;
+    }
+
+    vertexBuffer_ = std::move(newVertexBuffer);
+    indexBuffer_ = std::move(newIndexBuffer);
+    vertexAllocator_.Reset(vertexHead);
+    indexAllocator_.Reset(indexHead);
+    bufferGeneration_++;
+    return true;
+  }
+
+  GeometryArenaStats GeometryArena::GetStats() const
+  {
+    const auto largestFreeVertexBlock = vertexAllocator_.LargestFreeBlock();
+    const auto largestFreeIndexBlock = indexAllocator_.LargestFreeBlock();
+
+    return {
+      .allocationCount = static_cast<uint32_t>(allocations_.size() - freeIds_.size()),
+      .vertexCapacity = vertexAllocator_.Capacity(),
+      .usedVertices = vertexAllocator_.Capacity() - vertexAllocator_.FreeSize(),
+      .freeVertexBlocks = vertexAllocator_.FreeBlockCount(),
+      .largestFreeVertexBlock = largestFreeVertexBlock,
+      .indexCapacity = indexAllocator_.Capacity(),
+      .usedIndices = indexAllocator_.Capacity() - indexAllocator_.FreeSize(),
+      .freeIndexBlocks = indexAllocator_.FreeBlockCount(),
+      .largestFreeIndexBlock = largestFreeIndexBlock,
+      .vertexFragmentation = ComputeFragmentation(vertexAllocator_.FreeSize(), largestFreeVertexBlock),
+      .indexFragmentation = ComputeFragmentation(indexAllocator_.FreeSize(), largestFreeIndexBlock),
+    };
+  }
+} // namespace Fwog
@@ -0,0 +1,236 @@
+#include <Fwog/GpuProfiler.h>
+#include <Fwog/detail/ContextState.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#include FWOG_OPENGL_HEADER
+
+namespace Fwog
+{
+  namespace
+  {
+    void AppendJsonString(std::string& out, std::string_view str)
+    {
+      out += '"';
+      for (char c : str)
+      {
+        switch (c)
+        {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20)
+          {
+            char escaped[8]{};
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out += escaped;
+          }
+          else
+          {
+            out += c;
+          }
+        }
+      }
+      out += '"';
+    }
+
+    void AppendMicroseconds(std::string& out, uint64_t ns)
+    {
+      char buffer[32]{};
+      std::snprintf(buffer, sizeof(buffer), "%.3f", static_cast<double>(ns) / 1000.0);
+      out += buffer;
+    }
+  } // namespace
+
+  GpuProfiler::GpuProfiler(const GpuProfilerCreateInfo& createInfo)
+    : createInfo_(createInfo), slots_(createInfo.framesInFlight)
+  {
+    FWOG_ASSERT(createInfo_.framesInFlight > 0);
+    FWOG_ASSERT(createInfo_.maxZonesPerFrame > 0);
+
+    for (auto& slot : slots_)
+    {
+      slot.queries.resize(createInfo_.maxZonesPerFrame * 2);
+      glGenQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+      slot.zones.reserve(createInfo_.maxZonesPerFrame);
+    }
+  }
+
+  GpuProfiler::~GpuProfiler()
+  {
+    if (detail::context && detail::context->activeProfiler == this)
+    {
+      detail::context->activeProfiler = nullptr;
+    }
+
+    for (auto& slot : slots_)
+    {
+      glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+    }
+  }
+
+  void GpuProfiler::BeginFrame()
+  {
+    FWOG_ASSERT(!currentSlot_ && "EndFrame must be called before beginning another frame");
+    FWOG_ASSERT(!detail::context->activeProfiler && "Another profiler is recording");
+    FWOG_ASSERT(!detail::context->isRendering && !detail::context->isComputeActive);
+
+    // Resolve frames in the order they were recorded, stopping at the first one that isn't finished
+    for (uint64_t i = frameIndex_ >= slots_.size() ? frameIndex_ - slots_.size() : 0; i < frameIndex_; i++)
+    {
+      auto& slot = slots_[i % slots_.size()];
+      if (slot.isPending && !TryResolve(slot))
+      {
+        break;
+      }
+    }
+
+    // Reuse the oldest slot. Its queries are about to be overwritten, so it is dropped if its results still weren't
+    // available above
+    auto& slot = slots_[frameIndex_ % slots_.size()];
+    if (slot.isPending)
+    {
+      stats_.droppedFrames++;
+    }
+
+    slot.zones.clear();
+    slot.names.clear();
+    slot.frameIndex = frameIndex_++;
+    slot.isPending = false;
+    currentSlot_ = &slot;
+
+    detail::context->activeProfiler = this;
+    detail::context->isProfilingPipelines = createInfo_.recordPipelineZones;
+  }
+
+  void GpuProfiler::EndFrame()
+  {
+    FWOG_ASSERT(currentSlot_ && "BeginFrame must be called before EndFrame");
+    FWOG_ASSERT(openZones_.empty() && "Every zone must end before the frame ends");
+
+    currentSlot_->isPending = !currentSlot_->zones.empty();
+    currentSlot_ = nullptr;
+
+    detail::context->activeProfiler = nullptr;
+    detail::context->isProfilingPipelines = false;
+  }
+
+  void GpuProfiler::BeginZone(std::string_view name)
+  {
+    FWOG_ASSERT(currentSlot_ && "Zones can only be recorded between BeginFrame and EndFrame");
+    auto& slot = *currentSlot_;
+
+    if (slot.zones.size() >= createInfo_.maxZonesPerFrame)
+    {
+      stats_.droppedZones++;
+      openZones_.push_back(droppedZone);
+      return;
+    }
+
+    // Once the limit is reached, every later zone in the frame is dropped, so the innermost open zone is never a
+    // dropped one here
+    const auto index = static_cast<uint32_t>(slot.zones.size());
+    slot.zones.push_back({
+      .nameOffset = static_cast<uint32_t>(slot.names.size()),
+      .nameLength = static_cast<uint32_t>(name.size()),
+      .parent = openZones_.empty() ? GpuProfilerZone::noParent : openZones_.back(),
+      .depth = static_cast<uint32_t>(openZones_.size()),
+    });
+    slot.names.append(name);
+    openZones_.push_back(index);
+
+    slot.lastQuery = slot.queries[index * 2];
+    glQueryCounter(slot.lastQuery, GL_TIMESTAMP);
+  }
+
+  void GpuProfiler::EndZone()
+  {
+    FWOG_ASSERT(currentSlot_ && "Zones can only be recorded between BeginFrame and EndFrame");
+    FWOG_ASSERT(!openZones_.empty() && "EndZone was called without a matching BeginZone");
+
+    const auto index = openZones_.back();
+    openZones_.pop_back();
+    if (index != droppedZone)
+    {
+      currentSlot_->lastQuery = currentSlot_->queries[index * 2 + 1];
+      glQueryCounter(currentSlot_->lastQuery, GL_TIMESTAMP);
+    }
+  }
+
+  bool GpuProfiler::TryResolve(FrameSlot& slot)
+  {
+    // Timestamps are written in submission order, so the last one issued being available means all of them are
+    GLint isAvailable{};
+    glGetQueryObjectiv(slot.lastQuery, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+    if (!isAvailable)
+    {
+      return false;
+    }
+
+    auto frame = GpuProfilerFrame{.frameIndex = slot.frameIndex};
+    frame.zones.reserve(slot.zones.size());
+    for (size_t i = 0; i < slot.zones.size(); i++)
+    {
+      const auto& pending = slot.zones[i];
+      auto& zone = frame.zones.emplace_back(GpuProfilerZone{
+        .name = slot.names.substr(pending.nameOffset, pending.nameLength),
+        .parent = pending.parent,
+        .depth = pending.depth,
+      });
+      glGetQueryObjectui64v(slot.queries[i * 2], GL_QUERY_RESULT, &zone.beginNs);
+      glGetQueryObjectui64v(slot.queries[i * 2 + 1], GL_QUERY_RESULT, &zone.endNs);
+    }
+
+    slot.isPending = false;
+    frames_.push_back(std::move(frame));
+    while (frames_.size() > createInfo_.historySize)
+    {
+      frames_.pop_front();
+    }
+
+    return true;
+  }
+
+  std::string GpuProfiler::ExportChromeTrace() const
+  {
+    // Timestamps are made relative to the earliest zone so they fit comfortably in a double
+    uint64_t origin = UINT64_MAX;
+    for (const auto& frame : frames_)
+    {
+      for (const auto& zone : frame.zones)
+      {
+        origin = std::min(origin, zone.beginNs);
+      }
+    }
+
+    std::string out = "{\"traceEvents\":[";
+    bool isFirst = true;
+    for (const auto& frame : frames_)
+    {
+      for (const auto& zone : frame.zones)
+      {
+        if (!isFirst)
+        {
+          out += ',';
+        }
+        isFirst = false;
+
+        out += "\n{\"name\":";
+        AppendJsonString(out, zone.name);
+        out += ",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":";
+        AppendMicroseconds(out, zone.beginNs - origin);
+        out += ",\"dur\":";
+        AppendMicroseconds(out, zone.endNs >= zone.beginNs ? zone.endNs - zone.beginNs : 0);
+        out += ",\"args\":{\"frame\":";
+        out += std::to_string(frame.frameIndex);
+        out += "}}";
+      }
+    }
+    out += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    return out;
+  }
+} // namespace Fwog
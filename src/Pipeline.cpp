@@ -1,4 +1,5 @@
 #include <Fwog/Pipeline.h>
+#include <Fwog/Shader.h>
 #include <Fwog/detail/ContextState.h>
 #include <Fwog/detail/PipelineManager.h>
 
@@ -10,16 +11,13 @@ namespace Fwog
 {
   GraphicsPipeline::GraphicsPipeline(const GraphicsPipelineInfo& info)
     : id_(detail::CompileGraphicsPipelineInternal(info))
-      
   {
-    detail::InvokeVerboseMessageCallback("Created graphics program with handle ", id_);
   }
 
   GraphicsPipeline::~GraphicsPipeline()
   {
     if (id_ != 0)
     {
-      detail::InvokeVerboseMessageCallback("Destroyed graphics program with handle ", id_);
       detail::DestroyGraphicsPipelineInternal(id_);
     }
   }
@@ -37,17 +35,30 @@ namespace Fwog
     return *this;
   }
 
+  std::optional<uint32_t> GraphicsPipeline::GetUniformBlockBinding(std::string_view block) const
+  {
+    return detail::FindReflectedBinding(detail::GetGraphicsPipelineInternal(id_)->uniformBlocks, block);
+  }
+
+  std::optional<uint32_t> GraphicsPipeline::GetStorageBlockBinding(std::string_view block) const
+  {
+    return detail::FindReflectedBinding(detail::GetGraphicsPipelineInternal(id_)->storageBlocks, block);
+  }
+
+  std::optional<uint32_t> GraphicsPipeline::GetSamplerOrImageBinding(std::string_view uniform) const
+  {
+    return detail::FindReflectedBinding(detail::GetGraphicsPipelineInternal(id_)->samplersAndImages, uniform);
+  }
+
   ComputePipeline::ComputePipeline(const ComputePipelineInfo& info)
     : id_(detail::CompileComputePipelineInternal(info))
   {
-    detail::InvokeVerboseMessageCallback("Created compute program with handle ", id_);
   }
 
   ComputePipeline::~ComputePipeline()
   {
     if (id_ != 0)
     {
-      detail::InvokeVerboseMessageCallback("Destroyed compute program with handle ", id_);
       detail::DestroyComputePipelineInternal(id_);
     }
   }
@@ -72,4 +83,102 @@ namespace Fwog
   {
     return detail::GetComputePipelineInternal(id_)->workgroupSize;
   }
+
+  std::optional<uint32_t> ComputePipeline::GetUniformBlockBinding(std::string_view block) const
+  {
+    return detail::FindReflectedBinding(detail::GetComputePipelineInternal(id_)->uniformBlocks, block);
+  }
+
+  std::optional<uint32_t> ComputePipeline::GetStorageBlockBinding(std::string_view block) const
+  {
+    return detail::FindReflectedBinding(detail::GetComputePipelineInternal(id_)->storageBlocks, block);
+  }
+
+  std::optional<uint32_t> ComputePipeline::GetSamplerOrImageBinding(std::string_view uniform) const
+  {
+    return detail::FindReflectedBinding(detail::GetComputePipelineInternal(id_)->samplersAndImages, uniform);
+  }
+
+  GraphicsPipelineFuture::GraphicsPipelineFuture(const GraphicsPipelineInfo& info)
+    : pending_(detail::BeginGraphicsPipelineInternal(info))
+  {
+  }
+
+  GraphicsPipelineFuture::~GraphicsPipelineFuture()
+  {
+    // Only programs that were never taken by Get are deleted here
+    if (pending_)
+    {
+      glDeleteProgram(pending_->program.program);
+    }
+  }
+
+  GraphicsPipelineFuture::GraphicsPipelineFuture(GraphicsPipelineFuture&& old) noexcept
+    : pending_(std::move(old.pending_))
+  {
+  }
+
+  GraphicsPipelineFuture& GraphicsPipelineFuture::operator=(GraphicsPipelineFuture&& old) noexcept
+  {
+    if (this == &old)
+    {
+      return *this;
+    }
+
+    this->~GraphicsPipelineFuture();
+    return *new (this) GraphicsPipelineFuture(std::move(old));
+  }
+
+  bool GraphicsPipelineFuture::IsReady() const
+  {
+    FWOG_ASSERT(pending_ && "Get has already been called");
+    return pending_->program.isCached || detail::IsProgramLinkComplete(pending_->program.program);
+  }
+
+  GraphicsPipeline GraphicsPipelineFuture::Get()
+  {
+    FWOG_ASSERT(pending_ && "Get has already been called");
+    return GraphicsPipeline(detail::FinishGraphicsPipelineInternal(std::move(pending_)));
+  }
+
+  ComputePipelineFuture::ComputePipelineFuture(const ComputePipelineInfo& info)
+    : pending_(detail::BeginComputePipelineInternal(info))
+  {
+  }
+
+  ComputePipelineFuture::~ComputePipelineFuture()
+  {
+    if (pending_)
+    {
+      glDeleteProgram(pending_->program.program);
+    }
+  }
+
+  ComputePipelineFuture::ComputePipelineFuture(ComputePipelineFuture&& old) noexcept
+    : pending_(std::move(old.pending_))
+  {
+  }
+
+  ComputePipelineFuture& ComputePipelineFuture::operator=(ComputePipelineFuture&& old) noexcept
+  {
+    if (this == &old)
+    {
+      return *this;
+    }
+
+    this->~ComputePipelineFuture();
+    return *new (this) ComputePipelineFuture(std::move(old));
+  }
+
+  bool ComputePipelineFuture::IsReady() const
+  {
+    FWOG_ASSERT(pending_ && "Get has already been called");
+    return pending_->program.isCached || detail::IsProgramLinkComplete(pending_->program.program);
+  }
+
+  ComputePipeline ComputePipelineFuture::Get()
+  {
+    FWOG_ASSERT(pending_ && "Get has already been called");
+    return ComputePipeline(detail::FinishComputePipelineInternal(std::move(pending_)));
+  }
 } // namespace Fwog
\ No newline at end of file
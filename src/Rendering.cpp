@@ -1,5 +1,7 @@
+#include <Fwog/BindGroup.h>
 #include <Fwog/Buffer.h>
 #include <Fwog/Config.h>
+#include <Fwog/GpuProfiler.h>
 #include <Fwog/Pipeline.h>
 #include <Fwog/Rendering.h>
 #include <Fwog/Texture.h>
@@ -8,10 +10,14 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <ranges>
+#include <span>
 #include <utility>
 #include <vector>
 
@@ -26,6 +32,345 @@ static void GLEnableOrDisable(GLenum state, GLboolean value)
     glDisable(state);
 }
 
+// Records whether state that takes glCallCount calls to apply was already applied. Returns true if it must be applied.
+static bool UpdateAppliedState(bool isAlreadyApplied, uint64_t glCallCount)
+{
+  auto& statistics = Fwog::detail::context->pipelineStateStatistics;
+  if (isAlreadyApplied)
+  {
+    statistics.skippedCalls += glCallCount;
+    return false;
+  }
+
+  statistics.emittedCalls += glCallCount;
+  return true;
+}
+
+// Updates the shadow copy of a piece of state. Returns true if the state differed and must be applied.
+template<typename T, typename U>
+static bool UpdateAppliedState(T& applied, const U& value, uint64_t glCallCount)
+{
+  if (!UpdateAppliedState(applied == value, glCallCount))
+  {
+    return false;
+  }
+
+  applied = value;
+  return true;
+}
+
+// Records a binding made outside of Cmd::BindGroup in the shadow used to diff groups
+template<typename T>
+static void UpdateAppliedBinding(std::vector<std::optional<T>>& applied, uint32_t index, const T& binding)
+{
+  if (index < applied.size())
+  {
+    applied[index] = binding;
+  }
+}
+
+// Finds each run of consecutive indices in which a binding differs from the shadow, and calls bindRange(first, count)
+// with the span from the run's first to its last differing entry. Unchanged entries within that span are rebound, as
+// splitting the call would cost more than it saves. Returns the number of entries that were skipped
+template<typename T, typename GetBinding, typename BindRange>
+static uint64_t ApplyChangedBindings(std::vector<std::optional<T>>& applied,
+                                     std::span<const uint32_t> indices,
+                                     GetBinding getBinding,
+                                     BindRange bindRange)
+{
+  if (!indices.empty() && indices.back() >= applied.size())
+  {
+    applied.resize(indices.back() + 1);
+  }
+
+  uint64_t skipped = 0;
+  for (size_t runBegin = 0; runBegin < indices.size();)
+  {
+    auto runEnd = runBegin + 1;
+    while (runEnd < indices.size() && indices[runEnd] == indices[runEnd - 1] + 1)
+    {
+      runEnd++;
+    }
+
+    auto first = runEnd;
+    auto last = runBegin;
+    for (auto i = runBegin; i < runEnd; i++)
+    {
+      const auto binding = getBinding(i);
+      if (applied[indices[i]] != binding)
+      {
+        applied[indices[i]] = binding;
+        first = std::min(first, i);
+        last = i;
+      }
+    }
+
+    if (first < runEnd)
+    {
+      bindRange(first, last - first + 1);
+      skipped += (runEnd - runBegin) - (last - first + 1);
+    }
+    else
+    {
+      skipped += runEnd - runBegin;
+    }
+
+    runBegin = runEnd;
+  }
+
+  return skipped;
+}
+
+// Allows memory in the push constant ring that was used before this point to be reused once the device is done with it
+static void FencePushConstants()
+{
+  auto* context = Fwog::detail::context;
+  if (context->pushConstantRing)
+  {
+    context->pushConstantRing->EndFrame();
+    context->pushConstantBytesSinceFence = 0;
+  }
+}
+
+// Identifies the memory of a texture for hazard tracking. Views share the key of the texture they view
+static uint64_t TrackedTexture(GLuint handle)
+{
+  const auto& viewStorage = Fwog::detail::context->hazardTracker.viewStorage;
+  if (auto it = viewStorage.find(handle); it != viewStorage.end())
+  {
+    handle = it->second;
+  }
+  return static_cast<uint64_t>(handle) << 32;
+}
+
+static void TrackBinding(std::vector<std::optional<Fwog::detail::TrackedBinding>>& slots,
+                         uint32_t index,
+                         std::optional<Fwog::detail::TrackedBinding> binding)
+{
+  if (!Fwog::detail::context->isHazardTrackingEnabled)
+  {
+    return;
+  }
+
+  if (slots.size() <= index)
+  {
+    slots.resize(index + 1);
+  }
+  slots[index] = binding;
+}
+
+// Issues one barrier for the writes that the next draw or dispatch may read before they are visible, then records the
+// writes it makes. commandBuffers are the indirect and parameter buffers that the command reads, if any
+static void ResolveHazards(std::initializer_list<const Fwog::Buffer*> commandBuffers = {})
+{
+  using namespace Fwog;
+  auto* context = detail::context;
+  if (!context->isHazardTrackingEnabled)
+  {
+    return;
+  }
+
+  auto& tracker = context->hazardTracker;
+  const auto serial = ++tracker.commandSerial;
+
+  // glMemoryBarrierByRegion only accepts bits for accesses that fragment shaders make
+  constexpr auto regionBits = MemoryBarrierBit::UNIFORM_BUFFER_BIT | MemoryBarrierBit::TEXTURE_FETCH_BIT |
+                              MemoryBarrierBit::IMAGE_ACCESS_BIT | MemoryBarrierBit::SHADER_STORAGE_BIT |
+                              MemoryBarrierBit::FRAMEBUFFER_BIT;
+
+  auto neededBits = MemoryBarrierBits{};
+  // Region barriers don't order accesses made by other stages, so they are only used if the user opted in
+  bool isRegionSufficient = context->isRendering && context->useRegionBarriers;
+
+  const auto check = [&](const std::optional<detail::TrackedBinding>& binding, MemoryBarrierBit bit)
+  {
+    if (!binding)
+    {
+      return;
+    }
+
+    auto it = tracker.lastWrites.find(binding->resource);
+    if (it == tracker.lastWrites.end())
+    {
+      return;
+    }
+
+    const auto writeSerial = it->second;
+    const auto bitIndex = std::countr_zero(static_cast<uint32_t>(bit));
+    const bool isWrittenInScope = context->isRendering && writeSerial > tracker.renderScopeBeginSerial;
+    if (writeSerial <= tracker.lastBarriers[bitIndex] ||
+        (isWrittenInScope && writeSerial <= tracker.lastRegionBarriers[bitIndex]))
+    {
+      return;
+    }
+
+    neededBits |= bit;
+    isRegionSufficient = isRegionSufficient && isWrittenInScope && (regionBits & bit);
+  };
+
+  const auto checkSlot = [&](const auto& slots, uint32_t index, MemoryBarrierBit bit)
+  {
+    if (index < slots.size())
+    {
+      check(slots[index], bit);
+    }
+  };
+
+  // Only the slots that the pipeline uses are checked, so that resources left bound by earlier commands don't cause
+  // barriers
+  const auto& uniformBlocks = context->isComputeActive ? context->lastComputePipeline->uniformBlocks
+                                                       : context->lastGraphicsPipeline->uniformBlocks;
+  const auto& storageBlocks = context->isComputeActive ? context->lastComputePipeline->storageBlocks
+                                                       : context->lastGraphicsPipeline->storageBlocks;
+  const auto& samplersAndImages = context->isComputeActive ? context->lastComputePipeline->samplersAndImages
+                                                           : context->lastGraphicsPipeline->samplersAndImages;
+
+  for (const auto& [name, binding] : uniformBlocks)
+  {
+    checkSlot(tracker.uniformBuffers, binding, MemoryBarrierBit::UNIFORM_BUFFER_BIT);
+  }
+
+  for (const auto& [name, binding] : storageBlocks)
+  {
+    checkSlot(tracker.storageBuffers, binding, MemoryBarrierBit::SHADER_STORAGE_BIT);
+  }
+
+  // Reflection doesn't distinguish samplers from images, so both kinds of slot are checked
+  for (const auto& [name, binding] : samplersAndImages)
+  {
+    checkSlot(tracker.sampledImages, binding, MemoryBarrierBit::TEXTURE_FETCH_BIT);
+    checkSlot(tracker.images, binding, MemoryBarrierBit::IMAGE_ACCESS_BIT);
+  }
+
+  if (context->isRendering)
+  {
+    for (const auto& binding : tracker.vertexBuffers)
+    {
+      check(binding, MemoryBarrierBit::VERTEX_BUFFER_BIT);
+    }
+    check(tracker.indexBuffer, MemoryBarrierBit::INDEX_BUFFER_BIT);
+  }
+
+  for (const auto* buffer : commandBuffers)
+  {
+    check(detail::TrackedBinding{buffer->Handle(), false}, MemoryBarrierBit::COMMAND_BUFFER_BIT);
+  }
+
+  if (neededBits != MemoryBarrierBits{})
+  {
+    // Batched draws were recorded before this command, so they must be issued before the barrier
+    detail::FlushDrawBatch();
+
+    // The barrier makes every write up to the previous command visible
+    auto& lastBarriers = isRegionSufficient ? tracker.lastRegionBarriers : tracker.lastBarriers;
+    for (uint32_t i = 0; i < lastBarriers.size(); i++)
+    {
+      if (neededBits & static_cast<MemoryBarrierBit>(1u << i))
+      {
+        lastBarriers[i] = serial - 1;
+      }
+    }
+
+    if (isRegionSufficient)
+    {
+      glMemoryBarrierByRegion(detail::BarrierBitsToGL(neededBits));
+    }
+    else
+    {
+      glMemoryBarrier(detail::BarrierBitsToGL(neededBits));
+    }
+    tracker.statistics.issuedBarriers++;
+  }
+
+  const auto recordWrites = [&](const auto& slots, uint32_t index)
+  {
+    if (index < slots.size() && slots[index] && slots[index]->isWrite)
+    {
+      tracker.lastWrites[slots[index]->resource] = serial;
+    }
+  };
+
+  for (const auto& [name, binding] : storageBlocks)
+  {
+    recordWrites(tracker.storageBuffers, binding);
+  }
+
+  for (const auto& [name, binding] : samplersAndImages)
+  {
+    recordWrites(tracker.images, binding);
+  }
+}
+
+// Called when a scope begins, as bindings don't persist between scopes
+static void BeginHazardTrackingScope()
+{
+  auto* context = Fwog::detail::context;
+  if (context->isHazardTrackingEnabled)
+  {
+    context->hazardTracker.ResetBindings();
+    context->hazardTracker.renderScopeBeginSerial = context->hazardTracker.commandSerial;
+  }
+}
+
+// Pushes the debug group of a render or compute scope, and opens a zone for it if a profiler is recording
+static void PushScopeDebugGroup(std::string_view name)
+{
+  auto* context = Fwog::detail::context;
+  glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(name.size()), name.data());
+  context->isScopedDebugGroupPushed = true;
+
+  if (context->activeProfiler)
+  {
+    context->activeProfiler->BeginZone(name);
+    context->isScopedZoneOpen = true;
+  }
+}
+
+static void PopScopeDebugGroup()
+{
+  auto* context = Fwog::detail::context;
+  if (context->isScopedDebugGroupPushed)
+  {
+    context->isScopedDebugGroupPushed = false;
+    glPopDebugGroup();
+  }
+
+  if (context->isScopedZoneOpen)
+  {
+    context->isScopedZoneOpen = false;
+    context->activeProfiler->EndZone();
+  }
+}
+
+static void PushPipelineDebugGroup(std::string_view name)
+{
+  auto* context = Fwog::detail::context;
+  glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(name.size()), name.data());
+  context->isPipelineDebugGroupPushed = true;
+
+  if (context->activeProfiler && context->isProfilingPipelines)
+  {
+    context->activeProfiler->BeginZone(name);
+    context->isPipelineZoneOpen = true;
+  }
+}
+
+static void PopPipelineDebugGroup()
+{
+  auto* context = Fwog::detail::context;
+  if (context->isPipelineDebugGroupPushed)
+  {
+    context->isPipelineDebugGroupPushed = false;
+    glPopDebugGroup();
+  }
+
+  if (context->isPipelineZoneOpen)
+  {
+    context->isPipelineZoneOpen = false;
+    context->activeProfiler->EndZone();
+  }
+}
+
 static size_t GetIndexSize(Fwog::IndexType indexType)
 {
   switch (indexType)
@@ -171,6 +516,7 @@ namespace Fwog
       context->isRendering = true;
       context->isRenderingToSwapchain = true;
       context->lastRenderInfo = nullptr;
+      BeginHazardTrackingScope();
 
 #ifdef FWOG_DEBUG
       detail::ZeroResourceBindings();
@@ -180,8 +526,7 @@ namespace Fwog
 
       if (!ri.name.empty())
       {
-        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(ri.name.size()), ri.name.data());
-        context->isScopedDebugGroupPushed = true;
+        PushScopeDebugGroup(ri.name);
       }
 
       glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -274,6 +619,7 @@ namespace Fwog
       FWOG_ASSERT(!context->isRendering && "Cannot call BeginRendering when rendering");
       FWOG_ASSERT(!context->isComputeActive && "Cannot nest compute and rendering");
       context->isRendering = true;
+      BeginHazardTrackingScope();
 
 #ifdef FWOG_DEBUG
       detail::ZeroResourceBindings();
@@ -290,8 +636,7 @@ namespace Fwog
 
       if (!ri.name.empty())
       {
-        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(ri.name.size()), ri.name.data());
-        context->isScopedDebugGroupPushed = true;
+        PushScopeDebugGroup(ri.name);
       }
 
       context->currentFbo = context->fboCache.CreateOrGetCachedFramebuffer(ri);
@@ -463,21 +808,18 @@ namespace Fwog
     void EndRendering()
     {
       FWOG_ASSERT(context->isRendering && "Cannot call EndRendering when not rendering");
+      FlushDrawBatch();
+      context->drawBatch.appliedVertexBuffers.clear();
+      context->drawBatch.appliedIndexBuffer = 0;
+
       context->isRendering = false;
       context->isIndexBufferBound = false;
       context->isRenderingToSwapchain = false;
 
-      if (context->isScopedDebugGroupPushed)
-      {
-        context->isScopedDebugGroupPushed = false;
-        glPopDebugGroup();
-      }
-
-      if (context->isPipelineDebugGroupPushed)
-      {
-        context->isPipelineDebugGroupPushed = false;
-        glPopDebugGroup();
-      }
+      // The pipeline's group is nested in the scope's group
+      PopPipelineDebugGroup();
+      PopScopeDebugGroup();
+      FencePushConstants();
 
       if (context->scissorEnabled)
       {
@@ -496,6 +838,7 @@ namespace Fwog
       FWOG_ASSERT(!context->isComputeActive);
       FWOG_ASSERT(!context->isRendering && "Cannot nest compute and rendering");
       context->isComputeActive = true;
+      BeginHazardTrackingScope();
 
 #ifdef FWOG_DEBUG
       detail::ZeroResourceBindings();
@@ -503,8 +846,7 @@ namespace Fwog
 
       if (!name.empty())
       {
-        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, static_cast<GLsizei>(name.size()), name.data());
-        context->isScopedDebugGroupPushed = true;
+        PushScopeDebugGroup(name);
       }
     }
 
@@ -513,23 +855,88 @@ namespace Fwog
       FWOG_ASSERT(context->isComputeActive);
       context->isComputeActive = false;
 
-      if (context->isScopedDebugGroupPushed)
+      // The pipeline's group is nested in the scope's group
+      PopPipelineDebugGroup();
+      PopScopeDebugGroup();
+      FencePushConstants();
+    }
+
+    void FlushDrawBatch()
+    {
+      auto& batch = context->drawBatch;
+      if (batch.isFlushing)
       {
-        context->isScopedDebugGroupPushed = false;
-        glPopDebugGroup();
+        return;
+      }
+      batch.isFlushing = true;
+
+      if (batch.commands.size() == 1)
+      {
+        // Not worth a trip through the indirect buffer
+        const auto& command = batch.commands.front();
+        glDrawElementsInstancedBaseVertexBaseInstance(
+          detail::PrimitiveTopologyToGL(context->currentTopology),
+          command.indexCount,
+          detail::IndexTypeToGL(context->currentIndexType),
+          reinterpret_cast<void*>(static_cast<uintptr_t>(command.firstIndex * GetIndexSize(context->currentIndexType))),
+          command.instanceCount,
+          command.vertexOffset,
+          command.firstInstance);
+      }
+      else if (batch.commands.size() > 1)
+      {
+        const auto size = batch.commands.size() * sizeof(DrawIndexedIndirectCommand);
+
+        if (!batch.indirectBuffer || batch.indirectBuffer->Size() < size)
+        {
+          auto bufferSize = std::max<size_t>(size, 64 * 1024);
+          batch.indirectBuffer.emplace(std::bit_ceil(bufferSize), BufferStorageFlag::DYNAMIC_STORAGE, "Draw Batch Commands");
+          batch.indirectBufferHead = 0;
+        }
+
+        // Commands are written at increasing offsets so that the driver rarely needs to wait for draws that read an
+        // earlier range
+        if (batch.indirectBufferHead + size > batch.indirectBuffer->Size())
+        {
+          batch.indirectBufferHead = 0;
+        }
+
+        // Buffer::UpdateData would flush the batch again, so the commands are uploaded directly
+        const auto offset = batch.indirectBufferHead;
+        glNamedBufferSubData(batch.indirectBuffer->Handle(),
+                             static_cast<GLintptr>(offset),
+                             static_cast<GLsizeiptr>(size),
+                             batch.commands.data());
+        batch.indirectBufferHead += size;
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, batch.indirectBuffer->Handle());
+        glMultiDrawElementsIndirect(detail::PrimitiveTopologyToGL(context->currentTopology),
+                                    detail::IndexTypeToGL(context->currentIndexType),
+                                    reinterpret_cast<void*>(static_cast<uintptr_t>(offset)),
+                                    static_cast<GLsizei>(batch.commands.size()),
+                                    0);
       }
 
-      if (context->isPipelineDebugGroupPushed)
+      batch.commands.clear();
+
+      for (const auto& [bindingIndex, binding] : batch.pendingVertexBuffers)
       {
-        context->isPipelineDebugGroupPushed = false;
-        glPopDebugGroup();
+        glVertexArrayVertexBuffer(context->currentVao,
+                                  bindingIndex,
+                                  binding.buffer,
+                                  static_cast<GLintptr>(binding.offset),
+                                  static_cast<GLsizei>(binding.stride));
+        batch.appliedVertexBuffers[bindingIndex] = binding;
       }
+
+      batch.pendingVertexBuffers.clear();
+      batch.isFlushing = false;
     }
   } // namespace detail
 
   using namespace Fwog::detail;
 
-  void RenderToSwapchain(const SwapchainRenderInfo& renderInfo, const std::function<void()>& func)
+  void RenderToSwapchain(const SwapchainRenderInfo& renderInfo, FunctionRef<void()> func)
   {
     auto workFn = [&]
     {
@@ -548,7 +955,7 @@ namespace Fwog
     }
   }
 
-  void Render(const RenderInfo& renderInfo, const std::function<void()>& func)
+  void Render(const RenderInfo& renderInfo, FunctionRef<void()> func)
   {
     auto workFn = [&]
     {
@@ -567,7 +974,7 @@ namespace Fwog
     }
   }
 
-  void RenderNoAttachments(const RenderNoAttachmentsInfo& renderInfo, const std::function<void()>& func)
+  void RenderNoAttachments(const RenderNoAttachmentsInfo& renderInfo, FunctionRef<void()> func)
   {
     auto workFn = [&]
     {
@@ -586,7 +993,7 @@ namespace Fwog
     }
   }
 
-  void Compute(std::string_view name, const std::function<void()>& func)
+  void Compute(std::string_view name, FunctionRef<void()> func)
   {
     auto workFn = [&]
     {
@@ -614,6 +1021,7 @@ namespace Fwog
                    Filter filter,
                    AspectMask aspect)
   {
+    FlushDrawBatch();
     auto fboSource = MakeSingleTextureFbo(source, context->fboCache);
     auto fboTarget = MakeSingleTextureFbo(target, context->fboCache);
     glBlitNamedFramebuffer(fboSource,
@@ -638,6 +1046,7 @@ namespace Fwog
                               Filter filter,
                               AspectMask aspect)
   {
+    FlushDrawBatch();
     auto fbo = MakeSingleTextureFbo(source, context->fboCache);
 
     glBlitNamedFramebuffer(fbo,
@@ -656,6 +1065,7 @@ namespace Fwog
 
   void CopyTexture(const CopyTextureInfo& copy)
   {
+    FlushDrawBatch();
     glCopyImageSubData(detail::GetHandle(copy.source),
                        detail::ImageTypeToGL(copy.source.GetCreateInfo().imageType),
                        copy.sourceLevel,
@@ -675,16 +1085,35 @@ namespace Fwog
 
   void MemoryBarrier(MemoryBarrierBits accessBits)
   {
+    FlushDrawBatch();
+
+    // Explicit barriers are always issued, as they may be for writes that the tracker can't see. They still make
+    // tracked writes visible, which spares the tracker from issuing its own barrier for them
+    if (context->isHazardTrackingEnabled)
+    {
+      auto& tracker = context->hazardTracker;
+      for (uint32_t i = 0; i < tracker.lastBarriers.size(); i++)
+      {
+        if (accessBits & static_cast<MemoryBarrierBit>(1u << i))
+        {
+          tracker.lastBarriers[i] = tracker.commandSerial;
+        }
+      }
+      tracker.statistics.issuedBarriers++;
+    }
+
     glMemoryBarrier(detail::BarrierBitsToGL(accessBits));
   }
 
   void TextureBarrier()
   {
+    FlushDrawBatch();
     glTextureBarrier();
   }
 
   void CopyBuffer(const CopyBufferInfo& copy)
   {
+    FlushDrawBatch();
     auto size = copy.size;
     if (size == WHOLE_BUFFER)
     {
@@ -700,6 +1129,7 @@ namespace Fwog
 
   void CopyTextureToBuffer(const CopyTextureToBufferInfo& copy)
   {
+    FlushDrawBatch();
     glPixelStorei(GL_PACK_ROW_LENGTH, copy.bufferRowLength);
     glPixelStorei(GL_PACK_IMAGE_HEIGHT, copy.bufferImageHeight);
 
@@ -741,6 +1171,7 @@ namespace Fwog
 
   void CopyBufferToTexture(const CopyBufferToTextureInfo& copy)
   {
+    FlushDrawBatch();
     glPixelStorei(GL_UNPACK_ROW_LENGTH, copy.bufferRowLength);
     glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, copy.bufferImageHeight);
 
@@ -767,33 +1198,27 @@ namespace Fwog
       FWOG_ASSERT(pipelineState);
 
       //////////////////////////////////////////////////////////////// shader program
-      const auto& lastGraphicsPipeline = context->lastGraphicsPipeline;
-      if (lastGraphicsPipeline != pipelineState || context->lastPipelineWasCompute)
+      const auto* lastGraphicsPipeline = context->lastGraphicsPipeline;
+      if (lastGraphicsPipeline != pipelineState)
       {
-        glUseProgram(static_cast<GLuint>(pipeline.Handle()));
+        FlushDrawBatch();
       }
 
-      context->lastPipelineWasCompute = false;
-
-      // Early-out if this was the last pipeline bound
-      if (lastGraphicsPipeline == pipelineState)
+      if (UpdateAppliedState(lastGraphicsPipeline == pipelineState && !context->lastPipelineWasCompute, 1))
       {
-        return;
+        glUseProgram(pipelineState->program);
       }
 
-      if (context->isPipelineDebugGroupPushed)
-      {
-        context->isPipelineDebugGroupPushed = false;
-        glPopDebugGroup();
-      }
+      context->lastPipelineWasCompute = false;
 
-      if (!pipelineState->name.empty())
+      if (lastGraphicsPipeline != pipelineState)
       {
-        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION,
-                         0,
-                         static_cast<GLsizei>(pipelineState->name.size()),
-                         pipelineState->name.data());
-        context->isPipelineDebugGroupPushed = true;
+        PopPipelineDebugGroup();
+
+        if (!pipelineState->name.empty())
+        {
+          PushPipelineDebugGroup(pipelineState->name);
+        }
       }
 
       // Always enable this.
@@ -803,46 +1228,49 @@ namespace Fwog
         glEnable(GL_FRAMEBUFFER_SRGB);
       }
 
+      // Fixed-function state is compared against what was last applied rather than against the last pipeline, so
+      // pipelines that share some state only emit calls for the state that differs.
+      auto& applied = context->appliedGraphicsState;
+
       //////////////////////////////////////////////////////////////// input assembly
       const auto& ias = pipelineState->inputAssemblyState;
-      if (!lastGraphicsPipeline ||
-          ias.primitiveRestartEnable != lastGraphicsPipeline->inputAssemblyState.primitiveRestartEnable)
+      if (UpdateAppliedState(applied.primitiveRestartEnable, ias.primitiveRestartEnable, 1))
       {
         GLEnableOrDisable(GL_PRIMITIVE_RESTART_FIXED_INDEX, ias.primitiveRestartEnable);
       }
       context->currentTopology = ias.topology;
 
       //////////////////////////////////////////////////////////////// vertex input
-      if (auto nextVao = context->vaoCache.CreateOrGetCachedVertexArray(pipelineState->vertexInputState);
-          nextVao != context->currentVao)
+      if (UpdateAppliedState(context->currentVao, pipelineState->vertexArray, 1))
       {
-        context->currentVao = nextVao;
         glBindVertexArray(context->currentVao);
+        context->drawBatch.appliedVertexBuffers.clear();
+        context->drawBatch.appliedIndexBuffer = 0;
       }
 
       //////////////////////////////////////////////////////////////// tessellation
       const auto& ts = pipelineState->tessellationState;
       if (ts.patchControlPoints > 0)
       {
-        if (!lastGraphicsPipeline || ts.patchControlPoints != lastGraphicsPipeline->tessellationState.patchControlPoints)
+        if (UpdateAppliedState(applied.patchControlPoints, ts.patchControlPoints, 1))
         {
-          glPatchParameteri(GL_PATCH_VERTICES, static_cast<GLint>(pipelineState->tessellationState.patchControlPoints));
+          glPatchParameteri(GL_PATCH_VERTICES, static_cast<GLint>(ts.patchControlPoints));
         }
       }
 
       //////////////////////////////////////////////////////////////// rasterization
       const auto& rs = pipelineState->rasterizationState;
-      if (!lastGraphicsPipeline || rs.depthClampEnable != lastGraphicsPipeline->rasterizationState.depthClampEnable)
+      if (UpdateAppliedState(applied.depthClampEnable, rs.depthClampEnable, 1))
       {
         GLEnableOrDisable(GL_DEPTH_CLAMP, rs.depthClampEnable);
       }
 
-      if (!lastGraphicsPipeline || rs.polygonMode != lastGraphicsPipeline->rasterizationState.polygonMode)
+      if (UpdateAppliedState(applied.polygonMode, rs.polygonMode, 1))
       {
         glPolygonMode(GL_FRONT_AND_BACK, detail::PolygonModeToGL(rs.polygonMode));
       }
 
-      if (!lastGraphicsPipeline || rs.cullMode != lastGraphicsPipeline->rasterizationState.cullMode)
+      if (UpdateAppliedState(applied.cullMode, rs.cullMode, rs.cullMode != CullMode::NONE ? 2 : 1))
       {
         GLEnableOrDisable(GL_CULL_FACE, rs.cullMode != CullMode::NONE);
         if (rs.cullMode != CullMode::NONE)
@@ -851,137 +1279,129 @@ namespace Fwog
         }
       }
 
-      if (!lastGraphicsPipeline || rs.frontFace != lastGraphicsPipeline->rasterizationState.frontFace)
+      if (UpdateAppliedState(applied.frontFace, rs.frontFace, 1))
       {
         glFrontFace(detail::FrontFaceToGL(rs.frontFace));
       }
 
-      if (!lastGraphicsPipeline || rs.depthBiasEnable != lastGraphicsPipeline->rasterizationState.depthBiasEnable)
+      if (UpdateAppliedState(applied.depthBiasEnable, rs.depthBiasEnable, 3))
       {
         GLEnableOrDisable(GL_POLYGON_OFFSET_FILL, rs.depthBiasEnable);
         GLEnableOrDisable(GL_POLYGON_OFFSET_LINE, rs.depthBiasEnable);
         GLEnableOrDisable(GL_POLYGON_OFFSET_POINT, rs.depthBiasEnable);
       }
 
-      if (!lastGraphicsPipeline ||
-          rs.depthBiasSlopeFactor != lastGraphicsPipeline->rasterizationState.depthBiasSlopeFactor ||
-          rs.depthBiasConstantFactor != lastGraphicsPipeline->rasterizationState.depthBiasConstantFactor)
+      if (UpdateAppliedState(applied.depthBiasFactors,
+                             std::array{rs.depthBiasSlopeFactor, rs.depthBiasConstantFactor},
+                             1))
       {
         glPolygonOffset(rs.depthBiasSlopeFactor, rs.depthBiasConstantFactor);
       }
 
-      if (!lastGraphicsPipeline || rs.lineWidth != lastGraphicsPipeline->rasterizationState.lineWidth)
+      if (UpdateAppliedState(applied.lineWidth, rs.lineWidth, 1))
       {
         glLineWidth(rs.lineWidth);
       }
 
-      if (!lastGraphicsPipeline || rs.pointSize != lastGraphicsPipeline->rasterizationState.pointSize)
+      if (UpdateAppliedState(applied.pointSize, rs.pointSize, 1))
       {
         glPointSize(rs.pointSize);
       }
 
       //////////////////////////////////////////////////////////////// multisample
       const auto& ms = pipelineState->multisampleState;
-      if (!lastGraphicsPipeline || ms.sampleShadingEnable != lastGraphicsPipeline->multisampleState.sampleShadingEnable)
+      if (UpdateAppliedState(applied.sampleShadingEnable, ms.sampleShadingEnable, 1))
       {
         GLEnableOrDisable(GL_SAMPLE_SHADING, ms.sampleShadingEnable);
       }
 
-      if (!lastGraphicsPipeline || ms.minSampleShading != lastGraphicsPipeline->multisampleState.minSampleShading)
+      if (UpdateAppliedState(applied.minSampleShading, ms.minSampleShading, 1))
       {
         glMinSampleShading(ms.minSampleShading);
       }
 
-      if (!lastGraphicsPipeline || ms.sampleMask != lastGraphicsPipeline->multisampleState.sampleMask)
+      if (UpdateAppliedState(applied.sampleMask, ms.sampleMask, 2))
       {
         GLEnableOrDisable(GL_SAMPLE_MASK, ms.sampleMask != 0xFFFFFFFF);
         glSampleMaski(0, ms.sampleMask);
       }
 
-      if (!lastGraphicsPipeline || ms.alphaToCoverageEnable != lastGraphicsPipeline->multisampleState.alphaToCoverageEnable)
+      if (UpdateAppliedState(applied.alphaToCoverageEnable, ms.alphaToCoverageEnable, 1))
       {
         GLEnableOrDisable(GL_SAMPLE_ALPHA_TO_COVERAGE, ms.alphaToCoverageEnable);
       }
 
-      if (!lastGraphicsPipeline || ms.alphaToOneEnable != lastGraphicsPipeline->multisampleState.alphaToOneEnable)
+      if (UpdateAppliedState(applied.alphaToOneEnable, ms.alphaToOneEnable, 1))
       {
         GLEnableOrDisable(GL_SAMPLE_ALPHA_TO_ONE, ms.alphaToOneEnable);
       }
 
       //////////////////////////////////////////////////////////////// depth + stencil
       const auto& ds = pipelineState->depthState;
-      if (!lastGraphicsPipeline || ds.depthTestEnable != lastGraphicsPipeline->depthState.depthTestEnable)
+      if (UpdateAppliedState(applied.depthTestEnable, ds.depthTestEnable, 1))
       {
         GLEnableOrDisable(GL_DEPTH_TEST, ds.depthTestEnable);
       }
 
-      if (!lastGraphicsPipeline || ds.depthWriteEnable != lastGraphicsPipeline->depthState.depthWriteEnable)
+      // Write masks are also changed when clearing, so they are tracked separately from the rest of the state
+      if (UpdateAppliedState(context->lastDepthMask, ds.depthWriteEnable, 1))
       {
-        if (ds.depthWriteEnable != context->lastDepthMask)
-        {
-          glDepthMask(ds.depthWriteEnable);
-          context->lastDepthMask = ds.depthWriteEnable;
-        }
+        glDepthMask(ds.depthWriteEnable);
       }
 
-      if (!lastGraphicsPipeline || ds.depthCompareOp != lastGraphicsPipeline->depthState.depthCompareOp)
+      if (UpdateAppliedState(applied.depthCompareOp, ds.depthCompareOp, 1))
       {
         glDepthFunc(detail::CompareOpToGL(ds.depthCompareOp));
       }
 
       const auto& ss = pipelineState->stencilState;
-      if (!lastGraphicsPipeline || ss.stencilTestEnable != lastGraphicsPipeline->stencilState.stencilTestEnable)
+      if (UpdateAppliedState(applied.stencilTestEnable, ss.stencilTestEnable, 1))
       {
         GLEnableOrDisable(GL_STENCIL_TEST, ss.stencilTestEnable);
       }
 
-      // Stencil front
-      if (!lastGraphicsPipeline || !lastGraphicsPipeline->stencilState.stencilTestEnable ||
-          ss.front != lastGraphicsPipeline->stencilState.front)
+      constexpr GLenum stencilFaces[2] = {GL_FRONT, GL_BACK};
+      const StencilOpState* stencilOpStates[2] = {&ss.front, &ss.back};
+      for (int face = 0; face < 2; face++)
       {
-        glStencilOpSeparate(GL_FRONT,
-                            detail::StencilOpToGL(ss.front.failOp),
-                            detail::StencilOpToGL(ss.front.depthFailOp),
-                            detail::StencilOpToGL(ss.front.passOp));
-        glStencilFuncSeparate(GL_FRONT, detail::CompareOpToGL(ss.front.compareOp), ss.front.reference, ss.front.compareMask);
-        if (context->lastStencilMask[0] != ss.front.writeMask)
+        const auto& sos = *stencilOpStates[face];
+        if (UpdateAppliedState(applied.stencilOps[face], detail::StencilOps{sos.failOp, sos.depthFailOp, sos.passOp}, 1))
         {
-          glStencilMaskSeparate(GL_FRONT, ss.front.writeMask);
-          context->lastStencilMask[0] = ss.front.writeMask;
+          glStencilOpSeparate(stencilFaces[face],
+                              detail::StencilOpToGL(sos.failOp),
+                              detail::StencilOpToGL(sos.depthFailOp),
+                              detail::StencilOpToGL(sos.passOp));
         }
-      }
 
-      // Stencil back
-      if (!lastGraphicsPipeline || !lastGraphicsPipeline->stencilState.stencilTestEnable ||
-          ss.back != lastGraphicsPipeline->stencilState.back)
-      {
-        glStencilOpSeparate(GL_BACK,
-                            detail::StencilOpToGL(ss.back.failOp),
-                            detail::StencilOpToGL(ss.back.depthFailOp),
-                            detail::StencilOpToGL(ss.back.passOp));
-        glStencilFuncSeparate(GL_BACK, detail::CompareOpToGL(ss.back.compareOp), ss.back.reference, ss.back.compareMask);
-        if (context->lastStencilMask[1] != ss.back.writeMask)
+        if (UpdateAppliedState(applied.stencilFuncs[face],
+                               detail::StencilFunc{sos.compareOp, sos.reference, sos.compareMask},
+                               1))
         {
-          glStencilMaskSeparate(GL_BACK, ss.back.writeMask);
-          context->lastStencilMask[1] = ss.back.writeMask;
+          glStencilFuncSeparate(stencilFaces[face], detail::CompareOpToGL(sos.compareOp), sos.reference, sos.compareMask);
+        }
+
+        if (UpdateAppliedState(context->lastStencilMask[face], sos.writeMask, 1))
+        {
+          glStencilMaskSeparate(stencilFaces[face], sos.writeMask);
         }
       }
 
       //////////////////////////////////////////////////////////////// color blending state
       const auto& cb = pipelineState->colorBlendState;
-      if (!lastGraphicsPipeline || cb.logicOpEnable != lastGraphicsPipeline->colorBlendState.logicOpEnable)
+      if (UpdateAppliedState(applied.logicOpEnable, cb.logicOpEnable, 1))
       {
         GLEnableOrDisable(GL_COLOR_LOGIC_OP, cb.logicOpEnable);
-        if (!lastGraphicsPipeline || !lastGraphicsPipeline->colorBlendState.logicOpEnable ||
-            (cb.logicOpEnable && cb.logicOp != lastGraphicsPipeline->colorBlendState.logicOp))
-        {
-          glLogicOp(detail::LogicOpToGL(cb.logicOp));
-        }
       }
 
-      if (!lastGraphicsPipeline || std::memcmp(cb.blendConstants,
-                                               lastGraphicsPipeline->colorBlendState.blendConstants,
-                                               sizeof(cb.blendConstants)) != 0)
+      // The logic op is only applied while it is enabled, as it has no effect otherwise
+      if (cb.logicOpEnable && UpdateAppliedState(applied.logicOp, cb.logicOp, 1))
+      {
+        glLogicOp(detail::LogicOpToGL(cb.logicOp));
+      }
+
+      const auto blendConstants =
+        std::array{cb.blendConstants[0], cb.blendConstants[1], cb.blendConstants[2], cb.blendConstants[3]};
+      if (UpdateAppliedState(applied.blendConstants, blendConstants, 1))
       {
         glBlendColor(cb.blendConstants[0], cb.blendConstants[1], cb.blendConstants[2], cb.blendConstants[3]);
       }
@@ -991,48 +1411,62 @@ namespace Fwog
       //   || lastRenderInfo->colorAttachments.size() >= cb.attachments.size()
       //   && "There must be at least a color blend attachment for each render target, or none");
 
-      if (!lastGraphicsPipeline || cb.attachments.empty() != lastGraphicsPipeline->colorBlendState.attachments.empty())
+      if (UpdateAppliedState(applied.blendEnable, !cb.attachments.empty(), 1))
       {
         GLEnableOrDisable(GL_BLEND, !cb.attachments.empty());
       }
 
+      FWOG_ASSERT(cb.attachments.size() <= detail::MAX_COLOR_ATTACHMENTS);
       for (GLuint i = 0; i < static_cast<GLuint>(cb.attachments.size()); i++)
       {
         const auto& cba = cb.attachments[i];
-        if (lastGraphicsPipeline && i < lastGraphicsPipeline->colorBlendState.attachments.size() &&
-            cba == lastGraphicsPipeline->colorBlendState.attachments[i])
-        {
-          continue;
-        }
+
+        // "no blending" blend state
+        auto equation = detail::BlendEquation{
+          BlendFactor::SRC_COLOR,
+          BlendFactor::ZERO,
+          BlendFactor::SRC_ALPHA,
+          BlendFactor::ZERO,
+          BlendOp::ADD,
+          BlendOp::ADD,
+        };
 
         if (cba.blendEnable)
         {
-          glBlendFuncSeparatei(i,
-                               detail::BlendFactorToGL(cba.srcColorBlendFactor),
-                               detail::BlendFactorToGL(cba.dstColorBlendFactor),
-                               detail::BlendFactorToGL(cba.srcAlphaBlendFactor),
-                               detail::BlendFactorToGL(cba.dstAlphaBlendFactor));
-          glBlendEquationSeparatei(i, detail::BlendOpToGL(cba.colorBlendOp), detail::BlendOpToGL(cba.alphaBlendOp));
+          equation = {
+            cba.srcColorBlendFactor,
+            cba.dstColorBlendFactor,
+            cba.srcAlphaBlendFactor,
+            cba.dstAlphaBlendFactor,
+            cba.colorBlendOp,
+            cba.alphaBlendOp,
+          };
         }
-        else
+
+        if (UpdateAppliedState(applied.blendEquations[i], equation, 2))
         {
-          // "no blending" blend state
-          glBlendFuncSeparatei(i, GL_SRC_COLOR, GL_ZERO, GL_SRC_ALPHA, GL_ZERO);
-          glBlendEquationSeparatei(i, GL_FUNC_ADD, GL_FUNC_ADD);
+          glBlendFuncSeparatei(i,
+                               detail::BlendFactorToGL(equation.srcColorBlendFactor),
+                               detail::BlendFactorToGL(equation.dstColorBlendFactor),
+                               detail::BlendFactorToGL(equation.srcAlphaBlendFactor),
+                               detail::BlendFactorToGL(equation.dstAlphaBlendFactor));
+          glBlendEquationSeparatei(i,
+                                   detail::BlendOpToGL(equation.colorBlendOp),
+                                   detail::BlendOpToGL(equation.alphaBlendOp));
         }
 
-        if (context->lastColorMask[i] != cba.colorWriteMask)
+        if (UpdateAppliedState(context->lastColorMask[i], cba.colorWriteMask, 1))
         {
           glColorMaski(i,
                        (cba.colorWriteMask & ColorComponentFlag::R_BIT) != ColorComponentFlag::NONE,
                        (cba.colorWriteMask & ColorComponentFlag::G_BIT) != ColorComponentFlag::NONE,
                        (cba.colorWriteMask & ColorComponentFlag::B_BIT) != ColorComponentFlag::NONE,
                        (cba.colorWriteMask & ColorComponentFlag::A_BIT) != ColorComponentFlag::NONE);
-          context->lastColorMask[i] = cba.colorWriteMask;
         }
       }
 
       context->lastGraphicsPipeline = pipelineState;
+      context->retiredGraphicsPipeline.reset();
     }
 
     void BindComputePipeline(const ComputePipeline& pipeline)
@@ -1041,29 +1475,24 @@ namespace Fwog
       FWOG_ASSERT(pipeline.Handle() != 0);
 
       context->lastComputePipeline = detail::GetComputePipelineInternal(pipeline.Handle());
+      FWOG_ASSERT(context->lastComputePipeline);
+      context->retiredComputePipeline.reset();
       context->lastPipelineWasCompute = true;
 
-      if (context->isPipelineDebugGroupPushed)
-      {
-        context->isPipelineDebugGroupPushed = false;
-        glPopDebugGroup();
-      }
+      PopPipelineDebugGroup();
 
       if (!context->lastComputePipeline->name.empty())
       {
-        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION,
-                         0,
-                         static_cast<GLsizei>(context->lastComputePipeline->name.size()),
-                         context->lastComputePipeline->name.data());
-        context->isPipelineDebugGroupPushed = true;
+        PushPipelineDebugGroup(context->lastComputePipeline->name);
       }
 
-      glUseProgram(static_cast<GLuint>(pipeline.Handle()));
+      glUseProgram(context->lastComputePipeline->program);
     }
 
     void SetViewport(const Viewport& viewport)
     {
       FWOG_ASSERT(context->isRendering);
+      FlushDrawBatch();
 
       SetViewportInternal(viewport, context->lastViewport, false);
 
@@ -1073,6 +1502,7 @@ namespace Fwog
     void SetScissor(const Rect2D& scissor)
     {
       FWOG_ASSERT(context->isRendering);
+      FlushDrawBatch();
 
       if (!context->scissorEnabled)
       {
@@ -1094,6 +1524,37 @@ namespace Fwog
     {
       FWOG_ASSERT(context->isRendering);
 
+      const auto binding = VertexBufferBinding{.buffer = buffer.Handle(), .offset = offset, .stride = stride};
+      TrackBinding(context->hazardTracker.vertexBuffers, bindingIndex, TrackedBinding{buffer.Handle(), false});
+
+      if (context->isDrawBatchingEnabled)
+      {
+        auto& batch = context->drawBatch;
+        if (batch.appliedVertexBuffers.size() <= bindingIndex)
+        {
+          batch.appliedVertexBuffers.resize(bindingIndex + 1);
+        }
+
+        // While draws are batched, moving within the same buffer is deferred and folded into the next draw
+        const auto& applied = batch.appliedVertexBuffers[bindingIndex];
+        if (!batch.commands.empty() && applied && applied->buffer == binding.buffer && applied->stride == stride)
+        {
+          auto it = std::ranges::find(batch.pendingVertexBuffers, bindingIndex, [](const auto& p) { return p.first; });
+          if (it != batch.pendingVertexBuffers.end())
+          {
+            it->second = binding;
+          }
+          else
+          {
+            batch.pendingVertexBuffers.emplace_back(bindingIndex, binding);
+          }
+          return;
+        }
+
+        FlushDrawBatch();
+        batch.appliedVertexBuffers[bindingIndex] = binding;
+      }
+
       glVertexArrayVertexBuffer(context->currentVao,
                                 bindingIndex,
                                 buffer.Handle(),
@@ -1105,6 +1566,24 @@ namespace Fwog
     {
       FWOG_ASSERT(context->isRendering);
 
+      if (context->isHazardTrackingEnabled)
+      {
+        context->hazardTracker.indexBuffer = TrackedBinding{buffer.Handle(), false};
+      }
+
+      if (context->isDrawBatchingEnabled)
+      {
+        auto& batch = context->drawBatch;
+        if (!batch.commands.empty() && batch.appliedIndexBuffer == buffer.Handle() &&
+            context->currentIndexType == indexType)
+        {
+          return;
+        }
+
+        FlushDrawBatch();
+        batch.appliedIndexBuffer = buffer.Handle();
+      }
+
       context->isIndexBufferBound = true;
       context->currentIndexType = indexType;
       glVertexArrayElementBuffer(context->currentVao, buffer.Handle());
@@ -1113,6 +1592,8 @@ namespace Fwog
     void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
     {
       FWOG_ASSERT(context->isRendering);
+      FlushDrawBatch();
+      ResolveHazards();
 
       glDrawArraysInstancedBaseInstance(detail::PrimitiveTopologyToGL(context->currentTopology),
                                         firstVertex,
@@ -1125,6 +1606,67 @@ namespace Fwog
     {
       FWOG_ASSERT(context->isRendering);
       FWOG_ASSERT(context->isIndexBufferBound);
+      ResolveHazards();
+
+      if (context->isDrawBatchingEnabled)
+      {
+        auto& batch = context->drawBatch;
+
+        // Deferred vertex buffer rebinds can be folded into the vertex offset if every binding moved by the same
+        // number of vertices. Otherwise, the batch must be flushed so the rebinds can be applied
+        int64_t vertexDelta = 0;
+        bool isFoldable = true;
+        if (!batch.pendingVertexBuffers.empty())
+        {
+          std::optional<int64_t> commonDelta;
+          for (uint32_t i = 0; i < batch.appliedVertexBuffers.size() && isFoldable; i++)
+          {
+            const auto& applied = batch.appliedVertexBuffers[i];
+            if (!applied)
+            {
+              continue;
+            }
+
+            auto offset = applied->offset;
+            if (auto it = std::ranges::find(batch.pendingVertexBuffers, i, [](const auto& p) { return p.first; });
+                it != batch.pendingVertexBuffers.end())
+            {
+              offset = it->second.offset;
+            }
+
+            const auto byteDelta = static_cast<int64_t>(offset) - static_cast<int64_t>(applied->offset);
+            const auto stride = static_cast<int64_t>(applied->stride);
+            if ((stride == 0 && byteDelta != 0) || (stride != 0 && byteDelta % stride != 0))
+            {
+              isFoldable = false;
+              break;
+            }
+
+            const auto delta = stride == 0 ? 0 : byteDelta / stride;
+            isFoldable = !commonDelta || *commonDelta == delta;
+            commonDelta = delta;
+          }
+
+          vertexDelta = commonDelta.value_or(0);
+          const auto foldedOffset = vertexOffset + vertexDelta;
+          isFoldable = isFoldable && foldedOffset >= INT32_MIN && foldedOffset <= INT32_MAX;
+        }
+
+        if (!isFoldable)
+        {
+          FlushDrawBatch();
+          vertexDelta = 0;
+        }
+
+        batch.commands.push_back({
+          .indexCount = indexCount,
+          .instanceCount = instanceCount,
+          .firstIndex = firstIndex,
+          .vertexOffset = static_cast<int32_t>(vertexOffset + vertexDelta),
+          .firstInstance = firstInstance,
+        });
+        return;
+      }
 
       // double cast is needed to prevent compiler from complaining about 32->64 bit pointer cast
       glDrawElementsInstancedBaseVertexBaseInstance(
@@ -1140,6 +1682,8 @@ namespace Fwog
     void DrawIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset, uint32_t drawCount, uint32_t stride)
     {
       FWOG_ASSERT(context->isRendering);
+      FlushDrawBatch();
+      ResolveHazards({&commandBuffer});
 
       glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer.Handle());
       glMultiDrawArraysIndirect(detail::PrimitiveTopologyToGL(context->currentTopology),
@@ -1156,6 +1700,8 @@ namespace Fwog
                            uint32_t stride)
     {
       FWOG_ASSERT(context->isRendering);
+      FlushDrawBatch();
+      ResolveHazards({&commandBuffer, &countBuffer});
 
       glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer.Handle());
       glBindBuffer(GL_PARAMETER_BUFFER, countBuffer.Handle());
@@ -1169,7 +1715,9 @@ namespace Fwog
     void DrawIndexedIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset, uint32_t drawCount, uint32_t stride)
     {
       FWOG_ASSERT(context->isRendering);
+      FlushDrawBatch();
       FWOG_ASSERT(context->isIndexBufferBound);
+      ResolveHazards({&commandBuffer});
 
       glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer.Handle());
       glMultiDrawElementsIndirect(detail::PrimitiveTopologyToGL(context->currentTopology),
@@ -1187,7 +1735,9 @@ namespace Fwog
                                   uint32_t stride)
     {
       FWOG_ASSERT(context->isRendering);
+      FlushDrawBatch();
       FWOG_ASSERT(context->isIndexBufferBound);
+      ResolveHazards({&commandBuffer, &countBuffer});
 
       glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer.Handle());
       glBindBuffer(GL_PARAMETER_BUFFER, countBuffer.Handle());
@@ -1202,6 +1752,7 @@ namespace Fwog
     void BindUniformBuffer(uint32_t index, const Buffer& buffer, uint64_t offset, uint64_t size)
     {
       FWOG_ASSERT(context->isRendering || context->isComputeActive);
+      FlushDrawBatch();
 
       if (size == WHOLE_BUFFER)
       {
@@ -1209,23 +1760,29 @@ namespace Fwog
       }
 
       glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer.Handle(), offset, size);
+      UpdateAppliedBinding(context->appliedResourceBindings.uniformBuffers,
+                           index,
+                           detail::BufferRangeBinding{buffer.Handle(),
+                                                      static_cast<GLintptr>(offset),
+                                                      static_cast<GLsizeiptr>(size)});
+      TrackBinding(context->hazardTracker.uniformBuffers, index, TrackedBinding{buffer.Handle(), false});
     }
 
     void BindUniformBuffer(std::string_view block, const Buffer& buffer, uint64_t offset, uint64_t size)
     {
       const auto* uniformBlocks = context->isComputeActive ? &context->lastComputePipeline->uniformBlocks
                                                            : &context->lastGraphicsPipeline->uniformBlocks;
-      const auto it = std::ranges::find_if(*uniformBlocks,
-                                           [block](const auto& pair) { return pair.first.data() == block; });
+      const auto binding = detail::FindReflectedBinding(*uniformBlocks, block);
 
-      FWOG_ASSERT(it != uniformBlocks->end());
+      FWOG_ASSERT(binding.has_value());
 
-      BindUniformBuffer(it->second, buffer, offset, size);
+      BindUniformBuffer(*binding, buffer, offset, size);
     }
 
-    void BindStorageBuffer(uint32_t index, const Buffer& buffer, uint64_t offset, uint64_t size)
+    void BindStorageBuffer(uint32_t index, const Buffer& buffer, uint64_t offset, uint64_t size, ShaderAccess access)
     {
       FWOG_ASSERT(context->isRendering || context->isComputeActive);
+      FlushDrawBatch();
 
       if (size == WHOLE_BUFFER)
       {
@@ -1233,43 +1790,58 @@ namespace Fwog
       }
 
       glBindBufferRange(GL_SHADER_STORAGE_BUFFER, index, buffer.Handle(), offset, size);
+      UpdateAppliedBinding(context->appliedResourceBindings.storageBuffers,
+                           index,
+                           detail::BufferRangeBinding{buffer.Handle(),
+                                                      static_cast<GLintptr>(offset),
+                                                      static_cast<GLsizeiptr>(size)});
+      TrackBinding(context->hazardTracker.storageBuffers,
+                   index,
+                   TrackedBinding{buffer.Handle(), access != ShaderAccess::READ_ONLY});
     }
 
-    void BindStorageBuffer(std::string_view block, const Buffer& buffer, uint64_t offset, uint64_t size)
+    void BindStorageBuffer(
+      std::string_view block, const Buffer& buffer, uint64_t offset, uint64_t size, ShaderAccess access)
     {
       const auto* storageBlocks = context->isComputeActive ? &context->lastComputePipeline->storageBlocks
                                                            : &context->lastGraphicsPipeline->storageBlocks;
-      const auto it = std::ranges::find_if(*storageBlocks,
-                                           [block](const auto& pair) { return pair.first.data() == block; });
+      const auto binding = detail::FindReflectedBinding(*storageBlocks, block);
 
-      FWOG_ASSERT(it != storageBlocks->end());
+      FWOG_ASSERT(binding.has_value());
 
-      BindStorageBuffer(it->second, buffer, offset, size);
+      BindStorageBuffer(*binding, buffer, offset, size, access);
     }
 
     void BindSampledImage(uint32_t index, const Texture& texture, const Sampler& sampler)
     {
       FWOG_ASSERT(context->isRendering || context->isComputeActive);
+      FlushDrawBatch();
 
       glBindTextureUnit(index, const_cast<Texture&>(texture).Handle());
       glBindSampler(index, sampler.Handle());
+      UpdateAppliedBinding(context->appliedResourceBindings.sampledImages,
+                           index,
+                           detail::SampledImageBinding{const_cast<Texture&>(texture).Handle(), sampler.Handle()});
+      TrackBinding(context->hazardTracker.sampledImages,
+                   index,
+                   TrackedBinding{TrackedTexture(const_cast<Texture&>(texture).Handle()), false});
     }
 
     void BindSampledImage(std::string_view uniform, const Texture& texture, const Sampler& sampler)
     {
       const auto* samplersAndImages = context->isComputeActive ? &context->lastComputePipeline->samplersAndImages
                                                                : &context->lastGraphicsPipeline->samplersAndImages;
-      const auto it = std::ranges::find_if(*samplersAndImages,
-                                           [uniform](const auto& pair) { return pair.first.data() == uniform; });
+      const auto binding = detail::FindReflectedBinding(*samplersAndImages, uniform);
 
-      FWOG_ASSERT(it != samplersAndImages->end());
+      FWOG_ASSERT(binding.has_value());
 
-      BindSampledImage(it->second, texture, sampler);
+      BindSampledImage(*binding, texture, sampler);
     }
 
-    void BindImage(uint32_t index, const Texture& texture, uint32_t level)
+    void BindImage(uint32_t index, const Texture& texture, uint32_t level, ShaderAccess access)
     {
       FWOG_ASSERT(context->isRendering || context->isComputeActive);
+      FlushDrawBatch();
       FWOG_ASSERT(level < texture.GetCreateInfo().mipLevels);
       FWOG_ASSERT(IsValidImageFormat(texture.GetCreateInfo().format));
 
@@ -1278,25 +1850,190 @@ namespace Fwog
                          level,
                          GL_TRUE,
                          0,
-                         GL_READ_WRITE,
+                         detail::ShaderAccessToGL(access),
                          detail::FormatToGL(texture.GetCreateInfo().format));
+      UpdateAppliedBinding(
+        context->appliedResourceBindings.images,
+        index,
+        detail::ImageBinding{const_cast<Texture&>(texture).Handle(), static_cast<GLint>(level), access});
+      TrackBinding(context->hazardTracker.images,
+                   index,
+                   TrackedBinding{TrackedTexture(const_cast<Texture&>(texture).Handle()),
+                                  access != ShaderAccess::READ_ONLY});
     }
 
-    void BindImage(std::string_view uniform, const Texture& texture, uint32_t level)
+    void BindImage(std::string_view uniform, const Texture& texture, uint32_t level, ShaderAccess access)
     {
       const auto* samplersAndImages = context->isComputeActive ? &context->lastComputePipeline->samplersAndImages
                                                                : &context->lastGraphicsPipeline->samplersAndImages;
-      const auto it = std::ranges::find_if(*samplersAndImages,
-                                           [uniform](const auto& pair) { return pair.first.data() == uniform; });
+      const auto binding = detail::FindReflectedBinding(*samplersAndImages, uniform);
+
+      FWOG_ASSERT(binding.has_value());
 
-      FWOG_ASSERT(it != samplersAndImages->end());
+      BindImage(*binding, texture, level, access);
+    }
 
-      BindImage(it->second, texture, level);
+    void BindGroup(const Fwog::BindGroup& group)
+    {
+      FWOG_ASSERT(context->isRendering || context->isComputeActive);
+      static_assert(sizeof(GLintptr) == sizeof(intptr_t) && sizeof(GLsizeiptr) == sizeof(intptr_t));
+
+      // Batched draws are only issued before a binding that they use changes, so redundant groups don't break batches
+      auto& applied = context->appliedResourceBindings;
+      auto& statistics = context->pipelineStateStatistics;
+
+      const auto applyBuffers = [&](GLenum target, auto& appliedBuffers, const Fwog::BindGroup::BufferBindings& buffers)
+      {
+        statistics.skippedCalls += ApplyChangedBindings(
+          appliedBuffers,
+          buffers.indices,
+          [&](size_t i) { return detail::BufferRangeBinding{buffers.buffers[i], buffers.offsets[i], buffers.sizes[i]}; },
+          [&](size_t first, size_t count)
+          {
+            FlushDrawBatch();
+            glBindBuffersRange(target,
+                               buffers.indices[first],
+                               static_cast<GLsizei>(count),
+                               buffers.buffers.data() + first,
+                               reinterpret_cast<const GLintptr*>(buffers.offsets.data() + first),
+                               reinterpret_cast<const GLsizeiptr*>(buffers.sizes.data() + first));
+            statistics.emittedCalls++;
+          });
+      };
+
+      applyBuffers(GL_UNIFORM_BUFFER, applied.uniformBuffers, group.uniformBuffers_);
+      applyBuffers(GL_SHADER_STORAGE_BUFFER, applied.storageBuffers, group.storageBuffers_);
+
+      const auto& sampledImages = group.sampledImages_;
+      statistics.skippedCalls += 2 * ApplyChangedBindings(
+        applied.sampledImages,
+        sampledImages.indices,
+        [&](size_t i) { return detail::SampledImageBinding{sampledImages.textures[i], sampledImages.samplers[i]}; },
+        [&](size_t first, size_t count)
+        {
+          FlushDrawBatch();
+          glBindTextures(sampledImages.indices[first], static_cast<GLsizei>(count), sampledImages.textures.data() + first);
+          glBindSamplers(sampledImages.indices[first], static_cast<GLsizei>(count), sampledImages.samplers.data() + first);
+          statistics.emittedCalls += 2;
+        });
+
+      // glBindImageTextures always binds level 0 with read-write access, so runs that contain other levels or accesses
+      // are bound one at a time
+      const auto& images = group.images_;
+      statistics.skippedCalls += ApplyChangedBindings(
+        applied.images,
+        images.indices,
+        [&](size_t i)
+        { return detail::ImageBinding{images.textures[i], static_cast<GLint>(images.levels[i]), images.accesses[i]}; },
+        [&](size_t first, size_t count)
+        {
+          FlushDrawBatch();
+          const auto levels = std::span(images.levels).subspan(first, count);
+          const auto accesses = std::span(images.accesses).subspan(first, count);
+          if (std::ranges::all_of(levels, [](uint32_t level) { return level == 0; }) &&
+              std::ranges::all_of(accesses, [](ShaderAccess access) { return access == ShaderAccess::READ_WRITE; }))
+          {
+            glBindImageTextures(images.indices[first], static_cast<GLsizei>(count), images.textures.data() + first);
+            statistics.emittedCalls++;
+            return;
+          }
+
+          for (auto i = first; i < first + count; i++)
+          {
+            glBindImageTexture(images.indices[i],
+                               images.textures[i],
+                               images.levels[i],
+                               GL_TRUE,
+                               0,
+                               detail::ShaderAccessToGL(images.accesses[i]),
+                               images.formats[i]);
+          }
+          statistics.emittedCalls += count;
+        });
+
+      if (context->isHazardTrackingEnabled)
+      {
+        auto& tracker = context->hazardTracker;
+        const auto& uniformBuffers = group.uniformBuffers_;
+        const auto& storageBuffers = group.storageBuffers_;
+        for (size_t i = 0; i < uniformBuffers.indices.size(); i++)
+        {
+          TrackBinding(tracker.uniformBuffers, uniformBuffers.indices[i], TrackedBinding{uniformBuffers.buffers[i], false});
+        }
+
+        for (size_t i = 0; i < storageBuffers.indices.size(); i++)
+        {
+          TrackBinding(tracker.storageBuffers,
+                       storageBuffers.indices[i],
+                       TrackedBinding{storageBuffers.buffers[i], storageBuffers.accesses[i] != ShaderAccess::READ_ONLY});
+        }
+
+        for (size_t i = 0; i < sampledImages.indices.size(); i++)
+        {
+          TrackBinding(tracker.sampledImages,
+                       sampledImages.indices[i],
+                       TrackedBinding{TrackedTexture(sampledImages.textures[i]), false});
+        }
+
+        for (size_t i = 0; i < images.indices.size(); i++)
+        {
+          TrackBinding(tracker.images,
+                       images.indices[i],
+                       TrackedBinding{TrackedTexture(images.textures[i]), images.accesses[i] != ShaderAccess::READ_ONLY});
+        }
+      }
+    }
+
+    void PushConstants(TriviallyCopyableByteSpan data, uint32_t offset)
+    {
+      FWOG_ASSERT(context->isRendering || context->isComputeActive);
+      FWOG_ASSERT((context->isComputeActive ? context->lastComputePipeline != nullptr
+                                            : context->lastGraphicsPipeline != nullptr) &&
+                  "A pipeline must be bound before pushing constants");
+      FlushDrawBatch();
+
+      const auto blockSize = context->isComputeActive ? context->lastComputePipeline->pushConstantSize
+                                                      : context->lastGraphicsPipeline->pushConstantSize;
+      FWOG_ASSERT(blockSize > 0 && "The bound pipeline has no uniform block at PUSH_CONSTANT_BINDING");
+      FWOG_ASSERT(offset + data.size_bytes() <= blockSize && "Push constants exceed the size of the block");
+
+      auto& pushConstants = context->pushConstants;
+      if (pushConstants.size() < blockSize)
+      {
+        pushConstants.resize(blockSize);
+      }
+      std::memcpy(pushConstants.data() + offset, data.data(), data.size_bytes());
+
+      // Large enough for thousands of pushes per scope, which are fenced in quarters of the ring
+      constexpr uint64_t pushConstantRingSize = 1 << 20;
+      if (!context->pushConstantRing)
+      {
+        context->pushConstantRing.emplace(pushConstantRingSize, "Push constants");
+      }
+
+      const auto allocation = context->pushConstantRing->AllocateUniform(blockSize);
+      std::memcpy(allocation.mappedPointer, pushConstants.data(), blockSize);
+
+      const auto handle = allocation.buffer.get().Handle();
+      glBindBufferRange(GL_UNIFORM_BUFFER, PUSH_CONSTANT_BINDING, handle, allocation.offset, blockSize);
+      UpdateAppliedBinding(context->appliedResourceBindings.uniformBuffers,
+                           PUSH_CONSTANT_BINDING,
+                           detail::BufferRangeBinding{handle,
+                                                      static_cast<GLintptr>(allocation.offset),
+                                                      static_cast<GLsizeiptr>(blockSize)});
+      TrackBinding(context->hazardTracker.uniformBuffers, PUSH_CONSTANT_BINDING, std::nullopt);
+
+      context->pushConstantBytesSinceFence += blockSize;
+      if (context->pushConstantBytesSinceFence >= pushConstantRingSize / 4)
+      {
+        FencePushConstants();
+      }
     }
 
     void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
     {
       FWOG_ASSERT(context->isComputeActive);
+      ResolveHazards();
 
       glDispatchCompute(groupCountX, groupCountY, groupCountZ);
     }
@@ -1304,6 +2041,7 @@ namespace Fwog
     void Dispatch(Extent3D groupCount)
     {
       FWOG_ASSERT(context->isComputeActive);
+      ResolveHazards();
 
       glDispatchCompute(groupCount.width, groupCount.height, groupCount.depth);
     }
@@ -1319,6 +2057,7 @@ namespace Fwog
 
       const auto workgroupSize = context->lastComputePipeline->workgroupSize;
       const auto groupCount = (invocationCount + workgroupSize - 1) / workgroupSize;
+      ResolveHazards();
 
       glDispatchCompute(groupCount.width, groupCount.height, groupCount.depth);
     }
@@ -1347,6 +2086,7 @@ namespace Fwog
     void DispatchIndirect(const Buffer& commandBuffer, uint64_t commandBufferOffset)
     {
       FWOG_ASSERT(context->isComputeActive);
+      ResolveHazards({&commandBuffer});
 
       glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, commandBuffer.Handle());
       glDispatchComputeIndirect(static_cast<GLintptr>(commandBufferOffset));
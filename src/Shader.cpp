@@ -6,6 +6,7 @@
 #include <Fwog/detail/ShaderCPP.h>
 #endif
 #include <Fwog/detail/ShaderSPIRV.h>
+#include <Fwog/detail/Hash.h>
 
 #include <string>
 #include <utility>
@@ -14,16 +15,38 @@
 
 namespace Fwog
 {
+  namespace
+  {
+    uint64_t HashStage(PipelineStage stage)
+    {
+      return detail::hashing::fnv1a(std::as_bytes(std::span(&stage, 1)));
+    }
+
+    uint64_t HashSpirv(PipelineStage stage, const ShaderSpirvInfo& spirvInfo)
+    {
+      const auto entryPoint = std::string_view(spirvInfo.entryPoint);
+      auto hash = detail::hashing::fnv1a(std::as_bytes(spirvInfo.code), HashStage(stage));
+      hash = detail::hashing::fnv1a(std::as_bytes(std::span(entryPoint)), hash);
+      return detail::hashing::fnv1a(std::as_bytes(spirvInfo.specializationConstants), hash);
+    }
+
+    void LabelShader(uint32_t id, std::string_view name)
+    {
+      if (!name.empty())
+      {
+        glObjectLabel(GL_SHADER, id, static_cast<GLsizei>(name.length()), name.data());
+      }
+      detail::InvokeVerboseMessageCallback("Created shader with handle ", id);
+    }
+  } // namespace
+
   Shader::Shader(PipelineStage stage, std::string_view source, std::string_view name)
   {
     id_ = detail::CompileShaderGLSL(stage, source);
+    sourceHash_ = detail::hashing::fnv1a(std::as_bytes(std::span(source)), HashStage(stage));
 
     detail::ValidateShader(id_);
-    if (!name.empty())
-    {
-      glObjectLabel(GL_SHADER, id_, static_cast<GLsizei>(name.length()), name.data());
-    }
-    detail::InvokeVerboseMessageCallback("Created shader with handle ", id_);
+    LabelShader(id_, name);
   }
 
 #if FWOG_VCC_ENABLE == 1
@@ -31,29 +54,26 @@ namespace Fwog
   {
     const auto glsl = detail::CompileShaderCppToGlsl(cppInfo.source);
     id_ = detail::CompileShaderGLSL(stage, glsl);
+    sourceHash_ = detail::hashing::fnv1a(std::as_bytes(std::span(glsl)), HashStage(stage));
 
     detail::ValidateShader(id_);
-    if (!name.empty())
-    {
-      glObjectLabel(GL_SHADER, id_, static_cast<GLsizei>(name.length()), name.data());
-    }
-    detail::InvokeVerboseMessageCallback("Created shader with handle ", id_);
+    LabelShader(id_, name);
   }
 #endif
 
   Shader::Shader(PipelineStage stage, const ShaderSpirvInfo& spirvInfo, std::string_view name)
   {
     id_ = detail::CompileShaderSpirv(stage, spirvInfo);
+    sourceHash_ = HashSpirv(stage, spirvInfo);
 
     detail::ValidateShader(id_);
-    if (!name.empty())
-    {
-      glObjectLabel(GL_SHADER, id_, static_cast<GLsizei>(name.length()), name.data());
-    }
-    detail::InvokeVerboseMessageCallback("Created shader with handle ", id_);
+    LabelShader(id_, name);
   }
 
-  Shader::Shader(Shader&& old) noexcept : id_(std::exchange(old.id_, 0)) {}
+  Shader::Shader(Shader&& old) noexcept
+    : id_(std::exchange(old.id_, 0)), sourceHash_(std::exchange(old.sourceHash_, 0))
+  {
+  }
 
   Shader& Shader::operator=(Shader&& old) noexcept
   {
@@ -68,8 +88,66 @@ namespace Fwog
     detail::InvokeVerboseMessageCallback("Destroyed shader with handle ", id_);
     glDeleteShader(id_);
   }
+
+  ShaderFuture::ShaderFuture(PipelineStage stage, std::string_view source, std::string_view name)
+  {
+    id_ = detail::CompileShaderGLSL(stage, source);
+    sourceHash_ = detail::hashing::fnv1a(std::as_bytes(std::span(source)), HashStage(stage));
+    LabelShader(id_, name);
+  }
+
+  ShaderFuture::ShaderFuture(PipelineStage stage, const ShaderSpirvInfo& spirvInfo, std::string_view name)
+  {
+    id_ = detail::CompileShaderSpirv(stage, spirvInfo);
+    sourceHash_ = HashSpirv(stage, spirvInfo);
+    LabelShader(id_, name);
+  }
+
+  ShaderFuture::ShaderFuture(ShaderFuture&& old) noexcept
+    : id_(std::exchange(old.id_, 0)), sourceHash_(std::exchange(old.sourceHash_, 0))
+  {
+  }
+
+  ShaderFuture& ShaderFuture::operator=(ShaderFuture&& old) noexcept
+  {
+    if (&old == this)
+      return *this;
+    this->~ShaderFuture();
+    return *new (this) ShaderFuture(std::move(old));
+  }
+
+  ShaderFuture::~ShaderFuture()
+  {
+    // Only shaders that were never taken by Get are destroyed here
+    if (id_ != 0)
+    {
+      detail::InvokeVerboseMessageCallback("Destroyed shader with handle ", id_);
+      glDeleteShader(id_);
+    }
+  }
+
+  bool ShaderFuture::IsReady() const
+  {
+    FWOG_ASSERT(id_ != 0 && "Get has already been called");
+    return detail::IsShaderCompileComplete(id_);
+  }
+
+  Shader ShaderFuture::Get()
+  {
+    FWOG_ASSERT(id_ != 0 && "Get has already been called");
+
+    // ValidateShader deletes the shader if it throws, so ownership is released first
+    const auto id = std::exchange(id_, 0);
+    detail::ValidateShader(id);
+    return Shader(id, sourceHash_);
+  }
 } // namespace Fwog
 
+uint64_t Fwog::detail::GetSourceHash(const Shader& shader)
+{
+  return shader.sourceHash_;
+}
+
 void Fwog::detail::ValidateShader(uint32_t id)
 {
   GLint success;
@@ -84,3 +162,27 @@ void Fwog::detail::ValidateShader(uint32_t id)
     throw ShaderCompilationException("Failed to compile shader source.\n" + infoLog);
   }
 }
+
+bool Fwog::detail::IsShaderCompileComplete(uint32_t id)
+{
+  if (!context->properties.features.parallelShaderCompile)
+  {
+    return true;
+  }
+
+  GLint complete{};
+  glGetShaderiv(id, GL_COMPLETION_STATUS_KHR, &complete);
+  return complete == GL_TRUE;
+}
+
+bool Fwog::detail::IsProgramLinkComplete(uint32_t id)
+{
+  if (!context->properties.features.parallelShaderCompile)
+  {
+    return true;
+  }
+
+  GLint complete{};
+  glGetProgramiv(id, GL_COMPLETION_STATUS_KHR, &complete);
+  return complete == GL_TRUE;
+}
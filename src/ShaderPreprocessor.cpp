@@ -0,0 +1,266 @@
+#include <Fwog/Exception.h>
+#include <Fwog/ShaderPreprocessor.h>
+#include <Fwog/detail/Hash.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+namespace Fwog
+{
+  namespace
+  {
+    // Deep enough for any reasonable include hierarchy, shallow enough to catch cycles without overflowing the stack
+    constexpr uint32_t maxIncludeDepth = 64;
+
+    std::string NormalizePath(const std::filesystem::path& path)
+    {
+      return path.lexically_normal().generic_string();
+    }
+
+    std::optional<std::string> ReadFileFromDisk(const std::string& path)
+    {
+      auto file = std::ifstream(path, std::ios::binary);
+      if (!file)
+      {
+        return std::nullopt;
+      }
+      return std::string(std::istreambuf_iterator<char>(file), {});
+    }
+
+    std::string_view TrimLeft(std::string_view str)
+    {
+      const auto first = str.find_first_not_of(" \t");
+      return first == std::string_view::npos ? std::string_view{} : str.substr(first);
+    }
+
+    // Returns the rest of a line if it is a preprocessor directive with the given name
+    std::optional<std::string_view> MatchDirective(std::string_view line, std::string_view directive)
+    {
+      line = TrimLeft(line);
+      if (line.empty() || line.front() != '#')
+      {
+        return std::nullopt;
+      }
+
+      line = TrimLeft(line.substr(1));
+      if (!line.starts_with(directive))
+      {
+        return std::nullopt;
+      }
+
+      return TrimLeft(line.substr(directive.size()));
+    }
+  } // namespace
+
+  struct ShaderPreprocessor::ParsedFile
+  {
+    struct Include
+    {
+      std::string name;
+      size_t begin;      // Offset of the include directive
+      size_t end;        // Offset of the line after the directive
+      uint32_t nextLine; // One-based number of the line after the directive
+    };
+
+    std::string path;
+    std::string directory;
+    std::string contents;
+    std::vector<Include> includes;
+
+    // Offset and one-based number of the line after the #version directive, or zero if there is none
+    size_t versionEnd{};
+    uint32_t versionNextLine{};
+  };
+
+  struct ShaderPreprocessor::Expansion
+  {
+    std::string source;
+    std::vector<std::string> files;
+  };
+
+  ShaderPreprocessor::ShaderPreprocessor(FileLoader loader) : loader_(std::move(loader))
+  {
+    if (!loader_)
+    {
+      loader_ = ReadFileFromDisk;
+    }
+  }
+
+  ShaderPreprocessor::ShaderPreprocessor(ShaderPreprocessor&&) noexcept = default;
+  ShaderPreprocessor& ShaderPreprocessor::operator=(ShaderPreprocessor&&) noexcept = default;
+  ShaderPreprocessor::~ShaderPreprocessor() = default;
+
+  void ShaderPreprocessor::AddIncludeDirectory(std::string_view directory)
+  {
+    includeDirectories_.emplace_back(NormalizePath(directory));
+  }
+
+  void ShaderPreprocessor::AddFile(std::string_view path, std::string_view contents)
+  {
+    auto normalized = NormalizePath(path);
+    cache_.erase(normalized);
+    virtualFiles_.insert_or_assign(std::move(normalized), std::string(contents));
+  }
+
+  void ShaderPreprocessor::ClearCache()
+  {
+    cache_.clear();
+  }
+
+  PreprocessedShader ShaderPreprocessor::Preprocess(std::string_view path, std::span<const ShaderDefine> defines)
+  {
+    const auto* root = GetFile(NormalizePath(path));
+    if (!root)
+    {
+      throw ShaderCompilationException("Failed to preprocess shader. File not found: " + std::string(path));
+    }
+
+    auto expansion = Expansion{};
+    expansion.files.push_back(root->path);
+
+    // Defines can't precede #version, so they are injected after it. A #line directive restores the line numbers of
+    // the rest of the file
+    expansion.source.append(root->contents, 0, root->versionEnd);
+    if (!defines.empty())
+    {
+      for (const auto& define : defines)
+      {
+        expansion.source.append("#define ").append(define.name).append(" ").append(define.value).append("\n");
+      }
+      // Without a #version directive, the defines are at the start of the file and the next line is the first
+      const auto nextLine = root->versionNextLine == 0 ? 1 : root->versionNextLine;
+      expansion.source.append("#line ").append(std::to_string(nextLine)).append(" 0\n");
+    }
+
+    Expand(*root, 0, root->versionEnd, expansion, 0);
+
+    const auto hash = detail::hashing::fnv1a(std::as_bytes(std::span(expansion.source)));
+    return PreprocessedShader{
+      .source = std::move(expansion.source),
+      .hash = hash,
+      .files = std::move(expansion.files),
+    };
+  }
+
+  const ShaderPreprocessor::ParsedFile* ShaderPreprocessor::GetFile(const std::string& path)
+  {
+    if (auto it = cache_.find(path); it != cache_.end())
+    {
+      return it->second.get();
+    }
+
+    std::optional<std::string> contents;
+    if (auto it = virtualFiles_.find(path); it != virtualFiles_.end())
+    {
+      contents = it->second;
+    }
+    else
+    {
+      contents = loader_(path);
+    }
+
+    if (!contents)
+    {
+      cache_.emplace(path, nullptr);
+      return nullptr;
+    }
+
+    auto parsed = std::make_unique<ParsedFile>();
+    parsed->path = path;
+    parsed->directory = NormalizePath(std::filesystem::path(path).parent_path());
+    parsed->contents = std::move(*contents);
+
+    const auto text = std::string_view(parsed->contents);
+    uint32_t lineNumber = 1;
+    for (size_t lineBegin = 0; lineBegin < text.size(); lineNumber++)
+    {
+      const auto newline = text.find('\n', lineBegin);
+      const auto lineEnd = newline == std::string_view::npos ? text.size() : newline + 1;
+      const auto line = text.substr(lineBegin, lineEnd - lineBegin);
+
+      if (auto rest = MatchDirective(line, "include"); rest && !rest->empty())
+      {
+        const char close = rest->front() == '<' ? '>' : '"';
+        const auto nameEnd = rest->find(close, 1);
+        if ((rest->front() == '"' || rest->front() == '<') && nameEnd != std::string_view::npos)
+        {
+          parsed->includes.push_back({
+            .name = std::string(rest->substr(1, nameEnd - 1)),
+            .begin = lineBegin,
+            .end = lineEnd,
+            .nextLine = lineNumber + 1,
+          });
+        }
+      }
+      else if (parsed->versionEnd == 0 && MatchDirective(line, "version"))
+      {
+        parsed->versionEnd = lineEnd;
+        parsed->versionNextLine = lineNumber + 1;
+      }
+
+      lineBegin = lineEnd;
+    }
+
+    return cache_.insert_or_assign(path, std::move(parsed)).first->second.get();
+  }
+
+  void ShaderPreprocessor::Expand(
+    const ParsedFile& file, uint32_t fileIndex, size_t start, Expansion& expansion, uint32_t depth)
+  {
+    if (depth > maxIncludeDepth)
+    {
+      throw ShaderCompilationException("Failed to preprocess shader. Includes are nested too deeply in " + file.path);
+    }
+
+    size_t textBegin = start;
+    for (const auto& include : file.includes)
+    {
+      if (include.begin < start)
+      {
+        continue;
+      }
+
+      // Search the including file's directory, then the include directories
+      const ParsedFile* included = GetFile(NormalizePath(std::filesystem::path(file.directory) / include.name));
+      for (size_t i = 0; !included && i < includeDirectories_.size(); i++)
+      {
+        included = GetFile(NormalizePath(std::filesystem::path(includeDirectories_[i]) / include.name));
+      }
+
+      if (!included)
+      {
+        throw ShaderCompilationException("Failed to preprocess shader. Could not find \"" + include.name +
+                                         "\" included by " + file.path);
+      }
+
+      auto includedIndex = static_cast<uint32_t>(expansion.files.size());
+      for (uint32_t i = 0; i < expansion.files.size(); i++)
+      {
+        if (expansion.files[i] == included->path)
+        {
+          includedIndex = i;
+          break;
+        }
+      }
+      if (includedIndex == expansion.files.size())
+      {
+        expansion.files.push_back(included->path);
+      }
+
+      expansion.source.append(file.contents, textBegin, include.begin - textBegin);
+      expansion.source.append("#line 1 ").append(std::to_string(includedIndex)).append("\n");
+      Expand(*included, includedIndex, 0, expansion, depth + 1);
+      expansion.source.append("\n#line ")
+        .append(std::to_string(include.nextLine))
+        .append(" ")
+        .append(std::to_string(fileIndex))
+        .append("\n");
+
+      textBegin = include.end;
+    }
+
+    expansion.source.append(file.contents, textBegin);
+  }
+} // namespace Fwog
@@ -161,13 +161,25 @@ namespace Fwog
 
     if (bindlessHandle_ != 0)
     {
-      glMakeTextureHandleNonResidentARB(bindlessHandle_);
+      detail::ReleaseResidentTextureHandle(bindlessHandle_);
+    }
+
+    auto& deferredDestruction = Fwog::detail::context->deferredDestruction;
+    if (deferredDestruction.IsEnabled())
+    {
+      detail::InvokeVerboseMessageCallback("Deferred destruction of texture with handle ", id_);
+      deferredDestruction.CurrentFrame().textures.push_back(id_);
+      return;
     }
 
     detail::InvokeVerboseMessageCallback("Destroyed texture with handle ", id_);
     glDeleteTextures(1, &id_);
     // Ensure that the texture is no longer referenced in the FBO cache
     Fwog::detail::context->fboCache.RemoveTexture(*this);
+    Fwog::detail::context->appliedResourceBindings.Reset();
+
+    // Writes stay tracked, as views of this texture may outlive it
+    Fwog::detail::context->hazardTracker.viewStorage.erase(id_);
   }
 
   TextureView Texture::CreateSingleMipView(uint32_t level)
@@ -229,18 +241,20 @@ namespace Fwog
     FWOG_ASSERT(bindlessHandle_ == 0 && "Texture already has bindless handle resident.");
     bindlessHandle_ = glGetTextureSamplerHandleARB(id_, sampler.Handle());
     FWOG_ASSERT(bindlessHandle_ != 0 && "Failed to create texture sampler handle.");
-    glMakeTextureHandleResidentARB(bindlessHandle_);
+    detail::AcquireResidentTextureHandle(bindlessHandle_);
     return bindlessHandle_;
   }
 
   void Texture::UpdateImage(const TextureUpdateInfo& info)
   {
+    detail::FlushDrawBatch();
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     subImageInternal(info);
   }
 
   void Texture::UpdateCompressedImage(const CompressedTextureUpdateInfo& info)
   {
+    detail::FlushDrawBatch();
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
     subCompressedImageInternal(info);
   }
@@ -376,6 +390,7 @@ namespace Fwog
       extent.depth = std::max(extent.depth, 1u);
     }
 
+    detail::FlushDrawBatch();
     glClearTexSubImage(id_,
                        info.level,
                        info.offset.x,
@@ -391,6 +406,7 @@ namespace Fwog
 
   void Texture::GenMipmaps()
   {
+    detail::FlushDrawBatch();
     glGenerateTextureMipmap(id_);
   }
 
@@ -420,6 +436,13 @@ namespace Fwog
       glObjectLabel(GL_TEXTURE, id_, static_cast<GLsizei>(name.length()), name.data());
     }
 
+    if (detail::context->isHazardTrackingEnabled)
+    {
+      auto& viewStorage = detail::context->hazardTracker.viewStorage;
+      const auto it = viewStorage.find(texture.Handle());
+      viewStorage[id_] = it != viewStorage.end() ? it->second : texture.Handle();
+    }
+
     detail::InvokeVerboseMessageCallback("Created texture view with handle ", id_);
   }
 
@@ -0,0 +1,135 @@
+#include <Fwog/TextureStreamer.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Texture.h>
+
+#include <utility>
+
+namespace Fwog
+{
+  TextureStreamer::TextureStreamer(const TextureStreamerCreateInfo& createInfo) : createInfo_(createInfo)
+  {
+    FWOG_ASSERT(createInfo.stagingBufferCount > 0);
+
+    stagingBuffers_.reserve(createInfo.stagingBufferCount);
+    freeStaging_.reserve(createInfo.stagingBufferCount);
+    for (uint32_t i = 0; i < createInfo.stagingBufferCount; i++)
+    {
+      stagingBuffers_.emplace_back(createInfo.stagingBufferSize, BufferStorageFlag::MAP_MEMORY, "Texture Streamer Staging");
+      freeStaging_.push_back(i);
+    }
+  }
+
+  std::optional<TextureStreamStaging> TextureStreamer::TryAcquireStaging()
+  {
+    auto lock = std::lock_guard(mutex_);
+    if (freeStaging_.empty())
+    {
+      return std::nullopt;
+    }
+
+    const auto index = freeStaging_.back();
+    freeStaging_.pop_back();
+    return TextureStreamStaging{
+      .index = index,
+      .size = createInfo_.stagingBufferSize,
+      .mappedPointer = stagingBuffers_[index].GetMappedPointer(),
+    };
+  }
+
+  void TextureStreamer::Submit(const TextureStreamStaging& staging,
+                               Texture& texture,
+                               std::span<const TextureStreamRegion> regions,
+                               uint64_t size)
+  {
+    FWOG_ASSERT(staging.index < stagingBuffers_.size());
+    FWOG_ASSERT(size <= staging.size);
+
+    auto lock = std::lock_guard(mutex_);
+    pending_.push_back(PendingUpload{
+      .stagingIndex = staging.index,
+      .texture = &texture,
+      .regions = {regions.begin(), regions.end()},
+      .size = size,
+    });
+    bytesPending_ += size;
+  }
+
+  void TextureStreamer::Release(const TextureStreamStaging& staging)
+  {
+    FWOG_ASSERT(staging.index < stagingBuffers_.size());
+
+    auto lock = std::lock_guard(mutex_);
+    freeStaging_.push_back(staging.index);
+  }
+
+  void TextureStreamer::Update()
+  {
+    // Recycle staging buffers whose copies have completed. Uploads are retired in submission order
+    while (!inFlight_.empty() && inFlight_.front().fence.IsSignaled())
+    {
+      auto& upload = inFlight_.front();
+      bytesInFlight_ -= upload.size;
+      {
+        auto lock = std::lock_guard(mutex_);
+        freeStaging_.push_back(upload.stagingIndex);
+      }
+      inFlight_.pop_front();
+    }
+
+    bytesUploadedLastUpdate_ = 0;
+    while (true)
+    {
+      PendingUpload upload;
+      {
+        auto lock = std::lock_guard(mutex_);
+        if (pending_.empty())
+        {
+          break;
+        }
+
+        // Always make progress on at least one upload, even if it alone exceeds the budget
+        auto& next = pending_.front();
+        if (bytesUploadedLastUpdate_ > 0 && bytesUploadedLastUpdate_ + next.size > createInfo_.uploadBudgetPerUpdate)
+        {
+          break;
+        }
+
+        upload = std::move(next);
+        pending_.pop_front();
+        bytesPending_ -= upload.size;
+      }
+
+      for (const auto& region : upload.regions)
+      {
+        CopyBufferToTexture({
+          .sourceBuffer = stagingBuffers_[upload.stagingIndex],
+          .targetTexture = *upload.texture,
+          .level = region.level,
+          .sourceOffset = region.sourceOffset,
+          .targetOffset = region.targetOffset,
+          .extent = region.extent,
+          .format = region.format,
+          .type = region.type,
+          .bufferRowLength = region.bufferRowLength,
+          .bufferImageHeight = region.bufferImageHeight,
+        });
+      }
+
+      auto& inFlight = inFlight_.emplace_back(InFlightUpload{
+        .stagingIndex = upload.stagingIndex,
+        .size = upload.size,
+        .fence = Fence(),
+      });
+      inFlight.fence.Signal();
+
+      bytesInFlight_ += upload.size;
+      bytesUploadedLastUpdate_ += upload.size;
+    }
+  }
+
+  uint64_t TextureStreamer::BytesInFlight() const
+  {
+    auto lock = std::lock_guard(mutex_);
+    return bytesInFlight_ + bytesPending_;
+  }
+} // namespace Fwog
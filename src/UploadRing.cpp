@@ -0,0 +1,60 @@
+#include <Fwog/UploadRing.h>
+#include <Fwog/Context.h>
+
+#include <cstring>
+#include <utility>
+
+namespace Fwog
+{
+  UploadRing::UploadRing(size_t size, std::string_view name)
+    : buffer_(size, BufferStorageFlag::MAP_MEMORY, name), ring_(size)
+  {
+  }
+
+  UploadAllocation UploadRing::Allocate(uint64_t size, uint64_t alignment)
+  {
+    const auto offset = ring_.Allocate(size, alignment);
+    return UploadAllocation{
+      .buffer = buffer_,
+      .offset = offset,
+      .size = size,
+      .mappedPointer = static_cast<std::byte*>(buffer_.GetMappedPointer()) + offset,
+    };
+  }
+
+  UploadAllocation UploadRing::AllocateUniform(uint64_t size)
+  {
+    return Allocate(size, static_cast<uint64_t>(GetDeviceProperties().limits.uniformBufferOffsetAlignment));
+  }
+
+  UploadAllocation UploadRing::AllocateStorage(uint64_t size)
+  {
+    return Allocate(size, static_cast<uint64_t>(GetDeviceProperties().limits.shaderStorageBufferOffsetAlignment));
+  }
+
+  UploadAllocation UploadRing::UploadUniform(TriviallyCopyableByteSpan data)
+  {
+    auto allocation = AllocateUniform(data.size_bytes());
+    std::memcpy(allocation.mappedPointer, data.data(), data.size_bytes());
+    return allocation;
+  }
+
+  UploadAllocation UploadRing::UploadStorage(TriviallyCopyableByteSpan data)
+  {
+    auto allocation = AllocateStorage(data.size_bytes());
+    std::memcpy(allocation.mappedPointer, data.data(), data.size_bytes());
+    return allocation;
+  }
+
+  void UploadRing::EndFrame()
+  {
+    if (ring_.CurrentFrameSize() == 0)
+    {
+      return;
+    }
+
+    auto fence = Fence();
+    fence.Signal();
+    ring_.EndFrame(std::move(fence));
+  }
+} // namespace Fwog
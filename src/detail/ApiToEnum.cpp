@@ -242,6 +242,17 @@ namespace Fwog::detail
     }
   }
 
+  GLenum ShaderAccessToGL(ShaderAccess access)
+  {
+    switch (access)
+    {
+    case Fwog::ShaderAccess::READ_ONLY: return GL_READ_ONLY;
+    case Fwog::ShaderAccess::WRITE_ONLY: return GL_WRITE_ONLY;
+    case Fwog::ShaderAccess::READ_WRITE: return GL_READ_WRITE;
+    default: FWOG_UNREACHABLE; return 0;
+    }
+  }
+
 int ImageTypeToDimension(ImageType imageType)
 {
   switch (imageType)
@@ -1,19 +1,24 @@
 #include "Fwog/detail/FramebufferCache.h"
 #include "Fwog/Texture.h"
 #include "Fwog/detail/ContextState.h"
+#include "Fwog/detail/Hash.h"
 #include FWOG_OPENGL_HEADER
 
+#include <algorithm>
+
 namespace Fwog::detail
 {
   uint32_t FramebufferCache::CreateOrGetCachedFramebuffer(const RenderInfo& renderInfo)
   {
+    FWOG_ASSERT(renderInfo.colorAttachments.size() <= MAX_COLOR_ATTACHMENTS);
+
     RenderAttachments attachments;
     for (const auto& colorAttachment : renderInfo.colorAttachments)
     {
-      attachments.colorAttachments.emplace_back(TextureProxy{
+      attachments.colorAttachments[attachments.colorAttachmentCount++] = TextureProxy{
         colorAttachment.texture.get().GetCreateInfo(),
         detail::GetHandle(colorAttachment.texture),
-      });
+      };
     }
     if (renderInfo.depthAttachment)
     {
@@ -30,22 +35,21 @@ namespace Fwog::detail
       });
     }
 
-    for (size_t i = 0; i < framebufferCacheKey_.size(); i++)
+    if (auto it = framebufferCache_.find(attachments); it != framebufferCache_.end())
     {
-      if (framebufferCacheKey_[i] == attachments)
-        return framebufferCacheValue_[i];
+      return it->second;
     }
 
     uint32_t fbo{};
     glCreateFramebuffers(1, &fbo);
-    std::vector<GLenum> drawBuffers;
-    for (size_t i = 0; i < attachments.colorAttachments.size(); i++)
+    std::array<GLenum, MAX_COLOR_ATTACHMENTS> drawBuffers{};
+    for (uint32_t i = 0; i < attachments.colorAttachmentCount; i++)
     {
       const auto& attachment = attachments.colorAttachments[i];
       glNamedFramebufferTexture(fbo, static_cast<GLenum>(GL_COLOR_ATTACHMENT0 + i), attachment.id, 0);
-      drawBuffers.push_back(static_cast<GLenum>(GL_COLOR_ATTACHMENT0 + i));
+      drawBuffers[i] = static_cast<GLenum>(GL_COLOR_ATTACHMENT0 + i);
     }
-    glNamedFramebufferDrawBuffers(fbo, static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+    glNamedFramebufferDrawBuffers(fbo, static_cast<GLsizei>(attachments.colorAttachmentCount), drawBuffers.data());
 
     if (attachments.depthAttachment && attachments.stencilAttachment &&
         attachments.depthAttachment == attachments.stencilAttachment)
@@ -67,83 +71,157 @@ namespace Fwog::detail
 
     detail::InvokeVerboseMessageCallback("Created framebuffer with handle ", fbo);
 
-    framebufferCacheKey_.emplace_back(std::move(attachments));
-    return framebufferCacheValue_.emplace_back(fbo);
+    const auto& key = framebufferCache_.emplace(attachments, fbo).first->first;
+    framebufferAttachments_.emplace(fbo, &key);
+
+    // The same texture can appear in several attachments (e.g. depth-stencil), so only record the framebuffer once
+    auto addReference = [this, fbo](uint32_t texture)
+    {
+      auto& framebuffers = textureFramebuffers_[texture];
+      if (framebuffers.empty() || framebuffers.back() != fbo)
+      {
+        framebuffers.push_back(fbo);
+      }
+    };
+
+    for (uint32_t i = 0; i < key.colorAttachmentCount; i++)
+    {
+      addReference(key.colorAttachments[i].id);
+    }
+    if (key.depthAttachment)
+    {
+      addReference(key.depthAttachment->id);
+    }
+    if (key.stencilAttachment)
+    {
+      addReference(key.stencilAttachment->id);
+    }
+
+    return fbo;
   }
 
   void FramebufferCache::Clear()
   {
-    for (const auto& fbo : framebufferCacheValue_)
+    for (const auto& [attachments, fbo] : framebufferCache_)
     {
       detail::InvokeVerboseMessageCallback("Destroyed framebuffer with handle ", fbo);
       glDeleteFramebuffers(1, &fbo);
     }
 
-    framebufferCacheKey_.clear();
-    framebufferCacheValue_.clear();
+    framebufferCache_.clear();
+    framebufferAttachments_.clear();
+    textureFramebuffers_.clear();
   }
 
   // Must be called when a texture is deleted, otherwise the cache becomes invalid.
   void FramebufferCache::RemoveTexture(const Texture& texture)
   {
-    const TextureProxy texp = {texture.GetCreateInfo(), detail::GetHandle(texture)};
+    const uint32_t textureHandle = detail::GetHandle(texture);
+    RemoveTextures({&textureHandle, 1});
+  }
 
-    for (size_t i = 0; i < framebufferCacheKey_.size(); i++)
+  void FramebufferCache::RemoveTextures(std::span<const uint32_t> textureHandles)
+  {
+    // Framebuffers are deleted with one call after every texture has been unlinked
+    std::vector<uint32_t> deadFramebuffers;
+    for (const auto textureHandle : textureHandles)
     {
-      const auto attachments = framebufferCacheKey_[i];
+      RemoveTextureFramebuffers(textureHandle, deadFramebuffers);
+    }
 
-      for (const auto& ci : attachments.colorAttachments)
+    if (!deadFramebuffers.empty())
+    {
+      glDeleteFramebuffers(static_cast<GLsizei>(deadFramebuffers.size()), deadFramebuffers.data());
+    }
+  }
+
+  void FramebufferCache::RemoveTextureFramebuffers(uint32_t textureHandle, std::vector<uint32_t>& deadFramebuffers)
+  {
+    auto textureIt = textureFramebuffers_.find(textureHandle);
+    if (textureIt == textureFramebuffers_.end())
+    {
+      return;
+    }
+
+    // Unlink each framebuffer from the other textures it references before destroying it
+    auto removeReference = [this, textureHandle](uint32_t texture, uint32_t fbo)
+    {
+      if (texture == textureHandle)
       {
-        if (texp == ci)
+        return;
+      }
+
+      if (auto it = textureFramebuffers_.find(texture); it != textureFramebuffers_.end())
+      {
+        std::erase(it->second, fbo);
+        if (it->second.empty())
         {
-          framebufferCacheKey_.erase(framebufferCacheKey_.begin() + i);
-          auto fboIt = framebufferCacheValue_.begin() + i;
-          glDeleteFramebuffers(1, &*fboIt);
-          framebufferCacheValue_.erase(fboIt);
-          i--;
-          break;
+          textureFramebuffers_.erase(it);
         }
       }
-      
-      if (texp == attachments.depthAttachment || texp == attachments.stencilAttachment)
+    };
+
+    for (const auto fbo : textureIt->second)
+    {
+      auto attachmentsIt = framebufferAttachments_.find(fbo);
+      FWOG_ASSERT(attachmentsIt != framebufferAttachments_.end());
+      const auto& attachments = *attachmentsIt->second;
+
+      for (uint32_t i = 0; i < attachments.colorAttachmentCount; i++)
       {
-        framebufferCacheKey_.erase(framebufferCacheKey_.begin() + i);
-        auto fboIt = framebufferCacheValue_.begin() + i;
-        glDeleteFramebuffers(1, &*fboIt);
-        framebufferCacheValue_.erase(fboIt);
-        i--;
-        continue;
+        removeReference(attachments.colorAttachments[i].id, fbo);
       }
+      if (attachments.depthAttachment)
+      {
+        removeReference(attachments.depthAttachment->id, fbo);
+      }
+      if (attachments.stencilAttachment)
+      {
+        removeReference(attachments.stencilAttachment->id, fbo);
+      }
+
+      // Erase by iterator since the key refers to the element being erased
+      framebufferCache_.erase(framebufferCache_.find(attachments));
+      framebufferAttachments_.erase(attachmentsIt);
+
+      detail::InvokeVerboseMessageCallback("Destroyed framebuffer with handle ", fbo);
+      deadFramebuffers.push_back(fbo);
     }
+
+    // removeReference never erases this texture's entry, so the iterator is still valid
+    textureFramebuffers_.erase(textureIt);
   }
 
   bool RenderAttachments::operator==(const RenderAttachments& rhs) const
   {
-    if (colorAttachments.size() != rhs.colorAttachments.size())
+    if (colorAttachmentCount != rhs.colorAttachmentCount)
       return false;
 
     // Crucially, two attachments with the same address are not necessarily the same.
     // The inverse is also true: two attachments with different addresses are not necessarily different.
 
-    for (size_t i = 0; i < colorAttachments.size(); i++)
+    for (uint32_t i = 0; i < colorAttachmentCount; i++)
     {
       // Color attachments must be non-null
       if (colorAttachments[i] != rhs.colorAttachments[i])
         return false;
     }
 
-    // Nullity of the attachments differ
-    if ((depthAttachment && !rhs.depthAttachment) || (!depthAttachment && rhs.depthAttachment))
-      return false;
-    // Both attachments are non-null, but have different values
-    if (depthAttachment && rhs.depthAttachment && (*depthAttachment != *rhs.depthAttachment))
-      return false;
-
-    if ((stencilAttachment && !rhs.stencilAttachment) || (!stencilAttachment && rhs.stencilAttachment))
-      return false;
-    if (stencilAttachment && rhs.stencilAttachment && (*stencilAttachment != *rhs.stencilAttachment))
-      return false;
-
-    return true;
+    // Comparing optionals checks both nullity and value
+    return depthAttachment == rhs.depthAttachment && stencilAttachment == rhs.stencilAttachment;
   }
 } // namespace Fwog::detail
+
+std::size_t std::hash<Fwog::detail::RenderAttachments>::operator()(
+  const Fwog::detail::RenderAttachments& k) const noexcept
+{
+  // Only handles are hashed, as they are unique among live textures. Create infos are still compared for equality.
+  std::size_t seed = k.colorAttachmentCount;
+  for (uint32_t i = 0; i < k.colorAttachmentCount; i++)
+  {
+    Fwog::detail::hashing::hash_combine(seed, k.colorAttachments[i].id);
+  }
+  Fwog::detail::hashing::hash_combine(seed, k.depthAttachment ? k.depthAttachment->id : 0u);
+  Fwog::detail::hashing::hash_combine(seed, k.stencilAttachment ? k.stencilAttachment->id : 0u);
+  return seed;
+}
@@ -2,10 +2,12 @@
 #include <Fwog/Exception.h>
 #include <Fwog/Shader.h>
 #include <Fwog/detail/PipelineManager.h>
+#include <Fwog/detail/ContextState.h>
+#include <Fwog/detail/ProgramCache.h>
 
 #include <algorithm>
+#include <memory>
 #include <ranges>
-#include <unordered_map>
 #include <utility>
 
 #include FWOG_OPENGL_HEADER
@@ -14,8 +16,75 @@ namespace Fwog::detail
 {
   namespace
   {
-    std::unordered_map<GLuint, std::shared_ptr<const GraphicsPipelineInfoOwning>> gGraphicsPipelines;
-    std::unordered_map<GLuint, std::shared_ptr<const ComputePipelineInfoOwning>> gComputePipelines;
+    // Generational slot array. Handles encode the slot index in the low 32 bits and the slot's generation in the high
+    // 32 bits, so resolving a handle is a bounds check and a load. Stale handles are caught by the generation check.
+    // Only accessed on the thread that owns the context, so no synchronization is needed.
+    template<typename T>
+    class PipelineTable
+    {
+    public:
+      uint64_t Insert(std::unique_ptr<const T> info)
+      {
+        uint32_t index{};
+        if (!freeSlots_.empty())
+        {
+          index = freeSlots_.back();
+          freeSlots_.pop_back();
+        }
+        else
+        {
+          index = static_cast<uint32_t>(slots_.size());
+          slots_.emplace_back();
+        }
+
+        auto& slot = slots_[index];
+        slot.info = std::move(info);
+        return (static_cast<uint64_t>(slot.generation) << 32) | index;
+      }
+
+      const T* Get(uint64_t handle) const
+      {
+        const auto index = static_cast<uint32_t>(handle);
+        const auto generation = static_cast<uint32_t>(handle >> 32);
+        if (index >= slots_.size() || slots_[index].generation != generation)
+        {
+          return nullptr;
+        }
+        return slots_[index].info.get();
+      }
+
+      std::unique_ptr<const T> Remove(uint64_t handle)
+      {
+        if (!Get(handle))
+        {
+          return nullptr;
+        }
+
+        const auto index = static_cast<uint32_t>(handle);
+        auto& slot = slots_[index];
+
+        // Generation 0 is skipped so that a valid handle is never 0
+        if (++slot.generation == 0)
+        {
+          slot.generation = 1;
+        }
+        freeSlots_.push_back(index);
+        return std::move(slot.info);
+      }
+
+    private:
+      struct Slot
+      {
+        std::unique_ptr<const T> info;
+        uint32_t generation = 1;
+      };
+
+      std::vector<Slot> slots_;
+      std::vector<uint32_t> freeSlots_;
+    };
+
+    PipelineTable<GraphicsPipelineInfoOwning> gGraphicsPipelines;
+    PipelineTable<ComputePipelineInfoOwning> gComputePipelines;
 
     GraphicsPipelineInfoOwning MakePipelineInfoOwning(const GraphicsPipelineInfo& info)
     {
@@ -49,24 +118,6 @@ namespace Fwog::detail
       };
     }
 
-    bool LinkProgram(GLuint program, std::string& outInfoLog)
-    {
-      glLinkProgram(program);
-
-      GLint success{};
-      glGetProgramiv(program, GL_LINK_STATUS, &success);
-      if (!success)
-      {
-        GLint length = 512;
-        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
-        outInfoLog.resize(length + 1, '\0');
-        glGetProgramInfoLog(program, length, nullptr, outInfoLog.data());
-        return false;
-      }
-
-      return true;
-    }
-
     std::vector<std::pair<std::string, uint32_t>> ReflectProgram(GLuint program, GLenum interface)
     {
       GLint numActiveResources{};
@@ -80,13 +131,15 @@ namespace Fwog::detail
 
       for (GLint i = 0; i < numActiveResources; i++)
       {
-        // Reflect the name of the resource
+        // Reflect the name of the resource and trim the padding so names can be compared directly
+        GLsizei nameLength{};
         glGetProgramResourceName(program,
                                  interface,
                                  i,
                                  static_cast<GLsizei>(reflected[i].first.size()),
-                                 nullptr,
+                                 &nameLength,
                                  reflected[i].first.data());
+        reflected[i].first.resize(nameLength);
 
         // Reflect the value or binding of the resource (for samplers and images, these are essentially bindings as well)
         if (interface == GL_UNIFORM)
@@ -122,139 +175,272 @@ namespace Fwog::detail
       auto it = std::remove_if(reflected.begin(), reflected.end(), [](const auto& pair) { return pair.first.empty(); });
       reflected.erase(it, reflected.end());
 
+      // Sorted so that names can be looked up with a binary search when binding
+      std::ranges::sort(reflected, {}, &std::pair<std::string, uint32_t>::first);
+
       return reflected;
     }
-  } // namespace
 
-  uint64_t CompileGraphicsPipelineInternal(const GraphicsPipelineInfo& info)
-  {
-    FWOG_ASSERT(info.vertexShader && "A graphics pipeline must at least have a vertex shader");
-    if (info.tessellationControlShader || info.tessellationEvaluationShader)
+    uint32_t ReflectPushConstantSize(GLuint program)
     {
-      FWOG_ASSERT(info.tessellationControlShader && info.tessellationEvaluationShader &&
-                  "Either both or neither tessellation shader can be present");
+      GLint numActiveBlocks{};
+      glGetProgramInterfaceiv(program, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &numActiveBlocks);
+
+      for (GLint i = 0; i < numActiveBlocks; i++)
+      {
+        constexpr GLenum properties[] = {GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE};
+        GLint values[2]{};
+        glGetProgramResourceiv(program, GL_UNIFORM_BLOCK, i, 2, properties, 2, nullptr, values);
+        if (static_cast<uint32_t>(values[0]) == PUSH_CONSTANT_BINDING)
+        {
+          return static_cast<uint32_t>(values[1]);
+        }
+      }
+
+      return 0;
     }
-    GLuint program = glCreateProgram();
-    glAttachShader(program, info.vertexShader->Handle());
-    if (info.fragmentShader)
+
+    // Loads a program from the cache, or creates it and starts linking it without waiting
+    PendingProgram BeginProgram(std::span<const Shader* const> shaders, std::string_view name)
     {
-      glAttachShader(program, info.fragmentShader->Handle());
+      const bool useCache = !context->programCacheDirectory.empty();
+
+      auto pending = PendingProgram{};
+      if (useCache)
+      {
+        pending.cacheKey = ComputeProgramCacheKey(shaders);
+        pending.program = LoadCachedProgram(pending.cacheKey, pending.reflection);
+        pending.isCached = pending.program != 0;
+      }
+
+      if (!pending.isCached)
+      {
+        pending.program = glCreateProgram();
+        for (const auto* shader : shaders)
+        {
+          if (shader)
+          {
+            glAttachShader(pending.program, shader->Handle());
+          }
+        }
+
+        if (useCache)
+        {
+          PrepareProgramForCache(pending.program);
+        }
+
+        glLinkProgram(pending.program);
+      }
+
+      if (!name.empty())
+      {
+        glObjectLabel(GL_PROGRAM, pending.program, static_cast<GLsizei>(name.length()), name.data());
+      }
+
+      return pending;
     }
 
-    if (info.tessellationControlShader)
+    // Waits for a program to link, then reflects and caches it. Deletes the program and throws if linking failed
+    void FinishProgram(PendingProgram& pending, bool isCompute, std::string_view errorMessage)
     {
-      glAttachShader(program, info.tessellationControlShader->Handle());
+      if (pending.isCached)
+      {
+        return;
+      }
+
+      const auto program = pending.program;
+
+      GLint success{};
+      glGetProgramiv(program, GL_LINK_STATUS, &success);
+      if (!success)
+      {
+        GLint length = 512;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        auto infolog = std::string(length + 1, '\0');
+        glGetProgramInfoLog(program, length, nullptr, infolog.data());
+        glDeleteProgram(program);
+        throw PipelineCompilationException(std::string(errorMessage) + infolog);
+      }
+
+      if (isCompute)
+      {
+        GLint workgroupSize[3];
+        glGetProgramiv(program, GL_COMPUTE_WORK_GROUP_SIZE, workgroupSize);
+        pending.reflection.workgroupSize.width = static_cast<uint32_t>(workgroupSize[0]);
+        pending.reflection.workgroupSize.height = static_cast<uint32_t>(workgroupSize[1]);
+        pending.reflection.workgroupSize.depth = static_cast<uint32_t>(workgroupSize[2]);
+      }
+
+      pending.reflection.uniformBlocks = ReflectProgram(program, GL_UNIFORM_BLOCK);
+      pending.reflection.storageBlocks = ReflectProgram(program, GL_SHADER_STORAGE_BLOCK);
+      pending.reflection.samplersAndImages = ReflectProgram(program, GL_UNIFORM);
+      pending.reflection.pushConstantSize = ReflectPushConstantSize(program);
+
+      if (!context->programCacheDirectory.empty())
+      {
+        StoreCachedProgram(pending.cacheKey, program, pending.reflection);
+      }
     }
 
-    if (info.tessellationEvaluationShader)
+    void DestroyProgram(GLuint program)
     {
-      glAttachShader(program, info.tessellationEvaluationShader->Handle());
+      if (context && context->deferredDestruction.IsEnabled())
+      {
+        context->deferredDestruction.CurrentFrame().programs.push_back(program);
+        return;
+      }
+
+      glDeleteProgram(program);
     }
+  } // namespace
 
-    std::string infolog;
-    if (!LinkProgram(program, infolog))
+  std::optional<uint32_t> FindReflectedBinding(const std::vector<std::pair<std::string, uint32_t>>& bindings,
+                                               std::string_view name)
+  {
+    const auto it = std::ranges::lower_bound(bindings,
+                                             name,
+                                             {},
+                                             [](const auto& pair) { return std::string_view(pair.first); });
+    if (it != bindings.end() && it->first == name)
     {
-      glDeleteProgram(program);
-      throw PipelineCompilationException("Failed to compile graphics pipeline.\n" + infolog);
+      return it->second;
     }
+    return std::nullopt;
+  }
 
-    if (!info.name.empty())
+  std::unique_ptr<PendingGraphicsPipeline> BeginGraphicsPipelineInternal(const GraphicsPipelineInfo& info)
+  {
+    FWOG_ASSERT(info.vertexShader && "A graphics pipeline must at least have a vertex shader");
+    if (info.tessellationControlShader || info.tessellationEvaluationShader)
     {
-      glObjectLabel(GL_PROGRAM, program, static_cast<GLsizei>(info.name.length()), info.name.data());
+      FWOG_ASSERT(info.tessellationControlShader && info.tessellationEvaluationShader &&
+                  "Either both or neither tessellation shader can be present");
     }
+    const Shader* shaders[] = {
+      info.vertexShader,
+      info.tessellationControlShader,
+      info.tessellationEvaluationShader,
+      info.fragmentShader,
+    };
+
+    return std::make_unique<PendingGraphicsPipeline>(PendingGraphicsPipeline{
+      .program = BeginProgram(shaders, info.name),
+      .info = MakePipelineInfoOwning(info),
+    });
+  }
+
+  uint64_t FinishGraphicsPipelineInternal(std::unique_ptr<PendingGraphicsPipeline> pending)
+  {
+    FinishProgram(pending->program, false, "Failed to compile graphics pipeline.\n");
 
-    auto owning = MakePipelineInfoOwning(info);
-    owning.uniformBlocks = ReflectProgram(program, GL_UNIFORM_BLOCK);
-    owning.storageBlocks = ReflectProgram(program, GL_SHADER_STORAGE_BLOCK);
-    owning.samplersAndImages = ReflectProgram(program, GL_UNIFORM);
+    auto& reflection = pending->program.reflection;
+    auto owning = std::move(pending->info);
+    owning.program = pending->program.program;
+    owning.uniformBlocks = std::move(reflection.uniformBlocks);
+    owning.storageBlocks = std::move(reflection.storageBlocks);
+    owning.samplersAndImages = std::move(reflection.samplersAndImages);
+    owning.pushConstantSize = reflection.pushConstantSize;
+    owning.vertexArray = context->vaoCache.CreateOrGetCachedVertexArray(owning.vertexInputState);
 
-    gGraphicsPipelines.insert({program, std::make_shared<const GraphicsPipelineInfoOwning>(std::move(owning))});
-    return program;
+    detail::InvokeVerboseMessageCallback("Created graphics program with handle ", owning.program);
+
+    return gGraphicsPipelines.Insert(std::make_unique<const GraphicsPipelineInfoOwning>(std::move(owning)));
   }
 
-  std::shared_ptr<const GraphicsPipelineInfoOwning> GetGraphicsPipelineInternal(uint64_t pipeline)
+  uint64_t CompileGraphicsPipelineInternal(const GraphicsPipelineInfo& info)
   {
-    if (auto it = gGraphicsPipelines.find(static_cast<GLuint>(pipeline)); it != gGraphicsPipelines.end())
-    {
-      return it->second;
-    }
-    return nullptr;
+    return FinishGraphicsPipelineInternal(BeginGraphicsPipelineInternal(info));
+  }
+
+  const GraphicsPipelineInfoOwning* GetGraphicsPipelineInternal(uint64_t pipeline)
+  {
+    return gGraphicsPipelines.Get(pipeline);
   }
 
   void DestroyGraphicsPipelineInternal(uint64_t pipeline)
   {
-    auto it = gGraphicsPipelines.find(static_cast<GLuint>(pipeline));
-    if (it == gGraphicsPipelines.end())
+    auto info = gGraphicsPipelines.Remove(pipeline);
+    if (!info)
     {
       // Tried to delete a nonexistent pipeline.
       FWOG_UNREACHABLE;
       return;
     }
 
-    glDeleteProgram(static_cast<GLuint>(pipeline));
-    gGraphicsPipelines.erase(it);
-  }
+    detail::InvokeVerboseMessageCallback("Destroyed graphics program with handle ", info->program);
+    DestroyProgram(info->program);
 
-  uint64_t CompileComputePipelineInternal(const ComputePipelineInfo& info)
-  {
-    FWOG_ASSERT(info.shader);
-    GLuint program = glCreateProgram();
-    glAttachShader(program, info.shader->Handle());
-
-    std::string infolog;
-    if (!LinkProgram(program, infolog))
+    // The user can delete pipelines at any time, but the last bound pipeline is needed for state deduplication.
+    // Keep its info alive until the next pipeline is bound so its address cannot be reused in the meantime.
+    if (context && context->lastGraphicsPipeline == info.get())
     {
-      glDeleteProgram(program);
-      throw PipelineCompilationException("Failed to compile compute pipeline.\n" + infolog);
+      context->retiredGraphicsPipeline = std::move(info);
     }
+  }
 
-    if (!info.name.empty())
-    {
-      glObjectLabel(GL_PROGRAM, program, static_cast<GLsizei>(info.name.length()), info.name.data());
-    }
-
-    GLint workgroupSize[3];
-    glGetProgramiv(program, GL_COMPUTE_WORK_GROUP_SIZE, workgroupSize);
-
-    FWOG_ASSERT(workgroupSize[0] <= GetDeviceProperties().limits.maxComputeWorkGroupSize[0] &&
-                workgroupSize[1] <= GetDeviceProperties().limits.maxComputeWorkGroupSize[1] &&
-                workgroupSize[2] <= GetDeviceProperties().limits.maxComputeWorkGroupSize[2]);
-    FWOG_ASSERT(workgroupSize[0] * workgroupSize[1] * workgroupSize[2] <=
-                GetDeviceProperties().limits.maxComputeWorkGroupInvocations);
+  std::unique_ptr<PendingComputePipeline> BeginComputePipelineInternal(const ComputePipelineInfo& info)
+  {
+    FWOG_ASSERT(info.shader);
 
-    auto owning = ComputePipelineInfoOwning{.name = std::string(info.name)};
-    owning.uniformBlocks = ReflectProgram(program, GL_UNIFORM_BLOCK);
-    owning.storageBlocks = ReflectProgram(program, GL_SHADER_STORAGE_BLOCK);
-    owning.samplersAndImages = ReflectProgram(program, GL_UNIFORM);
+    const Shader* shaders[] = {info.shader};
+    return std::make_unique<PendingComputePipeline>(PendingComputePipeline{
+      .program = BeginProgram(shaders, info.name),
+      .info = ComputePipelineInfoOwning{.name = std::string(info.name)},
+    });
+  }
 
-    owning.workgroupSize.width = static_cast<uint32_t>(workgroupSize[0]);
-    owning.workgroupSize.height = static_cast<uint32_t>(workgroupSize[1]);
-    owning.workgroupSize.depth = static_cast<uint32_t>(workgroupSize[2]);
+  uint64_t FinishComputePipelineInternal(std::unique_ptr<PendingComputePipeline> pending)
+  {
+    FinishProgram(pending->program, true, "Failed to compile compute pipeline.\n");
+
+    auto& reflection = pending->program.reflection;
+    const auto& workgroupSize = reflection.workgroupSize;
+    const auto& limits = GetDeviceProperties().limits;
+    FWOG_ASSERT(workgroupSize.width <= static_cast<uint32_t>(limits.maxComputeWorkGroupSize[0]) &&
+                workgroupSize.height <= static_cast<uint32_t>(limits.maxComputeWorkGroupSize[1]) &&
+                workgroupSize.depth <= static_cast<uint32_t>(limits.maxComputeWorkGroupSize[2]));
+    FWOG_ASSERT(workgroupSize.width * workgroupSize.height * workgroupSize.depth <=
+                static_cast<uint32_t>(limits.maxComputeWorkGroupInvocations));
+
+    auto owning = std::move(pending->info);
+    owning.program = pending->program.program;
+    owning.uniformBlocks = std::move(reflection.uniformBlocks);
+    owning.storageBlocks = std::move(reflection.storageBlocks);
+    owning.samplersAndImages = std::move(reflection.samplersAndImages);
+    owning.pushConstantSize = reflection.pushConstantSize;
+    owning.workgroupSize = reflection.workgroupSize;
+
+    detail::InvokeVerboseMessageCallback("Created compute program with handle ", owning.program);
+
+    return gComputePipelines.Insert(std::make_unique<const ComputePipelineInfoOwning>(std::move(owning)));
+  }
 
-    gComputePipelines.insert({program, std::make_shared<const ComputePipelineInfoOwning>(std::move(owning))});
-    return program;
+  uint64_t CompileComputePipelineInternal(const ComputePipelineInfo& info)
+  {
+    return FinishComputePipelineInternal(BeginComputePipelineInternal(info));
   }
 
-  std::shared_ptr<const ComputePipelineInfoOwning> GetComputePipelineInternal(uint64_t pipeline)
+  const ComputePipelineInfoOwning* GetComputePipelineInternal(uint64_t pipeline)
   {
-    if (auto it = gComputePipelines.find(static_cast<GLuint>(pipeline)); it != gComputePipelines.end())
-    {
-      return it->second;
-    }
-    return nullptr;
+    return gComputePipelines.Get(pipeline);
   }
 
   void DestroyComputePipelineInternal(uint64_t pipeline)
   {
-    auto it = gComputePipelines.find(static_cast<GLuint>(pipeline));
-    if (it == gComputePipelines.end())
+    auto info = gComputePipelines.Remove(pipeline);
+    if (!info)
     {
       // Tried to delete a nonexistent pipeline.
       FWOG_UNREACHABLE;
       return;
     }
 
-    glDeleteProgram(static_cast<GLuint>(pipeline));
-    gComputePipelines.erase(it);
+    detail::InvokeVerboseMessageCallback("Destroyed compute program with handle ", info->program);
+    DestroyProgram(info->program);
+
+    if (context && context->lastComputePipeline == info.get())
+    {
+      context->retiredComputePipeline = std::move(info);
+    }
   }
 } // namespace Fwog::detail
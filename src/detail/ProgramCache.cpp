@@ -0,0 +1,294 @@
+#include <Fwog/Context.h>
+#include <Fwog/Shader.h>
+#include <Fwog/detail/ContextState.h>
+#include <Fwog/detail/Hash.h>
+#include <Fwog/detail/ProgramCache.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+#include FWOG_OPENGL_HEADER
+
+namespace Fwog::detail
+{
+  namespace
+  {
+    constexpr char cacheMagic[8] = "FWOGPRG";
+
+    // Increment when the layout of cache files changes
+    constexpr uint32_t cacheVersion = 2;
+
+    struct ProgramCacheHeader
+    {
+      char magic[8];
+      uint32_t version;
+      uint32_t binaryFormat;
+      uint64_t key;
+      uint64_t binarySize;
+    };
+
+    std::filesystem::path GetCachePath(uint64_t key)
+    {
+      char name[32]{};
+      std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+      return std::filesystem::path(context->programCacheDirectory) / name;
+    }
+
+    class ByteWriter
+    {
+    public:
+      void Write(const void* data, size_t size)
+      {
+        const auto* bytes = static_cast<const std::byte*>(data);
+        bytes_.insert(bytes_.end(), bytes, bytes + size);
+      }
+
+      void WriteU32(uint32_t value)
+      {
+        Write(&value, sizeof(value));
+      }
+
+      void WriteBindings(const std::vector<std::pair<std::string, uint32_t>>& bindings)
+      {
+        WriteU32(static_cast<uint32_t>(bindings.size()));
+        for (const auto& [name, binding] : bindings)
+        {
+          WriteU32(static_cast<uint32_t>(name.size()));
+          Write(name.data(), name.size());
+          WriteU32(binding);
+        }
+      }
+
+      [[nodiscard]] const std::vector<std::byte>& Bytes() const
+      {
+        return bytes_;
+      }
+
+    private:
+      std::vector<std::byte> bytes_;
+    };
+
+    // Reads from a byte range. Reads past the end set a flag instead of failing immediately, so callers only need to
+    // check once at the end
+    class ByteReader
+    {
+    public:
+      explicit ByteReader(std::span<const std::byte> bytes) : bytes_(bytes) {}
+
+      bool Read(void* data, size_t size)
+      {
+        if (failed_ || bytes_.size() - offset_ < size)
+        {
+          failed_ = true;
+          return false;
+        }
+
+        std::memcpy(data, bytes_.data() + offset_, size);
+        offset_ += size;
+        return true;
+      }
+
+      uint32_t ReadU32()
+      {
+        uint32_t value{};
+        Read(&value, sizeof(value));
+        return value;
+      }
+
+      std::vector<std::pair<std::string, uint32_t>> ReadBindings()
+      {
+        auto bindings = std::vector<std::pair<std::string, uint32_t>>();
+        const auto count = ReadU32();
+        for (uint32_t i = 0; i < count && !failed_; i++)
+        {
+          const auto nameLength = ReadU32();
+          if (nameLength > Remaining().size())
+          {
+            failed_ = true;
+            break;
+          }
+
+          auto name = std::string(nameLength, '\0');
+          Read(name.data(), name.size());
+          const auto binding = ReadU32();
+          bindings.emplace_back(std::move(name), binding);
+        }
+        return bindings;
+      }
+
+      [[nodiscard]] std::span<const std::byte> Remaining() const
+      {
+        return bytes_.subspan(offset_);
+      }
+
+      void Skip(size_t size)
+      {
+        if (failed_ || bytes_.size() - offset_ < size)
+        {
+          failed_ = true;
+          return;
+        }
+        offset_ += size;
+      }
+
+      [[nodiscard]] bool Failed() const
+      {
+        return failed_;
+      }
+
+    private:
+      std::span<const std::byte> bytes_;
+      size_t offset_ = 0;
+      bool failed_ = false;
+    };
+
+    std::optional<std::vector<std::byte>> ReadFile(const std::filesystem::path& path)
+    {
+      auto file = std::ifstream(path, std::ios::binary);
+      if (!file)
+      {
+        return std::nullopt;
+      }
+
+      auto contents = std::vector<char>(std::istreambuf_iterator<char>(file), {});
+      auto bytes = std::vector<std::byte>(contents.size());
+      std::memcpy(bytes.data(), contents.data(), contents.size());
+      return bytes;
+    }
+  } // namespace
+
+  uint64_t ComputeProgramCacheKey(std::span<const Shader* const> shaders)
+  {
+    const auto& properties = GetDeviceProperties();
+    auto key = hashing::fnv1a(std::as_bytes(std::span(properties.vendor)));
+    key = hashing::fnv1a(std::as_bytes(std::span(properties.renderer)), key);
+    key = hashing::fnv1a(std::as_bytes(std::span(properties.version)), key);
+
+    for (const auto* shader : shaders)
+    {
+      const auto sourceHash = shader ? GetSourceHash(*shader) : 0;
+      key = hashing::fnv1a(std::as_bytes(std::span(&sourceHash, 1)), key);
+    }
+
+    return key;
+  }
+
+  uint32_t LoadCachedProgram(uint64_t key, ProgramReflection& reflection)
+  {
+    const auto file = ReadFile(GetCachePath(key));
+    if (!file)
+    {
+      return 0;
+    }
+
+    auto reader = ByteReader(*file);
+    ProgramCacheHeader header{};
+    reader.Read(&header, sizeof(header));
+    if (reader.Failed() || std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+        header.version != cacheVersion || header.key != key || reader.Remaining().size() < header.binarySize)
+    {
+      return 0;
+    }
+
+    const auto binary = reader.Remaining().first(static_cast<size_t>(header.binarySize));
+    reader.Skip(binary.size());
+
+    auto loaded = ProgramReflection{};
+    loaded.uniformBlocks = reader.ReadBindings();
+    loaded.storageBlocks = reader.ReadBindings();
+    loaded.samplersAndImages = reader.ReadBindings();
+    loaded.workgroupSize.width = reader.ReadU32();
+    loaded.workgroupSize.height = reader.ReadU32();
+    loaded.workgroupSize.depth = reader.ReadU32();
+    loaded.pushConstantSize = reader.ReadU32();
+    if (reader.Failed())
+    {
+      return 0;
+    }
+
+    // The driver may reject binaries even when the key matches, e.g., after an update that didn't change the version
+    // string. This isn't an error; the caller will link from source and overwrite the entry
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    GLint success{};
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+      glDeleteProgram(program);
+      return 0;
+    }
+
+    reflection = std::move(loaded);
+    return program;
+  }
+
+  void PrepareProgramForCache(uint32_t program)
+  {
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+
+  void StoreCachedProgram(uint64_t key, uint32_t program, const ProgramReflection& reflection)
+  {
+    GLint binaryLength{};
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if (binaryLength <= 0)
+    {
+      return;
+    }
+
+    auto binary = std::vector<std::byte>(static_cast<size_t>(binaryLength));
+    GLenum binaryFormat{};
+    glGetProgramBinary(program, binaryLength, nullptr, &binaryFormat, binary.data());
+
+    ProgramCacheHeader header{};
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.binaryFormat = binaryFormat;
+    header.key = key;
+    header.binarySize = binary.size();
+
+    auto writer = ByteWriter();
+    writer.Write(&header, sizeof(header));
+    writer.Write(binary.data(), binary.size());
+    writer.WriteBindings(reflection.uniformBlocks);
+    writer.WriteBindings(reflection.storageBlocks);
+    writer.WriteBindings(reflection.samplersAndImages);
+    writer.WriteU32(reflection.workgroupSize.width);
+    writer.WriteU32(reflection.workgroupSize.height);
+    writer.WriteU32(reflection.workgroupSize.depth);
+    writer.WriteU32(reflection.pushConstantSize);
+
+    // Write to a temporary file first so a crash or a concurrent process never leaves a truncated entry behind
+    const auto path = GetCachePath(key);
+    auto tempPath = path;
+    tempPath += ".tmp";
+
+    {
+      auto file = std::ofstream(tempPath, std::ios::binary | std::ios::trunc);
+      if (!file)
+      {
+        return;
+      }
+      const auto& bytes = writer.Bytes();
+      file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+      if (!file)
+      {
+        return;
+      }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+      std::filesystem::remove(tempPath, ec);
+    }
+  }
+} // namespace Fwog::detail
@@ -0,0 +1,131 @@
+#include <Fwog/Config.h>
+#include <Fwog/detail/RangeAllocator.h>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace Fwog::detail
+{
+  RangeAllocator::RangeAllocator(uint64_t capacity) : capacity_(capacity), freeSize_(capacity)
+  {
+    if (capacity > 0)
+    {
+      freeBlocks_.emplace(0, capacity);
+    }
+  }
+
+  std::optional<uint64_t> RangeAllocator::Allocate(uint64_t size)
+  {
+    if (size == 0)
+    {
+      return 0;
+    }
+
+    // Best fit: the smallest free block that can hold the allocation
+    auto best = freeBlocks_.end();
+    for (auto it = freeBlocks_.begin(); it != freeBlocks_.end(); ++it)
+    {
+      if (it->second >= size && (best == freeBlocks_.end() || it->second < best->second))
+      {
+        best = it;
+        if (it->second == size)
+        {
+          break;
+        }
+      }
+    }
+
+    if (best == freeBlocks_.end())
+    {
+      return std::nullopt;
+    }
+
+    const auto [offset, blockSize] = *best;
+    freeBlocks_.erase(best);
+    if (blockSize > size)
+    {
+      freeBlocks_.emplace(offset + size, blockSize - size);
+    }
+
+    freeSize_ -= size;
+    return offset;
+  }
+
+  void RangeAllocator::Free(uint64_t offset, uint64_t size)
+  {
+    if (size == 0)
+    {
+      return;
+    }
+
+    FWOG_ASSERT(offset + size <= capacity_);
+    freeSize_ += size;
+
+    auto [it, inserted] = freeBlocks_.emplace(offset, size);
+    FWOG_ASSERT(inserted && "Range was freed twice");
+
+    // Merge with the following block
+    if (auto next = std::next(it); next != freeBlocks_.end() && it->first + it->second == next->first)
+    {
+      it->second += next->second;
+      freeBlocks_.erase(next);
+    }
+
+    // Merge with the preceding block
+    if (it != freeBlocks_.begin())
+    {
+      if (auto prev = std::prev(it); prev->first + prev->second == it->first)
+      {
+        prev->second += it->second;
+        freeBlocks_.erase(it);
+      }
+    }
+  }
+
+  void RangeAllocator::Grow(uint64_t newCapacity)
+  {
+    FWOG_ASSERT(newCapacity >= capacity_);
+    const auto oldCapacity = std::exchange(capacity_, newCapacity);
+    Free(oldCapacity, newCapacity - oldCapacity);
+  }
+
+  void RangeAllocator::Reset(uint64_t usedSize)
+  {
+    FWOG_ASSERT(usedSize <= capacity_);
+    freeBlocks_.clear();
+    freeSize_ = capacity_ - usedSize;
+    if (freeSize_ > 0)
+    {
+      freeBlocks_.emplace(usedSize, freeSize_);
+    }
+  }
+
+  bool RangeAllocator::IsCompact() const noexcept
+  {
+    // Free space, if any, is a single block at the end
+    return freeBlocks_.empty() ||
+           (freeBlocks_.size() == 1 && freeBlocks_.begin()->first + freeBlocks_.begin()->second == capacity_);
+  }
+
+  uint64_t RangeAllocator::LargestFreeBlock() const noexcept
+  {
+    uint64_t largest = 0;
+    for (const auto& [offset, size] : freeBlocks_)
+    {
+      largest = std::max(largest, size);
+    }
+    return largest;
+  }
+
+  uint64_t RangeAllocator::TrailingFreeSize() const noexcept
+  {
+    if (freeBlocks_.empty())
+    {
+      return 0;
+    }
+
+    const auto& [offset, size] = *freeBlocks_.rbegin();
+    return offset + size == capacity_ ? size : 0;
+  }
+} // namespace Fwog::detail
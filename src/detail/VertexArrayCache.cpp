@@ -2,23 +2,34 @@
 #include "Fwog/Pipeline.h"
 #include "Fwog/detail/ApiToEnum.h"
 #include "Fwog/detail/ContextState.h"
-#include "Fwog/detail/Hash.h"
 #include "Fwog/detail/PipelineManager.h"
 #include FWOG_OPENGL_HEADER
 
+#include <algorithm>
+
 namespace Fwog::detail
 {
   namespace
   {
-    size_t VertexInputStateHash(const VertexInputStateOwning& k)
+    // 64-bit FNV-1a over the fields of each description
+    uint64_t VertexInputStateHash(const std::vector<VertexInputBindingDescription>& descriptions)
     {
-      size_t hashVal{};
+      uint64_t hashVal = 14695981039346656037ull;
+      auto hashField = [&hashVal](uint32_t value)
+      {
+        for (int i = 0; i < 4; i++)
+        {
+          hashVal ^= (value >> (i * 8)) & 0xFF;
+          hashVal *= 1099511628211ull;
+        }
+      };
 
-      for (const auto& desc : k.vertexBindingDescriptions)
+      for (const auto& desc : descriptions)
       {
-        auto cctup = std::make_tuple(desc.location, desc.binding, desc.format, desc.offset);
-        auto chashVal = Fwog::detail::hashing::hash<decltype(cctup)>{}(cctup);
-        Fwog::detail::hashing::hash_combine(hashVal, chashVal);
+        hashField(desc.location);
+        hashField(desc.binding);
+        hashField(static_cast<uint32_t>(desc.format));
+        hashField(desc.offset);
       }
 
       return hashVal;
@@ -27,8 +38,12 @@ namespace Fwog::detail
 
   uint32_t VertexArrayCache::CreateOrGetCachedVertexArray(const VertexInputStateOwning& inputState)
   {
-    auto inputHash = VertexInputStateHash(inputState);
-    if (auto it = vertexArrayCache_.find(inputHash); it != vertexArrayCache_.end())
+    // Attribute order does not affect the resulting vertex array, so sort by location to canonicalize the layout
+    auto key = VertexArrayKey{.hash = 0, .vertexBindingDescriptions = inputState.vertexBindingDescriptions};
+    std::ranges::sort(key.vertexBindingDescriptions, {}, &VertexInputBindingDescription::location);
+    key.hash = VertexInputStateHash(key.vertexBindingDescriptions);
+
+    if (auto it = vertexArrayCache_.find(key); it != vertexArrayCache_.end())
     {
       return it->second;
     }
@@ -56,7 +71,7 @@ namespace Fwog::detail
 
     detail::InvokeVerboseMessageCallback("Created vertex array with handle ", vao);
 
-    return vertexArrayCache_.insert({inputHash, vao}).first->second;
+    return vertexArrayCache_.emplace(std::move(key), vao).first->second;
   }
 
   void VertexArrayCache::Clear()
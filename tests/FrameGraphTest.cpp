@@ -0,0 +1,257 @@
+// Tests FrameGraph::Compile's pass ordering, culling, barrier placement, and transient texture aliasing. Compile
+// doesn't use the context and only transient textures are declared, so no OpenGL context is needed
+#include "Test.h"
+
+#include <Fwog/FrameGraph.h>
+
+#include <cstdint>
+#include <vector>
+
+using Fwog::FrameGraph;
+using Fwog::FrameGraphAccess;
+using Fwog::FrameGraphTextureAccess;
+using Fwog::MemoryBarrierBit;
+using Fwog::MemoryBarrierBits;
+
+namespace
+{
+  const auto colorInfo = Fwog::TextureCreateInfo{
+    .imageType = Fwog::ImageType::TEX_2D,
+    .format = Fwog::Format::R8G8B8A8_UNORM,
+    .extent = {16, 16, 1},
+    .mipLevels = 1,
+    .arrayLayers = 1,
+    .sampleCount = Fwog::SampleCount::SAMPLES_1,
+  };
+
+  const auto depthInfo = Fwog::TextureCreateInfo{
+    .imageType = Fwog::ImageType::TEX_2D,
+    .format = Fwog::Format::D32_FLOAT,
+    .extent = {16, 16, 1},
+    .mipLevels = 1,
+    .arrayLayers = 1,
+    .sampleCount = Fwog::SampleCount::SAMPLES_1,
+  };
+
+  void AddPass(FrameGraph& graph, std::vector<FrameGraphTextureAccess> textures, bool hasSideEffects = false)
+  {
+    graph.AddPass({.textures = textures, .hasSideEffects = hasSideEffects}, [](const Fwog::FrameGraphResources&) {});
+  }
+
+  std::vector<uint32_t> CompiledPassIndices(const FrameGraph& graph)
+  {
+    std::vector<uint32_t> indices;
+    for (const auto& compiled : graph.GetCompiledPasses())
+    {
+      indices.push_back(compiled.pass);
+    }
+    return indices;
+  }
+
+  void TestOrderingAndCulling()
+  {
+    auto graph = FrameGraph();
+    const auto gbuffer = graph.CreateTexture(colorInfo);
+    const auto unused = graph.CreateTexture(colorInfo);
+    const auto lit = graph.CreateTexture(colorInfo);
+    const auto debug = graph.CreateTexture(colorInfo);
+
+    // 0: fills the G-buffer
+    // 1: writes a texture that nothing reads
+    // 2: shades into lit
+    // 3: draws a debug view that only pass 5 reads
+    // 4: presents lit
+    // 5: reads the debug view, but has no side effects
+    AddPass(graph, {{gbuffer, FrameGraphAccess::ATTACHMENT_WRITE}});
+    AddPass(graph, {{unused, FrameGraphAccess::ATTACHMENT_WRITE}});
+    AddPass(graph, {{gbuffer, FrameGraphAccess::SAMPLED_READ}, {lit, FrameGraphAccess::IMAGE_WRITE}});
+    AddPass(graph, {{gbuffer, FrameGraphAccess::SAMPLED_READ}, {debug, FrameGraphAccess::ATTACHMENT_WRITE}});
+    AddPass(graph, {{lit, FrameGraphAccess::SAMPLED_READ}}, true);
+    AddPass(graph, {{debug, FrameGraphAccess::SAMPLED_READ}});
+
+    graph.Compile();
+
+    // Passes keep the order they were added in. Passes 1, 3, and 5 don't contribute to the pass with side effects
+    FWOG_CHECK(CompiledPassIndices(graph) == (std::vector<uint32_t>{0, 2, 4}));
+    FWOG_CHECK(graph.GetPhysicalTextureIndex(gbuffer).has_value());
+    FWOG_CHECK(!graph.GetPhysicalTextureIndex(unused).has_value());
+    FWOG_CHECK(!graph.GetPhysicalTextureIndex(debug).has_value());
+  }
+
+  void TestOverwriteCullsEarlierWriter()
+  {
+    auto graph = FrameGraph();
+    const auto target = graph.CreateTexture(colorInfo);
+
+    AddPass(graph, {{target, FrameGraphAccess::ATTACHMENT_WRITE}});
+    AddPass(graph, {{target, FrameGraphAccess::ATTACHMENT_WRITE}});
+    AddPass(graph, {{target, FrameGraphAccess::SAMPLED_READ}}, true);
+    graph.Compile();
+
+    // The second pass discards the contents written by the first
+    FWOG_CHECK(CompiledPassIndices(graph) == (std::vector<uint32_t>{1, 2}));
+
+    // A pass that loads the existing contents declares a read, which keeps the earlier writer
+    graph.Reset();
+    const auto loaded = graph.CreateTexture(colorInfo);
+    AddPass(graph, {{loaded, FrameGraphAccess::ATTACHMENT_WRITE}});
+    AddPass(graph, {{loaded, FrameGraphAccess::SAMPLED_READ}, {loaded, FrameGraphAccess::ATTACHMENT_WRITE}});
+    AddPass(graph, {{loaded, FrameGraphAccess::SAMPLED_READ}}, true);
+    graph.Compile();
+
+    FWOG_CHECK(CompiledPassIndices(graph) == (std::vector<uint32_t>{0, 1, 2}));
+  }
+
+  void TestBarrierPlacement()
+  {
+    auto graph = FrameGraph();
+    const auto imageA = graph.CreateTexture(colorInfo);
+    const auto imageB = graph.CreateTexture(colorInfo);
+    const auto attachment = graph.CreateTexture(colorInfo);
+
+    AddPass(graph, {{imageA, FrameGraphAccess::IMAGE_WRITE}, {imageB, FrameGraphAccess::IMAGE_WRITE}}); // 0
+    AddPass(graph, {{attachment, FrameGraphAccess::ATTACHMENT_WRITE}});                                   // 1
+    AddPass(graph, {{imageA, FrameGraphAccess::SAMPLED_READ}}, true);                                     // 2
+    AddPass(graph, {{imageB, FrameGraphAccess::SAMPLED_READ}}, true);                                     // 3
+    AddPass(graph, {{imageA, FrameGraphAccess::IMAGE_READ}}, true);                                       // 4
+    AddPass(graph, {{imageA, FrameGraphAccess::IMAGE_READ}}, true);                                       // 5
+    AddPass(graph, {{attachment, FrameGraphAccess::SAMPLED_READ}}, true);                                 // 6
+    graph.Compile();
+
+    const auto passes = graph.GetCompiledPasses();
+    FWOG_CHECK(passes.size() == 7);
+    if (passes.size() != 7)
+    {
+      return;
+    }
+
+    // Nothing precedes the writes
+    FWOG_CHECK(passes[0].barrierBits == MemoryBarrierBits(MemoryBarrierBit::NONE));
+    FWOG_CHECK(passes[1].barrierBits == MemoryBarrierBits(MemoryBarrierBit::NONE));
+
+    // The barrier is placed immediately before the first pass that samples the image stores
+    FWOG_CHECK(passes[2].barrierBits == MemoryBarrierBits(MemoryBarrierBit::TEXTURE_FETCH_BIT));
+
+    // Barriers are global, so the one before pass 2 also made imageB's stores visible to sampling
+    FWOG_CHECK(passes[3].barrierBits == MemoryBarrierBits(MemoryBarrierBit::NONE));
+
+    // A different kind of access needs its own bit, but only once
+    FWOG_CHECK(passes[4].barrierBits == MemoryBarrierBits(MemoryBarrierBit::IMAGE_ACCESS_BIT));
+    FWOG_CHECK(passes[5].barrierBits == MemoryBarrierBits(MemoryBarrierBit::NONE));
+
+    // Attachment writes are coherent with later passes
+    FWOG_CHECK(passes[6].barrierBits == MemoryBarrierBits(MemoryBarrierBit::NONE));
+
+    for (const auto& pass : passes)
+    {
+      FWOG_CHECK(!pass.textureBarrier);
+    }
+  }
+
+  void TestTextureBarrier()
+  {
+    auto graph = FrameGraph();
+    const auto target = graph.CreateTexture(colorInfo);
+
+    AddPass(graph, {{target, FrameGraphAccess::ATTACHMENT_WRITE}});
+    AddPass(graph, {{target, FrameGraphAccess::SAMPLED_READ}, {target, FrameGraphAccess::ATTACHMENT_WRITE}}, true);
+    graph.Compile();
+
+    // Sampling a texture while it is attached after an earlier attachment write is a feedback loop
+    const auto passes = graph.GetCompiledPasses();
+    FWOG_CHECK(passes.size() == 2);
+    if (passes.size() == 2)
+    {
+      FWOG_CHECK(!passes[0].textureBarrier);
+      FWOG_CHECK(passes[1].textureBarrier);
+      FWOG_CHECK(passes[1].barrierBits == MemoryBarrierBits(MemoryBarrierBit::NONE));
+    }
+  }
+
+  void TestAliasing()
+  {
+    auto graph = FrameGraph();
+    const auto first = graph.CreateTexture(colorInfo);
+    const auto second = graph.CreateTexture(colorInfo);
+    const auto overlapping = graph.CreateTexture(colorInfo);
+    const auto depth = graph.CreateTexture(depthInfo);
+
+    AddPass(graph, {{first, FrameGraphAccess::ATTACHMENT_WRITE}, {depth, FrameGraphAccess::ATTACHMENT_WRITE}});
+    AddPass(graph, {{first, FrameGraphAccess::SAMPLED_READ}, {second, FrameGraphAccess::ATTACHMENT_WRITE}});
+    AddPass(graph, {{second, FrameGraphAccess::SAMPLED_READ}, {overlapping, FrameGraphAccess::ATTACHMENT_WRITE}});
+    AddPass(graph,
+            {{second, FrameGraphAccess::SAMPLED_READ},
+             {overlapping, FrameGraphAccess::SAMPLED_READ},
+             {depth, FrameGraphAccess::SAMPLED_READ}},
+            true);
+    graph.Compile();
+
+    const auto firstIndex = graph.GetPhysicalTextureIndex(first);
+    const auto secondIndex = graph.GetPhysicalTextureIndex(second);
+    const auto overlappingIndex = graph.GetPhysicalTextureIndex(overlapping);
+    const auto depthIndex = graph.GetPhysicalTextureIndex(depth);
+    FWOG_CHECK(firstIndex && secondIndex && overlappingIndex && depthIndex);
+
+    // first is still read by the pass that writes second, so second needs its own storage. overlapping is first
+    // written after first's last use, so it reuses first's storage. depth's format differs from the rest
+    FWOG_CHECK_EQ(graph.GetPhysicalTextureCount(), 3);
+    FWOG_CHECK(secondIndex != overlappingIndex);
+    FWOG_CHECK(firstIndex == overlappingIndex);
+    FWOG_CHECK(depthIndex != firstIndex && depthIndex != secondIndex);
+  }
+
+  void TestAliasedStorageSharesHazards()
+  {
+    auto graph = FrameGraph();
+    const auto first = graph.CreateTexture(colorInfo);
+    const auto second = graph.CreateTexture(colorInfo);
+
+    AddPass(graph, {{first, FrameGraphAccess::IMAGE_WRITE}});
+    AddPass(graph, {{first, FrameGraphAccess::IMAGE_READ}}, true);
+    AddPass(graph, {{second, FrameGraphAccess::IMAGE_WRITE}});
+    AddPass(graph, {{second, FrameGraphAccess::SAMPLED_READ}}, true);
+    graph.Compile();
+
+    FWOG_CHECK_EQ(graph.GetPhysicalTextureCount(), 1);
+
+    const auto passes = graph.GetCompiledPasses();
+    FWOG_CHECK(passes.size() == 4);
+    if (passes.size() == 4)
+    {
+      FWOG_CHECK(passes[1].barrierBits == MemoryBarrierBits(MemoryBarrierBit::IMAGE_ACCESS_BIT));
+
+      // second occupies first's storage, so its stores must be ordered after first's loads. The barrier before
+      // pass 1 already did that
+      FWOG_CHECK(passes[2].barrierBits == MemoryBarrierBits(MemoryBarrierBit::NONE));
+      FWOG_CHECK(passes[3].barrierBits == MemoryBarrierBits(MemoryBarrierBit::TEXTURE_FETCH_BIT));
+    }
+  }
+
+  void TestReset()
+  {
+    auto graph = FrameGraph();
+    const auto target = graph.CreateTexture(colorInfo);
+    AddPass(graph, {{target, FrameGraphAccess::ATTACHMENT_WRITE}}, true);
+    graph.Compile();
+    FWOG_CHECK(graph.GetCompiledPasses().size() == 1);
+
+    graph.Reset();
+    FWOG_CHECK(graph.GetCompiledPasses().empty());
+    FWOG_CHECK_EQ(graph.GetPhysicalTextureCount(), 0);
+
+    graph.Compile();
+    FWOG_CHECK(graph.GetCompiledPasses().empty());
+  }
+} // namespace
+
+int main()
+{
+  TestOrderingAndCulling();
+  TestOverwriteCullsEarlierWriter();
+  TestBarrierPlacement();
+  TestTextureBarrier();
+  TestAliasing();
+  TestAliasedStorageSharesHazards();
+  TestReset();
+  return FwogTest::Result();
+}
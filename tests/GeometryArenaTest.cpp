@@ -0,0 +1,122 @@
+// Checks that GeometryArena detects stale handles and keeps mesh data intact when it grows or defragments
+#include "Test.h"
+#include "TestContext.h"
+
+#include <Fwog/GeometryArena.h>
+
+#include FWOG_OPENGL_HEADER
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace
+{
+  // Vertices and indices whose values identify the mesh they belong to
+  struct Mesh
+  {
+    explicit Mesh(uint32_t tag, uint32_t vertexCount, uint32_t indexCount)
+    {
+      for (uint32_t i = 0; i < vertexCount; i++)
+      {
+        vertices.push_back(tag * 1000 + i);
+      }
+      for (uint32_t i = 0; i < indexCount; i++)
+      {
+        indices.push_back(i % vertexCount);
+      }
+    }
+
+    std::vector<uint32_t> vertices;
+    std::vector<uint32_t> indices;
+  };
+
+  std::vector<uint32_t> ReadBack(const Fwog::Buffer& buffer, uint64_t offset, uint64_t count)
+  {
+    auto data = std::vector<uint32_t>(count);
+    glGetNamedBufferSubData(buffer.Handle(), offset * sizeof(uint32_t), count * sizeof(uint32_t), data.data());
+    return data;
+  }
+
+  void CheckMesh(const Fwog::GeometryArena& arena, Fwog::GeometryHandle handle, const Mesh& mesh)
+  {
+    const auto range = arena.GetRange(handle);
+    FWOG_CHECK_EQ(range.vertexCount, mesh.vertices.size());
+    FWOG_CHECK_EQ(range.indexCount, mesh.indices.size());
+    FWOG_CHECK(ReadBack(arena.GetVertexBuffer(), range.startVertex, range.vertexCount) == mesh.vertices);
+    FWOG_CHECK(ReadBack(arena.GetIndexBuffer(), range.startIndex, range.indexCount) == mesh.indices);
+  }
+
+  void TestGenerations()
+  {
+    auto arena = Fwog::GeometryArena({.vertexStride = sizeof(uint32_t), .vertexCapacity = 64, .indexCapacity = 64});
+    const auto meshA = Mesh(1, 4, 6);
+    const auto meshB = Mesh(2, 4, 6);
+
+    const auto first = arena.Allocate(std::span(meshA.vertices), std::span(meshA.indices));
+    FWOG_CHECK(arena.IsValid(first));
+
+    arena.Free(first);
+    FWOG_CHECK(!arena.IsValid(first));
+
+    // The id is reused, but the old handle must not refer to the new mesh
+    const auto second = arena.Allocate(std::span(meshB.vertices), std::span(meshB.indices));
+    FWOG_CHECK_EQ(second.id, first.id);
+    FWOG_CHECK(second.generation != first.generation);
+    FWOG_CHECK(arena.IsValid(second));
+    FWOG_CHECK(!arena.IsValid(first));
+    FWOG_CHECK(!arena.IsValid({.id = 12345, .generation = 0}));
+    CheckMesh(arena, second, meshB);
+  }
+
+  void TestGrowAndDefragment()
+  {
+    auto arena = Fwog::GeometryArena({.vertexStride = sizeof(uint32_t), .vertexCapacity = 16, .indexCapacity = 16});
+
+    auto meshes = std::vector<Mesh>();
+    auto handles = std::vector<Fwog::GeometryHandle>();
+    for (uint32_t i = 0; i < 8; i++)
+    {
+      meshes.emplace_back(i, 5 + i, 9 + i);
+      handles.push_back(arena.Allocate(std::span(meshes.back().vertices), std::span(meshes.back().indices)));
+    }
+
+    // The initial capacity held only a few meshes
+    FWOG_CHECK(arena.GetBufferGeneration() > 0);
+    FWOG_CHECK(arena.GetStats().vertexCapacity > 16);
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+      CheckMesh(arena, handles[i], meshes[i]);
+    }
+
+    for (size_t i = 0; i < meshes.size(); i += 2)
+    {
+      arena.Free(handles[i]);
+    }
+    FWOG_CHECK(arena.GetStats().freeVertexBlocks > 1);
+
+    const auto generation = arena.GetBufferGeneration();
+    FWOG_CHECK(arena.Defragment());
+    FWOG_CHECK(arena.GetBufferGeneration() != generation);
+    FWOG_CHECK_EQ(arena.GetStats().freeVertexBlocks, 1);
+    FWOG_CHECK(!arena.Defragment());
+
+    for (size_t i = 1; i < meshes.size(); i += 2)
+    {
+      CheckMesh(arena, handles[i], meshes[i]);
+    }
+  }
+} // namespace
+
+int main()
+{
+  auto context = FwogTest::TestContext();
+  if (!context.IsValid())
+  {
+    return FwogTest::skipReturnCode;
+  }
+
+  TestGenerations();
+  TestGrowAndDefragment();
+  return FwogTest::Result();
+}
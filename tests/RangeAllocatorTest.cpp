@@ -0,0 +1,212 @@
+// Stress tests for the best-fit range allocator behind GeometryArena. No OpenGL context is needed
+#include "Test.h"
+
+#include <Fwog/detail/RangeAllocator.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using Fwog::detail::RangeAllocator;
+
+namespace
+{
+  void TestBestFit()
+  {
+    auto allocator = RangeAllocator(100);
+    const auto a = allocator.Allocate(10);
+    const auto b = allocator.Allocate(30);
+    const auto c = allocator.Allocate(10);
+    const auto d = allocator.Allocate(20);
+    FWOG_CHECK(a && b && c && d);
+    FWOG_CHECK_EQ(*a, 0);
+    FWOG_CHECK_EQ(*d, 50);
+
+    // Free blocks of 10 at 0, 30 at 10, and 30 at 70 (the tail)
+    allocator.Free(*a, 10);
+    allocator.Free(*b, 30);
+    FWOG_CHECK_EQ(allocator.FreeBlockCount(), 2); // a and b merged
+
+    allocator.Free(*d, 20);
+    FWOG_CHECK_EQ(allocator.FreeBlockCount(), 2); // d merged with the tail
+    FWOG_CHECK_EQ(allocator.FreeSize(), 90);
+    FWOG_CHECK_EQ(allocator.LargestFreeBlock(), 50);
+
+    // The smallest block that fits is chosen, leaving the large one intact
+    const auto e = allocator.Allocate(40);
+    FWOG_CHECK(e.has_value());
+    FWOG_CHECK_EQ(*e, 0);
+    FWOG_CHECK_EQ(allocator.LargestFreeBlock(), 50);
+  }
+
+  void TestFragmentation()
+  {
+    // Free every other block, so plenty of space is free but no block is large enough
+    auto allocator = RangeAllocator(64);
+    std::vector<uint64_t> offsets;
+    for (int i = 0; i < 16; i++)
+    {
+      offsets.push_back(allocator.Allocate(4).value());
+    }
+
+    FWOG_CHECK_EQ(allocator.FreeSize(), 0);
+    FWOG_CHECK(!allocator.Allocate(1).has_value());
+
+    for (size_t i = 0; i < offsets.size(); i += 2)
+    {
+      allocator.Free(offsets[i], 4);
+    }
+
+    FWOG_CHECK_EQ(allocator.FreeSize(), 32);
+    FWOG_CHECK_EQ(allocator.FreeBlockCount(), 8);
+    FWOG_CHECK_EQ(allocator.LargestFreeBlock(), 4);
+    FWOG_CHECK(!allocator.IsCompact());
+    FWOG_CHECK(!allocator.Allocate(5).has_value());
+    FWOG_CHECK(allocator.Allocate(4).has_value());
+  }
+
+  void TestCoalescing()
+  {
+    auto allocator = RangeAllocator(30);
+    const auto a = allocator.Allocate(10).value();
+    const auto b = allocator.Allocate(10).value();
+    const auto c = allocator.Allocate(10).value();
+
+    // Merging with the next block, then with the previous block, then with both at once
+    allocator.Free(c, 10);
+    FWOG_CHECK_EQ(allocator.FreeBlockCount(), 1);
+    allocator.Free(a, 10);
+    FWOG_CHECK_EQ(allocator.FreeBlockCount(), 2);
+    allocator.Free(b, 10);
+    FWOG_CHECK_EQ(allocator.FreeBlockCount(), 1);
+    FWOG_CHECK_EQ(allocator.LargestFreeBlock(), 30);
+    FWOG_CHECK(allocator.IsCompact());
+    FWOG_CHECK_EQ(allocator.Allocate(30).value(), 0);
+  }
+
+  void TestGrow()
+  {
+    auto allocator = RangeAllocator(16);
+    const auto a = allocator.Allocate(8).value();
+    allocator.Allocate(4).value();
+    FWOG_CHECK_EQ(allocator.TrailingFreeSize(), 4);
+
+    // The added space merges with the trailing free block
+    allocator.Grow(32);
+    FWOG_CHECK_EQ(allocator.Capacity(), 32);
+    FWOG_CHECK_EQ(allocator.FreeSize(), 20);
+    FWOG_CHECK_EQ(allocator.FreeBlockCount(), 1);
+    FWOG_CHECK_EQ(allocator.TrailingFreeSize(), 20);
+    FWOG_CHECK_EQ(allocator.Allocate(20).value(), 12);
+    FWOG_CHECK_EQ(allocator.TrailingFreeSize(), 0);
+
+    // With the end of the range allocated, the added space is a new block
+    allocator.Free(a, 8);
+    allocator.Grow(40);
+    FWOG_CHECK_EQ(allocator.FreeBlockCount(), 2);
+    FWOG_CHECK_EQ(allocator.TrailingFreeSize(), 8);
+    FWOG_CHECK_EQ(allocator.Allocate(8).value(), 0);
+  }
+
+  void TestReset()
+  {
+    auto allocator = RangeAllocator(100);
+    for (int i = 0; i < 10; i++)
+    {
+      allocator.Allocate(10).value();
+    }
+    allocator.Free(20, 10);
+    allocator.Free(60, 10);
+
+    allocator.Reset(80);
+    FWOG_CHECK(allocator.IsCompact());
+    FWOG_CHECK_EQ(allocator.FreeSize(), 20);
+    FWOG_CHECK_EQ(allocator.FreeBlockCount(), 1);
+    FWOG_CHECK_EQ(allocator.Allocate(20).value(), 80);
+
+    allocator.Reset(100);
+    FWOG_CHECK_EQ(allocator.FreeBlockCount(), 0);
+    FWOG_CHECK(allocator.IsCompact());
+
+    allocator.Reset(0);
+    FWOG_CHECK_EQ(allocator.LargestFreeBlock(), 100);
+  }
+
+  // Random allocations and frees, checked against a map of which elements are in use
+  void TestRandomized()
+  {
+    struct Range
+    {
+      uint64_t offset;
+      uint64_t size;
+    };
+
+    auto rng = std::mt19937(1234);
+    auto allocator = RangeAllocator(1024);
+    auto isUsed = std::vector<bool>(1024);
+    auto live = std::vector<Range>();
+    uint64_t usedCount = 0;
+
+    for (int step = 0; step < 20000; step++)
+    {
+      if (live.empty() || rng() % 3 != 0)
+      {
+        const auto size = uint64_t{1} + rng() % 48;
+        if (const auto offset = allocator.Allocate(size))
+        {
+          FWOG_CHECK(*offset + size <= allocator.Capacity());
+          for (auto i = *offset; i < *offset + size; i++)
+          {
+            FWOG_CHECK(!isUsed[i]);
+            isUsed[i] = true;
+          }
+          usedCount += size;
+          live.push_back({*offset, size});
+        }
+        else
+        {
+          FWOG_CHECK(allocator.LargestFreeBlock() < size);
+          if (allocator.Capacity() < 8192)
+          {
+            allocator.Grow(allocator.Capacity() * 2);
+            isUsed.resize(allocator.Capacity());
+          }
+        }
+      }
+      else
+      {
+        const auto index = rng() % live.size();
+        const auto range = live[index];
+        live[index] = live.back();
+        live.pop_back();
+        allocator.Free(range.offset, range.size);
+        for (auto i = range.offset; i < range.offset + range.size; i++)
+        {
+          isUsed[i] = false;
+        }
+        usedCount -= range.size;
+      }
+
+      FWOG_CHECK_EQ(allocator.Capacity() - allocator.FreeSize(), usedCount);
+    }
+
+    // Freeing everything coalesces back into one block
+    for (const auto& range : live)
+    {
+      allocator.Free(range.offset, range.size);
+    }
+    FWOG_CHECK_EQ(allocator.FreeBlockCount(), 1);
+    FWOG_CHECK_EQ(allocator.FreeSize(), allocator.Capacity());
+  }
+} // namespace
+
+int main()
+{
+  TestBestFit();
+  TestFragmentation();
+  TestCoalescing();
+  TestGrow();
+  TestReset();
+  TestRandomized();
+  return FwogTest::Result();
+}
@@ -0,0 +1,184 @@
+// Tests the byte accounting behind UploadRing against a fake fence. No OpenGL context is needed
+#include "Test.h"
+
+#include <Fwog/detail/RingAllocator.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+  struct Range
+  {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  // Simulates the device: each frame's allocations are in use until the frame's fence is waited on
+  struct FakeDevice
+  {
+    std::vector<std::vector<Range>> frames = {{}};
+    std::vector<int> waits;
+    int retiredFrames = 0;
+
+    void Track(uint64_t offset, uint64_t size)
+    {
+      // The allocation must not overlap memory that is still in use
+      for (int frame = retiredFrames; frame < static_cast<int>(frames.size()); frame++)
+      {
+        for (const auto& range : frames[frame])
+        {
+          FWOG_CHECK(offset + size <= range.offset || range.offset + range.size <= offset);
+        }
+      }
+      frames.back().push_back({offset, size});
+    }
+  };
+
+  struct FakeFence
+  {
+    FakeDevice* device;
+    int frame;
+
+    void Wait()
+    {
+      // Frames must be retired in order
+      FWOG_CHECK_EQ(frame, device->retiredFrames);
+      device->waits.push_back(frame);
+      device->retiredFrames = frame + 1;
+    }
+  };
+
+  using RingAllocator = Fwog::detail::RingAllocator<FakeFence>;
+
+  void EndFrame(RingAllocator& ring, FakeDevice& device)
+  {
+    ring.EndFrame(FakeFence{&device, static_cast<int>(device.frames.size()) - 1});
+    device.frames.emplace_back();
+  }
+
+  uint64_t Allocate(RingAllocator& ring, FakeDevice& device, uint64_t size, uint64_t alignment)
+  {
+    const auto offset = ring.Allocate(size, alignment);
+    FWOG_CHECK_EQ(offset % alignment, 0);
+    FWOG_CHECK(offset + size <= ring.Capacity());
+    device.Track(offset, size);
+    return offset;
+  }
+
+  void TestAlignment()
+  {
+    auto device = FakeDevice();
+    auto ring = RingAllocator(1024);
+    FWOG_CHECK_EQ(Allocate(ring, device, 10, 1), 0);
+    FWOG_CHECK_EQ(Allocate(ring, device, 10, 256), 256);
+    FWOG_CHECK_EQ(Allocate(ring, device, 4, 4), 268);
+
+    // Padding counts as in use until the frame is retired
+    FWOG_CHECK_EQ(ring.BytesInUse(), 272);
+    FWOG_CHECK_EQ(ring.CurrentFrameSize(), 272);
+    EndFrame(ring, device);
+    FWOG_CHECK_EQ(ring.CurrentFrameSize(), 0);
+    FWOG_CHECK_EQ(ring.FramesInFlight(), 1);
+    FWOG_CHECK(device.waits.empty());
+  }
+
+  void TestWaitsOnlyWhenFull()
+  {
+    auto device = FakeDevice();
+    auto ring = RingAllocator(100);
+
+    // Three frames of 30 bytes fit without waiting
+    for (int i = 0; i < 3; i++)
+    {
+      Allocate(ring, device, 30, 1);
+      EndFrame(ring, device);
+    }
+    FWOG_CHECK(device.waits.empty());
+    FWOG_CHECK_EQ(ring.BytesInUse(), 90);
+
+    // The fourth wraps, skipping the last 10 bytes, and must wait for the first frame
+    FWOG_CHECK_EQ(Allocate(ring, device, 30, 1), 0);
+    FWOG_CHECK_EQ(device.waits.size(), 1);
+    FWOG_CHECK_EQ(device.waits[0], 0);
+    FWOG_CHECK_EQ(ring.BytesInUse(), 100);
+    FWOG_CHECK_EQ(ring.FramesInFlight(), 2);
+    EndFrame(ring, device);
+
+    // The next allocation waits for the second frame only
+    FWOG_CHECK_EQ(Allocate(ring, device, 20, 1), 30);
+    FWOG_CHECK_EQ(device.waits.size(), 2);
+    FWOG_CHECK_EQ(device.waits[1], 1);
+  }
+
+  void TestWrapWithLargeRemainder()
+  {
+    auto device = FakeDevice();
+    auto ring = RingAllocator(100);
+
+    Allocate(ring, device, 60, 1);
+    EndFrame(ring, device);
+
+    // The skipped remainder and the allocation don't fit together, so everything in flight is retired and the
+    // allocation is made at the start without counting the remainder
+    FWOG_CHECK_EQ(Allocate(ring, device, 70, 1), 0);
+    FWOG_CHECK_EQ(device.waits.size(), 1);
+    FWOG_CHECK_EQ(ring.BytesInUse(), 70);
+    FWOG_CHECK_EQ(ring.FramesInFlight(), 0);
+  }
+
+  void TestHeadResetsWhenIdle()
+  {
+    auto device = FakeDevice();
+    auto ring = RingAllocator(100);
+
+    Allocate(ring, device, 80, 1);
+    EndFrame(ring, device);
+    Allocate(ring, device, 50, 1);
+    FWOG_CHECK_EQ(device.waits.size(), 1);
+    EndFrame(ring, device);
+
+    // Waiting on the wrapped allocation's frame leaves nothing in flight, so the next allocation starts at zero
+    Allocate(ring, device, 60, 1);
+    FWOG_CHECK_EQ(device.waits.size(), 2);
+    FWOG_CHECK_EQ(ring.BytesInUse(), 60);
+  }
+
+  // Random allocations over many frames, checked for overlap with every allocation that hasn't been retired
+  void TestRandomized()
+  {
+    auto rng = std::mt19937(1234);
+    auto device = FakeDevice();
+    auto ring = RingAllocator(4096);
+
+    for (int frame = 0; frame < 2000; frame++)
+    {
+      const auto allocationCount = rng() % 8;
+      for (uint32_t i = 0; i < allocationCount; i++)
+      {
+        const auto size = uint64_t{1} + rng() % 300;
+        const auto alignment = uint64_t{1} << (rng() % 9);
+        Allocate(ring, device, size, alignment);
+        FWOG_CHECK(ring.BytesInUse() <= ring.Capacity());
+      }
+
+      if (ring.CurrentFrameSize() > 0)
+      {
+        EndFrame(ring, device);
+      }
+    }
+
+    FWOG_CHECK(!device.waits.empty());
+  }
+} // namespace
+
+int main()
+{
+  TestAlignment();
+  TestWaitsOnlyWhenFull();
+  TestWrapWithLargeRemainder();
+  TestHeadResetsWhenIdle();
+  TestRandomized();
+  return FwogTest::Result();
+}
@@ -0,0 +1,213 @@
+// Checks that a frame of Render, RenderNoAttachments, and Compute scopes, structured like the one in 02_deferred,
+// doesn't allocate once Fwog's caches are warm
+#include "Test.h"
+#include "TestContext.h"
+
+#include <Fwog/Buffer.h>
+#include <Fwog/Pipeline.h>
+#include <Fwog/Rendering.h>
+#include <Fwog/Shader.h>
+#include <Fwog/Texture.h>
+
+#include <array>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+  bool isCountingAllocations = false;
+  int allocationCount = 0;
+} // namespace
+
+void* operator new(std::size_t size)
+{
+  if (isCountingAllocations)
+  {
+    allocationCount++;
+  }
+
+  if (void* memory = std::malloc(size == 0 ? 1 : size))
+  {
+    return memory;
+  }
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+  std::free(memory);
+}
+
+namespace
+{
+  constexpr auto fullscreenVertexSource = R"(
+#version 450 core
+void main()
+{
+  vec2 pos = vec2(gl_VertexID == 1 ? 3.0 : -1.0, gl_VertexID == 2 ? 3.0 : -1.0);
+  gl_Position = vec4(pos, 0.0, 1.0);
+}
+)";
+
+  constexpr auto gbufferFragmentSource = R"(
+#version 450 core
+layout(binding = 0, std140) uniform Uniforms { vec4 color; };
+layout(location = 0) out vec4 o_albedo;
+layout(location = 1) out vec4 o_normal;
+layout(location = 2) out vec4 o_material;
+void main()
+{
+  o_albedo = color;
+  o_normal = vec4(0.0, 0.0, 1.0, 0.0);
+  o_material = vec4(0.5);
+}
+)";
+
+  constexpr auto scatterFragmentSource = R"(
+#version 450 core
+layout(binding = 0, rgba8) uniform writeonly image2D i_target;
+void main()
+{
+  imageStore(i_target, ivec2(gl_FragCoord.xy), vec4(1.0));
+}
+)";
+
+  constexpr auto shadeComputeSource = R"(
+#version 450 core
+layout(local_size_x = 8, local_size_y = 8) in;
+layout(binding = 0) uniform sampler2D s_albedo;
+layout(binding = 1) uniform sampler2D s_normal;
+layout(binding = 0, rgba8) uniform writeonly image2D i_output;
+void main()
+{
+  ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+  imageStore(i_output, coord, texelFetch(s_albedo, coord, 0) * texelFetch(s_normal, coord, 0).z);
+}
+)";
+
+  struct Frame
+  {
+    Fwog::Texture albedo = Fwog::CreateTexture2D({64, 64}, Fwog::Format::R8G8B8A8_UNORM);
+    Fwog::Texture normal = Fwog::CreateTexture2D({64, 64}, Fwog::Format::R16G16B16A16_FLOAT);
+    Fwog::Texture material = Fwog::CreateTexture2D({64, 64}, Fwog::Format::R8G8B8A8_UNORM);
+    Fwog::Texture depth = Fwog::CreateTexture2D({64, 64}, Fwog::Format::D32_FLOAT);
+    Fwog::Texture shaded = Fwog::CreateTexture2D({64, 64}, Fwog::Format::R8G8B8A8_UNORM);
+    Fwog::Texture scattered = Fwog::CreateTexture2D({64, 64}, Fwog::Format::R8G8B8A8_UNORM);
+    Fwog::TypedBuffer<std::array<float, 4>> uniforms{Fwog::BufferStorageFlag::DYNAMIC_STORAGE};
+    Fwog::Sampler sampler{Fwog::SamplerState{}};
+    Fwog::GraphicsPipeline gbufferPipeline = CreateGbufferPipeline();
+    Fwog::GraphicsPipeline scatterPipeline = CreateScatterPipeline();
+    Fwog::ComputePipeline shadePipeline = CreateShadePipeline();
+
+    static Fwog::GraphicsPipeline CreateGbufferPipeline()
+    {
+      auto vs = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER, fullscreenVertexSource);
+      auto fs = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER, gbufferFragmentSource);
+      return Fwog::GraphicsPipeline({
+        .name = "G-buffer",
+        .vertexShader = &vs,
+        .fragmentShader = &fs,
+        .depthState = {.depthTestEnable = true, .depthWriteEnable = true},
+      });
+    }
+
+    static Fwog::GraphicsPipeline CreateScatterPipeline()
+    {
+      auto vs = Fwog::Shader(Fwog::PipelineStage::VERTEX_SHADER, fullscreenVertexSource);
+      auto fs = Fwog::Shader(Fwog::PipelineStage::FRAGMENT_SHADER, scatterFragmentSource);
+      return Fwog::GraphicsPipeline({.name = "Scatter", .vertexShader = &vs, .fragmentShader = &fs});
+    }
+
+    static Fwog::ComputePipeline CreateShadePipeline()
+    {
+      auto cs = Fwog::Shader(Fwog::PipelineStage::COMPUTE_SHADER, shadeComputeSource);
+      return Fwog::ComputePipeline({.name = "Shade", .shader = &cs});
+    }
+
+    void Record()
+    {
+      // Captures larger than std::function's small buffer, which would have to be allocated if the scopes copied them
+      const auto color = std::array<float, 16>{0.25f, 0.5f, 0.75f, 1.0f};
+
+      uniforms.UpdateData(std::array{color[0], color[1], color[2], color[3]});
+
+      const Fwog::RenderColorAttachment colorAttachments[] = {
+        {.texture = albedo, .loadOp = Fwog::AttachmentLoadOp::CLEAR, .clearValue = {0.f, 0.f, 0.f, 0.f}},
+        {.texture = normal, .loadOp = Fwog::AttachmentLoadOp::CLEAR, .clearValue = {0.f, 0.f, 0.f, 0.f}},
+        {.texture = material, .loadOp = Fwog::AttachmentLoadOp::CLEAR, .clearValue = {0.f, 0.f, 0.f, 0.f}},
+      };
+      Fwog::Render(
+        {
+          .name = "G-buffer",
+          .colorAttachments = colorAttachments,
+          .depthAttachment = Fwog::RenderDepthStencilAttachment{
+            .texture = depth,
+            .loadOp = Fwog::AttachmentLoadOp::CLEAR,
+            .clearValue = {.depth = 1.0f},
+          },
+        },
+        [this, color]
+        {
+          Fwog::Cmd::BindGraphicsPipeline(gbufferPipeline);
+          Fwog::Cmd::BindUniformBuffer(0, uniforms);
+          Fwog::Cmd::Draw(3, static_cast<uint32_t>(color[3]), 0, 0);
+        });
+
+      Fwog::RenderNoAttachments(
+        {
+          .name = "Scatter",
+          .viewport = {.drawRect = {.offset = {0, 0}, .extent = {64, 64}}},
+          .framebufferSize = {64, 64, 1},
+          .framebufferSamples = Fwog::SampleCount::SAMPLES_1,
+        },
+        [this, color]
+        {
+          Fwog::Cmd::BindGraphicsPipeline(scatterPipeline);
+          Fwog::Cmd::BindImage(0, scattered, 0, Fwog::ShaderAccess::WRITE_ONLY);
+          Fwog::Cmd::Draw(3, static_cast<uint32_t>(color[3]), 0, 0);
+        });
+
+      Fwog::Compute("Shade",
+                    [this, color]
+                    {
+                      Fwog::MemoryBarrier(Fwog::MemoryBarrierBit::TEXTURE_FETCH_BIT);
+                      Fwog::Cmd::BindComputePipeline(shadePipeline);
+                      Fwog::Cmd::BindSampledImage(0, albedo, sampler);
+                      Fwog::Cmd::BindSampledImage(1, normal, sampler);
+                      Fwog::Cmd::BindImage(0, shaded, 0, Fwog::ShaderAccess::WRITE_ONLY);
+                      Fwog::Cmd::Dispatch(8, 8, static_cast<uint32_t>(color[3]));
+                    });
+    }
+  };
+} // namespace
+
+int main()
+{
+  auto context = FwogTest::TestContext();
+  if (!context.IsValid())
+  {
+    return FwogTest::skipReturnCode;
+  }
+
+  {
+    auto frame = Frame();
+
+    // The first frames fill the framebuffer, vertex array, and sampler caches
+    frame.Record();
+    frame.Record();
+
+    isCountingAllocations = true;
+    frame.Record();
+    isCountingAllocations = false;
+
+    FWOG_CHECK_EQ(allocationCount, 0);
+  }
+
+  return FwogTest::Result();
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdio>
+
+// Tests are plain executables run by CTest. A failed check is reported and the test continues, so that a single run
+// shows every failure. main returns FwogTest::Result()
+namespace FwogTest
+{
+  inline int failures = 0;
+
+  inline int Result()
+  {
+    if (failures > 0)
+    {
+      std::printf("%d check(s) failed\n", failures);
+      return 1;
+    }
+
+    return 0;
+  }
+} // namespace FwogTest
+
+#define FWOG_CHECK(x)                                                                               \
+  do                                                                                                \
+  {                                                                                                 \
+    if (!(x))                                                                                       \
+    {                                                                                               \
+      std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x);                             \
+      FwogTest::failures++;                                                                         \
+    }                                                                                               \
+  } while (0)
+
+#define FWOG_CHECK_EQ(a, b)                                                                         \
+  do                                                                                                \
+  {                                                                                                 \
+    const auto& lhs_ = (a);                                                                         \
+    const auto& rhs_ = (b);                                                                         \
+    if (!(lhs_ == rhs_))                                                                            \
+    {                                                                                               \
+      std::printf("%s:%d: check failed: %s == %s (%lld vs %lld)\n",                                 \
+                  __FILE__,                                                                         \
+                  __LINE__,                                                                         \
+                  #a,                                                                               \
+                  #b,                                                                               \
+                  static_cast<long long>(lhs_),                                                     \
+                  static_cast<long long>(rhs_));                                                    \
+      FwogTest::failures++;                                                                         \
+    }                                                                                               \
+  } while (0)
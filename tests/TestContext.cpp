@@ -0,0 +1,86 @@
+#include "TestContext.h"
+
+#include FWOG_OPENGL_HEADER
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstdio>
+
+namespace FwogTest
+{
+  TestContext::TestContext(const Fwog::ContextInitializeInfo& contextInfo)
+  {
+    // A surfaceless display needs no window system, so the tests can run on headless machines with Mesa
+    auto getPlatformDisplay =
+      reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    auto display = getPlatformDisplay ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+                                      : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+    {
+      std::printf("Skipped: no EGL display is available\n");
+      return;
+    }
+    display_ = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+      std::printf("Skipped: EGL doesn't support OpenGL\n");
+      return;
+    }
+
+    // Fwog targets OpenGL 4.6, but software implementations that only expose 4.5 are enough for what is tested
+    EGLContext context = EGL_NO_CONTEXT;
+    for (EGLint minor : {6, 5})
+    {
+      const EGLint attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, minor,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+      };
+      context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+      if (context != EGL_NO_CONTEXT)
+      {
+        break;
+      }
+    }
+
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+      std::printf("Skipped: couldn't create an OpenGL 4.5 context\n");
+      return;
+    }
+    context_ = context;
+
+    // Functions are loaded here rather than by Fwog, which rejects contexts older than 4.6
+    if (!gladLoadGL(reinterpret_cast<GLADloadfunc>(eglGetProcAddress)))
+    {
+      std::printf("Skipped: couldn't load OpenGL functions\n");
+      return;
+    }
+
+    auto info = contextInfo;
+    info.glLoadFunc = nullptr;
+    Fwog::Initialize(info);
+    isValid_ = true;
+  }
+
+  TestContext::~TestContext()
+  {
+    if (isValid_)
+    {
+      Fwog::Terminate();
+    }
+
+    if (context_)
+    {
+      eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+      eglDestroyContext(display_, context_);
+    }
+
+    if (display_)
+    {
+      eglTerminate(display_);
+    }
+  }
+} // namespace FwogTest
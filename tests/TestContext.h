@@ -0,0 +1,30 @@
+#pragma once
+#include <Fwog/Context.h>
+
+namespace FwogTest
+{
+  // CTest reports tests that exit with this code as skipped
+  inline constexpr int skipReturnCode = 77;
+
+  // Creates a headless OpenGL context with EGL, loads OpenGL functions, and initializes Fwog with it. The context is
+  // destroyed with the object. Tests that need a context should return skipReturnCode if IsValid is false
+  class TestContext
+  {
+  public:
+    explicit TestContext(const Fwog::ContextInitializeInfo& contextInfo = {});
+    ~TestContext();
+
+    TestContext(const TestContext&) = delete;
+    TestContext& operator=(const TestContext&) = delete;
+
+    [[nodiscard]] bool IsValid() const noexcept
+    {
+      return isValid_;
+    }
+
+  private:
+    void* display_{};
+    void* context_{};
+    bool isValid_{};
+  };
+} // namespace FwogTest